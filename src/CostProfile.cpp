@@ -0,0 +1,211 @@
+// ----------------------------------------------------------------------------
+/**
+   File: CostProfile.cpp
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+*/
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include "CostProfile.hpp"
+
+namespace {
+
+/* names of the columns, the stage times follow the counts */
+const char *CountNames[] = {
+  "input_states", "input_arcs", "active_words", "lm_states_expanded",
+  "lm_arcs", "composed_states", "composed_arcs"
+};
+const char *StageNames[] = {
+  "t_compose_lex", "t_lm_fst", "t_compose_lm", "t_sample", "t_char_lm"
+};
+const std::size_t NumCounts = sizeof(CountNames) / sizeof(CountNames[0]);
+const std::size_t MaxNumStages = sizeof(StageNames) / sizeof(StageNames[0]);
+
+// values of the columns of a profile
+std::vector<double> GetColumns(const SentenceCostProfile &Profile,
+                               std::size_t NumStages)
+{
+  std::vector<double> Columns = {
+    static_cast<double>(Profile.NumInputStates),
+    static_cast<double>(Profile.NumInputArcs),
+    static_cast<double>(Profile.NumActiveWords),
+    static_cast<double>(Profile.NumExpandedLMStates),
+    static_cast<double>(Profile.NumLMArcs),
+    static_cast<double>(Profile.NumComposedStates),
+    static_cast<double>(Profile.NumComposedArcs)
+  };
+  Columns.resize(NumCounts + NumStages, 0);
+  for (std::size_t IdxStage = 0;
+       IdxStage < std::min(NumStages, Profile.StageTimes.size()); ++IdxStage) {
+    Columns[NumCounts + IdxStage] = Profile.StageTimes[IdxStage];
+  }
+  Columns.push_back(Profile.Time);
+  return Columns;
+}
+
+// number of stage columns of the recorded profiles
+std::size_t GetNumStages(const std::vector<SentenceCostProfile> &Profiles)
+{
+  std::size_t NumStages = 0;
+  for (const SentenceCostProfile &Profile : Profiles) {
+    NumStages = std::max(NumStages, Profile.StageTimes.size());
+  }
+  return std::min(NumStages, MaxNumStages);
+}
+
+// names of the columns
+std::vector<std::string> GetColumnNames(std::size_t NumStages)
+{
+  std::vector<std::string> Names(CountNames, CountNames + NumCounts);
+  Names.insert(Names.end(), StageNames, StageNames + NumStages);
+  Names.push_back("t_total");
+  return Names;
+}
+
+}
+
+double CostProfile::Percentile(std::vector<double> *Values, double Percent)
+{
+  std::size_t Rank = static_cast<std::size_t>(
+    std::ceil(Percent / 100 * Values->size()));
+  std::size_t Idx = std::min(std::max<std::size_t>(Rank, 1), Values->size()) - 1;
+  std::nth_element(Values->begin(), Values->begin() + Idx, Values->end());
+  return (*Values)[Idx];
+}
+
+void CostProfile::WriteCSV(
+  const std::string &FileName,
+  const std::vector<SentenceCostProfile> &Profiles,
+  const std::vector<std::string> &FileNames
+)
+{
+  std::ofstream Out(FileName);
+  if (!Out) {
+    throw std::runtime_error("Could not open cost profile file " + FileName);
+  }
+
+  std::size_t NumStages = GetNumStages(Profiles);
+  Out << "sentence,file";
+  for (const std::string &Name : GetColumnNames(NumStages)) {
+    Out << "," << Name;
+  }
+  Out << "\n" << std::setprecision(6);
+  for (std::size_t IdxSentence = 0; IdxSentence < Profiles.size();
+       ++IdxSentence) {
+    if (!Profiles[IdxSentence].Recorded) {
+      continue;
+    }
+    Out << IdxSentence << ","
+        << (IdxSentence < FileNames.size() ? FileNames[IdxSentence] : "");
+    for (double Value : GetColumns(Profiles[IdxSentence], NumStages)) {
+      Out << "," << Value;
+    }
+    Out << "\n";
+  }
+  if (!Out) {
+    throw std::runtime_error("Could not write cost profile file " + FileName);
+  }
+}
+
+void CostProfile::PrintSummary(
+  const std::vector<SentenceCostProfile> &Profiles,
+  const std::vector<std::string> &FileNames
+)
+{
+  // collect the columns of the recorded sentences
+  std::size_t NumStages = GetNumStages(Profiles);
+  std::vector<std::string> Names = GetColumnNames(NumStages);
+  std::vector<std::vector<double> > Columns(Names.size());
+  std::vector<std::size_t> Recorded;
+  for (std::size_t IdxSentence = 0; IdxSentence < Profiles.size();
+       ++IdxSentence) {
+    if (!Profiles[IdxSentence].Recorded) {
+      continue;
+    }
+    Recorded.push_back(IdxSentence);
+    std::vector<double> Values = GetColumns(Profiles[IdxSentence], NumStages);
+    for (std::size_t IdxColumn = 0; IdxColumn < Values.size(); ++IdxColumn) {
+      Columns[IdxColumn].push_back(Values[IdxColumn]);
+    }
+  }
+  if (Recorded.empty()) {
+    return;
+  }
+
+  // format locally, the stream state of std::cout is left untouched
+  std::ostringstream Out;
+  Out << " Cost profile of " << Recorded.size() << " sentences:\n"
+            << std::setw(20) << "" << std::setw(14) << "p50" << std::setw(14)
+            << "p95" << std::setw(14) << "p99" << std::setw(14) << "max" << "\n";
+  for (std::size_t IdxColumn = 0; IdxColumn < Names.size(); ++IdxColumn) {
+    std::vector<double> &Values = Columns[IdxColumn];
+    Out << "  " << std::left << std::setw(18) << Names[IdxColumn]
+              << std::right << std::setprecision(6);
+    for (double Percent : {50.0, 95.0, 99.0}) {
+      Out << std::setw(14) << Percentile(&Values, Percent);
+    }
+    Out << std::setw(14) << *std::max_element(Values.begin(), Values.end())
+              << "\n";
+  }
+
+  // the slowest sentences are the candidates for pruning
+  const std::size_t NumSlowest = 5;
+  std::sort(Recorded.begin(), Recorded.end(),
+            [&](std::size_t a, std::size_t b) {
+              return Profiles[a].Time > Profiles[b].Time;
+            });
+  Out << " Slowest sentences:\n";
+  for (std::size_t IdxSlow = 0; IdxSlow < std::min(NumSlowest, Recorded.size());
+       ++IdxSlow) {
+    std::size_t IdxSentence = Recorded[IdxSlow];
+    Out << "  " << std::setprecision(4) << Profiles[IdxSentence].Time
+              << " s: " << IdxSentence;
+    if (IdxSentence < FileNames.size()) {
+      Out << " (" << FileNames[IdxSentence] << ")";
+    }
+    Out << "\n";
+  }
+  Out << "\n";
+  std::cout << Out.str() << std::flush;
+}
@@ -0,0 +1,104 @@
+// ----------------------------------------------------------------------------
+/**
+   File: CostProfile.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+
+   E-Mail: agent@local
+
+   Description: per sentence cost profile of the sampling (lattice sizes,
+                language model fst expansion, composition size and times)
+
+   Limitations: -
+
+   Change History:
+   Date         Author       Description
+   2026-10-19   agent        Initial
+*/
+// ----------------------------------------------------------------------------
+#ifndef _COSTPROFILE_HPP_
+#define _COSTPROFILE_HPP_
+
+#include <string>
+#include <vector>
+
+/* costs of sampling the segmentation of one sentence */
+struct SentenceCostProfile {
+  bool Recorded = false;               // the sentence was sampled by this process
+  std::size_t NumInputStates = 0;      // states of the input lattice (after the character lm)
+  std::size_t NumInputArcs = 0;        // arcs of the input lattice (after the character lm)
+  std::size_t NumActiveWords = 0;      // words of the language model fst
+  std::size_t NumExpandedLMStates = 0; // states of the language model fst expanded
+  std::size_t NumLMArcs = 0;           // arcs generated by the expansion
+  std::size_t NumComposedStates = 0;   // states of the composition sampled from
+  std::size_t NumComposedArcs = 0;     // arcs of the composition sampled from
+  std::vector<double> StageTimes;      // times of the sampling stages (tInSamples)
+  double Time = 0;                     // time for the complete sentence
+};
+
+/* report of the cost profiles of an iteration */
+class CostProfile {
+  // value of the given percentile (nearest rank), Values is sorted
+  static double Percentile(
+    std::vector<double> *Values,
+    double Percent
+  );
+
+public:
+  // write one line per recorded sentence as comma separated values
+  static void WriteCSV(
+    const std::string &FileName,
+    const std::vector<SentenceCostProfile> &Profiles,
+    const std::vector<std::string> &FileNames
+  );
+
+  // print p50, p95, p99 and maximum of every column and the slowest sentences
+  static void PrintSummary(
+    const std::vector<SentenceCostProfile> &Profiles,
+    const std::vector<std::string> &FileNames
+  );
+};
+
+#endif
@@ -44,6 +44,10 @@
 #include "DebugLib.hpp"
 #include <iomanip>
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <atomic>
+#include <thread>
 #include <boost/filesystem/path.hpp>
 
 using std::vector;
@@ -79,7 +83,7 @@ void DebugLib::PrintSentence(const const_witerator &SentenceBegin, int NumWords,
   std::cout << std::endl;
 }
 
-void DebugLib::PrintEditDistanceStatistics(const std::vector< int > &SegmentationInsDelSubCorrNFoundNRef, const std::string &Description, const std::string &Name)
+void DebugLib::PrintEditDistanceStatistics(const std::vector< int > &SegmentationInsDelSubCorrNFoundNRef, const std::string &Description, const std::string &Name, std::ostream &Out)
 {
   // output some error statistics (segmentation)
   int Insertions = SegmentationInsDelSubCorrNFoundNRef[0];
@@ -92,22 +96,22 @@ void DebugLib::PrintEditDistanceStatistics(const std::vector< int > &Segmentatio
   double SegmentationPrecision = SegmentationCorrect / static_cast<double>(SegmentationNumFound);
   double SegmentationRecall = SegmentationCorrect / static_cast<double>(SegmentationNumRef);
   double SegmentationFScore = 2 * (SegmentationPrecision * SegmentationRecall) / (SegmentationPrecision + SegmentationRecall);
-  std::cout << std::setprecision(2) << std::fixed << " " << Description << ":" << std::endl;
-  std::cout << "  " << Name << ": " << 100 * WER << " %,"
-            << " Precision: " << 100 * SegmentationPrecision << " %,"
-            << " Recall: " << 100 * SegmentationRecall << " %,"
-            << " F-score: " << 100 * SegmentationFScore << " %"
-            << std::endl;
-  std::cout << "  Ins: " << Insertions << ","
-            << " Del: " << Deletions << ","
-            << " Sub: " << Substitutions << ","
-            << " Corr: " << SegmentationCorrect << ","
-            << " NFound: " << SegmentationNumFound << ","
-            << " NRef: " << SegmentationNumRef
-            << std::endl << std::endl;
+  Out << std::setprecision(2) << std::fixed << " " << Description << ":" << std::endl;
+  Out << "  " << Name << ": " << 100 * WER << " %,"
+      << " Precision: " << 100 * SegmentationPrecision << " %,"
+      << " Recall: " << 100 * SegmentationRecall << " %,"
+      << " F-score: " << 100 * SegmentationFScore << " %"
+      << std::endl;
+  Out << "  Ins: " << Insertions << ","
+      << " Del: " << Deletions << ","
+      << " Sub: " << Substitutions << ","
+      << " Corr: " << SegmentationCorrect << ","
+      << " NFound: " << SegmentationNumFound << ","
+      << " NRef: " << SegmentationNumRef
+      << std::endl << std::endl;
 }
 
-void DebugLib::PrintLexiconStatistics(const std::vector< int > &LexiconCorrNFoundNRef)
+void DebugLib::PrintLexiconStatistics(const std::vector< int > &LexiconCorrNFoundNRef, std::ostream &Out)
 {
   // output some error statistics (lexicon)
   int LexiconCorrect = LexiconCorrNFoundNRef[0];
@@ -116,25 +120,47 @@ void DebugLib::PrintLexiconStatistics(const std::vector< int > &LexiconCorrNFoun
   double LexiconPrecision = LexiconCorrect / static_cast<double>(LexiconNumFound);
   double LexiconRecall = LexiconCorrect / static_cast<double>(LexiconNumRef);
   double LexiconFScore = 2 * (LexiconPrecision * LexiconRecall) / (LexiconPrecision + LexiconRecall);
-  std::cout << std::setprecision(2) << std::fixed << " Lexicon:" << std::endl;
-  std::cout << "  Precision: " << 100 * LexiconPrecision << " %,"
-            << " Recall: " << 100 * LexiconRecall << " %,"
-            << " F-score: " << 100 * LexiconFScore << " %"
-            << std::endl;
-  std::cout << "  Corr: " << LexiconCorrect << ","
-            << " NFound: " << LexiconNumFound << ","
-            << " NRef: " << LexiconNumRef
-            << std::endl << std::endl;
+  Out << std::setprecision(2) << std::fixed << " Lexicon:" << std::endl;
+  Out << "  Precision: " << 100 * LexiconPrecision << " %,"
+      << " Recall: " << 100 * LexiconRecall << " %,"
+      << " F-score: " << 100 * LexiconFScore << " %"
+      << std::endl;
+  Out << "  Corr: " << LexiconCorrect << ","
+      << " NFound: " << LexiconNumFound << ","
+      << " NRef: " << LexiconNumRef
+      << std::endl << std::endl;
 }
 
-void DebugLib::PrintSentencesPerplexity(const std::vector<std::vector<int> > &Sentences, const NHPYLM &LanguageModel)
+void DebugLib::PrintSentencesPerplexity(const std::vector<std::vector<int> > &Sentences, const NHPYLM &LanguageModel, unsigned int NumThreads)
 {
   int WHPYLMContextLenght = LanguageModel.GetWHPYLMOrder() - 1;
+
+  // score the sentences in parallel, each thread with its own cache of base
+  // probabilities, the sentences are handed out dynamically
+  std::vector<double> Loglikelihoods(Sentences.size());
+  std::atomic<std::size_t> NextSentence(0);
+  auto ScoreSentences = [&]() {
+    google::dense_hash_map<int, double> BaseProbabilities;
+    BaseProbabilities.set_empty_key(EMPTY);
+    for (std::size_t IdxSentence = NextSentence++; IdxSentence < Sentences.size(); IdxSentence = NextSentence++) {
+      Loglikelihoods[IdxSentence] = LanguageModel.WordSequenceLoglikelihood(Sentences[IdxSentence], &BaseProbabilities);
+    }
+  };
+  std::vector<std::thread> Threads;
+  for (unsigned int IdxThread = 1; IdxThread < NumThreads; ++IdxThread) {
+    Threads.emplace_back(ScoreSentences);
+  }
+  ScoreSentences();
+  for (std::thread &Thread : Threads) {
+    Thread.join();
+  }
+
+  // sum up in sentence order, independent of the number of threads
   double LoglikelihoodSum = 0;
   int NumWords = 0;
-  for (const std::vector<int> &Sentence : Sentences) {
-    LoglikelihoodSum += LanguageModel.WordSequenceLoglikelihood(Sentence);
-    NumWords += Sentence.size() - WHPYLMContextLenght;
+  for (std::size_t IdxSentence = 0; IdxSentence < Sentences.size(); ++IdxSentence) {
+    LoglikelihoodSum += Loglikelihoods[IdxSentence];
+    NumWords += Sentences[IdxSentence].size() - WHPYLMContextLenght;
   }
   std::cout << std::setprecision(2) << std::fixed << " Perplexity: " << exp(-LoglikelihoodSum / NumWords) << std::endl << std::endl;
 }
@@ -162,6 +188,58 @@ void DebugLib::PrintLanguageModelStats(const NHPYLM &LanguageModel)
   std::cout << std::endl;
 }
 
+void DebugLib::PrintLanguageModelMemoryUsage(const NHPYLM &LanguageModel)
+{
+  const std::vector<std::string> LMs = {"CHPYLM", "WHPYLM"};
+  const std::vector<std::string> Parts = {"Node", "HashMap", "Table"};
+  std::size_t TotalMemoryUsage = 0;
+  for (const std::string &LM : LMs) {
+    if ((LM == "CHPYLM" ? LanguageModel.GetCHPYLMOrder() :
+                          LanguageModel.GetWHPYLMOrder()) == 0) {
+      continue;
+    }
+    std::cout << " " << LM << " memory usage [kB]:";
+    for (const std::string &Part : Parts) {
+      std::vector<int> KiloBytesPerLevel;
+      for (std::size_t Bytes :
+           LanguageModel.GetMemoryUsagePerLevelFor(LM, Part)) {
+        KiloBytesPerLevel.push_back(static_cast<int>(Bytes / 1024));
+        TotalMemoryUsage += Bytes;
+      }
+      PrintVectorOfInts(KiloBytesPerLevel, 8,
+                        "\n  " + Part + "s:" + std::string(13 - Part.size(), ' '), "");
+    }
+    std::cout << "\n";
+  }
+
+  std::cout << " Index and dictionary memory usage [kB]:";
+  const std::vector<std::string> IndexParts = {
+    "CHPYLMIndex", "WHPYLMIndex", "Word2Id", "Id2Word",
+    "Id2CharacterSequence", "BaseProbabilities"
+  };
+  for (const std::string &Part : IndexParts) {
+    std::size_t Bytes = LanguageModel.GetMemoryUsageFor(Part);
+    TotalMemoryUsage += Bytes;
+    std::cout << "\n  " << std::left << std::setw(22) << (Part + ":")
+              << std::right << std::setw(8) << Bytes / 1024;
+  }
+  std::cout << "\n Total language model memory usage [kB]: "
+            << TotalMemoryUsage / 1024 << std::endl;
+}
+
+std::size_t DebugLib::GetFstMemoryUsage(const fst::VectorFst<fst::LogArc> &Fst)
+{
+  // per state: final weight, epsilon counts, arc vector and state pointer
+  std::size_t MemoryUsage = 0;
+  for (fst::StateIterator<fst::VectorFst<fst::LogArc> > StateIterator(Fst);
+       !StateIterator.Done(); StateIterator.Next()) {
+    MemoryUsage += sizeof(fst::LogWeight) + 2 * sizeof(std::size_t) +
+                   sizeof(std::vector<fst::LogArc>) + sizeof(void *) +
+                   Fst.NumArcs(StateIterator.Value()) * sizeof(fst::LogArc);
+  }
+  return MemoryUsage;
+}
+
 void DebugLib::PrintVectorOfInts(const std::vector< int > &VectorOfInts, int Width, const std::string &Description, const std::string &Postfix)
 {
   std::cout << Description;
@@ -334,3 +412,27 @@ string DebugLib::BuildFilename(string Basepath, string InFilepath, string suffix
 {
   return Basepath + boost::filesystem::path(InFilepath).stem().string() + suffix;
 }
+
+
+void DebugLib::PrintMemoryUsage(const std::string &Description)
+{
+  // VmRSS: current resident set size, VmHWM: peak resident set size
+  std::ifstream StatusFile("/proc/self/status");
+  std::string Line;
+  std::string Rss = "n/a";
+  std::string PeakRss = "n/a";
+  while (std::getline(StatusFile, Line)) {
+    std::istringstream LineStream(Line);
+    std::string Key;
+    std::string Value;
+    std::string Unit;
+    LineStream >> Key >> Value >> Unit;
+    if (Key == "VmRSS:") {
+      Rss = Value + " " + Unit;
+    } else if (Key == "VmHWM:") {
+      PeakRss = Value + " " + Unit;
+    }
+  }
+  std::cout << "Memory usage " << Description << ": " << Rss
+            << " resident, " << PeakRss << " peak" << std::endl;
+}
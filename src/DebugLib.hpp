@@ -60,6 +60,7 @@
 #ifndef _DEBUGLIB_HPP_
 #define _DEBUGLIB_HPP_
 
+#include <iostream>
 #include <fst/vector-fst.h>
 #include <sys/stat.h>
 #include "NHPYLM/NHPYLM.hpp"
@@ -88,21 +89,38 @@ public:
   static void PrintEditDistanceStatistics(
     const std::vector< int > &SegmentationInsDelSubCorrNFoundNRef,
     const std::string &Description,
-    const std::string &Name
+    const std::string &Name,
+    std::ostream &Out = std::cout
   );
   
   static void PrintLexiconStatistics(
-    const std::vector<int> &LexiconCorrNFoundNRef
+    const std::vector<int> &LexiconCorrNFoundNRef,
+    std::ostream &Out = std::cout
   );
   
+  // the sentences are scored in parallel, the language model must not be
+  // modified meanwhile
   static void PrintSentencesPerplexity(
     const std::vector<std::vector<int> > &Sentences,
-    const NHPYLM &LanguageModel
+    const NHPYLM &LanguageModel,
+    unsigned int NumThreads
   );
   
   static void PrintLanguageModelStats(
     const NHPYLM &LanguageModel
   );
+
+  // print bytes per level of the restaurants, hashmaps and tables and the
+  // bytes of the context indices, the dictionary and the base probabilities
+  static void PrintLanguageModelMemoryUsage(
+    const NHPYLM &LanguageModel
+  );
+
+  // estimate bytes of a vector fst from its states and arcs (without
+  // spare capacity of the arc vectors)
+  static std::size_t GetFstMemoryUsage(
+    const fst::VectorFst<fst::LogArc> &Fst
+  );
   
   static void PrintVectorOfInts(
     const std::vector<int> &VectorOfInts,
@@ -169,6 +187,11 @@ public:
     int SentEndWordId
   );
 
+  // print current and peak resident set size of the process (linux only)
+  static void PrintMemoryUsage(
+    const std::string &Description
+  );
+
   static string BuildFilename(
     string Basepath,
     string InFilepath,
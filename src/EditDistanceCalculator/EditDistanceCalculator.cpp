@@ -43,6 +43,8 @@
 // ----------------------------------------------------------------------------
 #include <fst/compose.h>
 #include <fst/shortest-path.h>
+#include <cstdint>
+#include <fstream>
 #include <thread>
 #include "EditDistanceCalculator.hpp"
 #include "definitions.hpp"
@@ -83,40 +85,21 @@ void EditDistanceCalculator::SetInputFstsAndReferenceSentences(const std::vector
   BuildLeftAndRightFactors();
 
   // calculate edit Calculate edit distance
-  CalculateEditDistance();
+  CalculateEditDistance(false);
 }
 
 
 void EditDistanceCalculator::SetInputAndReferenceSentences(const vector< vector< int > > &InputSentences_, const vector< vector< int > > &ReferenceSentences_, const vector< int > &InputAndOutputIds_, const vector< string > &Id2CharacterSequenceVector_)
 {
   // initialize some variables
-//   std::cout << "Setting NumSentences" << std::endl;
   NumSentences = InputSentences_.size();
-//   std::cout << "Setting InputSentences" << std::endl;
   InputSentences = InputSentences_;
-//   std::cout << "Setting ReferenceSentences" << std::endl;
   ReferenceSentences = ReferenceSentences_;
-//   std::cout << "Setting InputAndOutputId" << std::endl;
   InputAndOutputIds = InputAndOutputIds_;
-//   std::cout << "Setting Id2CharacterSequenceVector" << std::endl;
   Id2CharacterSequenceVector = Id2CharacterSequenceVector_;
 
-  // build input and reference fsts
-//   std::cout << "build input and reference fsts" << std::endl;
-  InputFsts.resize(NumSentences);
-  ReferenceFsts.resize(NumSentences);
-  for (unsigned int IdxSentence = 0; IdxSentence < NumSentences; IdxSentence++) {
-    BuildFstFromIdSequence(InputSentences.at(IdxSentence), &InputFsts.at(IdxSentence));
-    BuildFstFromIdSequence(ReferenceSentences.at(IdxSentence), &ReferenceFsts.at(IdxSentence));
-  }
-
-  // build left and right factors
-//   std::cout << "build left and right factors" << std::endl;
-  BuildLeftAndRightFactors();
-
-  // calculate edit distance
-//   std::cout << "calculate edit distance" << std::endl;
-  CalculateEditDistance();
+  // calculate edit distance (string to string, no fsts needed)
+  CalculateEditDistance(true);
 }
 
 
@@ -166,26 +149,36 @@ void EditDistanceCalculator::BuildLeftAndRightFactors()
 }
 
 
-void EditDistanceCalculator::CalculateEditDistance()
+void EditDistanceCalculator::CalculateEditDistance(bool AlignIdSequences)
 {
-  ResultFsts.resize(NumSentences);
+  if (!AlignIdSequences) {
+    ResultFsts.resize(NumSentences);
+  }
 
 //   std::cout << "initialize threads and variables" << std::endl;
   std::vector<std::thread> Threads(NumThreads - 1);
   int IdxRangeStep = std::ceil(NumSentences / static_cast<double>(NumThreads));
   std::vector<std::vector<int> > InsDelSubCorrNFoundNRefPerIdxRange(NumThreads - 1, std::vector<int>(6, 0));
 
-  std::vector<fst::VectorFst<fst::StdArc> > RightFactors(NumThreads - 1, RightFactor);
-  std::vector<fst::VectorFst<fst::StdArc> > LeftFactors(NumThreads - 1, LeftFactor);
+  std::vector<fst::VectorFst<fst::StdArc> > RightFactors(AlignIdSequences ? 0 : NumThreads - 1, RightFactor);
+  std::vector<fst::VectorFst<fst::StdArc> > LeftFactors(AlignIdSequences ? 0 : NumThreads - 1, LeftFactor);
 //   std::cout << "starting threads: ";
   for (unsigned int IdxRange = 0; IdxRange < (NumThreads - 1); ++IdxRange) {
 //     std::cout << IdxRange << " ";
     unsigned int StartIdx = IdxRange * IdxRangeStep;
     unsigned int EndIdx = std::min((IdxRange + 1) * IdxRangeStep, NumSentences);
-    Threads[IdxRange] = std::thread(CalculateEditDistanceIdxRange, &InputFsts, &ReferenceFsts, &ResultFsts, &LeftFactors.at(IdxRange), &RightFactors.at(IdxRange), &InsDelSubCorrNFoundNRefPerIdxRange.at(IdxRange), StartIdx, EndIdx, &Id2CharacterSequenceVector, &FileNames, &Prefix, OutputEditOperations);
+    if (AlignIdSequences) {
+      Threads[IdxRange] = std::thread(AlignIdSequencesIdxRange, &InputSentences, &ReferenceSentences, &InsDelSubCorrNFoundNRefPerIdxRange.at(IdxRange), StartIdx, EndIdx, &Id2CharacterSequenceVector, &FileNames, &Prefix, OutputEditOperations);
+    } else {
+      Threads[IdxRange] = std::thread(CalculateEditDistanceIdxRange, &InputFsts, &ReferenceFsts, &ResultFsts, &LeftFactors.at(IdxRange), &RightFactors.at(IdxRange), &InsDelSubCorrNFoundNRefPerIdxRange.at(IdxRange), StartIdx, EndIdx, &Id2CharacterSequenceVector, &FileNames, &Prefix, OutputEditOperations);
+    }
   }
 //   std::cout << std::endl << "starting final thread" << std::endl;
-  CalculateEditDistanceIdxRange(&InputFsts, &ReferenceFsts, &ResultFsts, &LeftFactor, &RightFactor, &InsDelSubCorrNFoundNRef, (NumThreads - 1) * IdxRangeStep, std::min(NumThreads * IdxRangeStep, NumSentences), &Id2CharacterSequenceVector, &FileNames, &Prefix, OutputEditOperations);
+  if (AlignIdSequences) {
+    AlignIdSequencesIdxRange(&InputSentences, &ReferenceSentences, &InsDelSubCorrNFoundNRef, (NumThreads - 1) * IdxRangeStep, std::min(NumThreads * IdxRangeStep, NumSentences), &Id2CharacterSequenceVector, &FileNames, &Prefix, OutputEditOperations);
+  } else {
+    CalculateEditDistanceIdxRange(&InputFsts, &ReferenceFsts, &ResultFsts, &LeftFactor, &RightFactor, &InsDelSubCorrNFoundNRef, (NumThreads - 1) * IdxRangeStep, std::min(NumThreads * IdxRangeStep, NumSentences), &Id2CharacterSequenceVector, &FileNames, &Prefix, OutputEditOperations);
+  }
 
 //   std::cout << "wating for threads and collecting data: " << std::endl;
   for (unsigned int IdxRange = 0; IdxRange < (NumThreads - 1); ++IdxRange) {
@@ -276,6 +269,98 @@ void EditDistanceCalculator::CalculateEditDistanceSingleIdx(const fst::VectorFst
   }
 }
 
+void EditDistanceCalculator::AlignIdSequencesIdxRange(const std::vector<std::vector<int> > *InputSentences, const std::vector<std::vector<int> > *ReferenceSentences, vector< int > *InsDelSubCorrNFoundNRef, unsigned int StartIdx, unsigned int EndIdx, const std::vector<std::string> *Id2CharacterSequenceVector, const std::vector<std::string> *Filenames, const std::string *Prefix, bool OutputEditOperations)
+{
+  for (unsigned int IdxSentence = StartIdx; IdxSentence < EndIdx; ++IdxSentence) {
+    AlignIdSequencesSingleIdx(InputSentences->at(IdxSentence), ReferenceSentences->at(IdxSentence), InsDelSubCorrNFoundNRef, Id2CharacterSequenceVector, &Filenames->at(IdxSentence), Prefix, OutputEditOperations);
+  }
+}
+
+
+void EditDistanceCalculator::AlignIdSequencesSingleIdx(const std::vector<int> &InputSentence, const std::vector<int> &ReferenceSentence, std::vector<int> *InsDelSubCorrNFoundNRef, const std::vector<std::string> *Id2CharacterSequenceVector, const std::string *FileName, const std::string *Prefix, bool OutputEditOperations)
+{
+  // The factors charge 1 for an insertion or deletion and 1.000002 for a
+  // substitution, i.e. the shortest path has the minimum number of errors
+  // and among those the fewest substitutions. The costs are kept exact by
+  // counting errors in the upper and substitutions in the lower 32 bits.
+  typedef std::uint64_t CostType;
+  const CostType InsDelCost = CostType(1) << 32;
+  const CostType SubCost = InsDelCost + 1;
+
+  std::size_t NumRef = ReferenceSentence.size();
+  std::size_t NumHyp = InputSentence.size();
+  std::size_t NumCols = NumHyp + 1;
+
+  // the full matrix is only needed for the traceback of the edit operations
+  std::vector<CostType> Costs(OutputEditOperations ? (NumRef + 1) * NumCols : 2 * NumCols);
+  CostType *PrevRow = Costs.data();
+  CostType *CurRow = PrevRow + NumCols;
+  for (std::size_t IdxHyp = 0; IdxHyp <= NumHyp; ++IdxHyp) {
+    PrevRow[IdxHyp] = IdxHyp * InsDelCost;
+  }
+  for (std::size_t IdxRef = 1; IdxRef <= NumRef; ++IdxRef) {
+    if (OutputEditOperations) {
+      PrevRow = Costs.data() + (IdxRef - 1) * NumCols;
+      CurRow = PrevRow + NumCols;
+    }
+    int RefId = ReferenceSentence[IdxRef - 1];
+    CurRow[0] = IdxRef * InsDelCost;
+    for (std::size_t IdxHyp = 1; IdxHyp <= NumHyp; ++IdxHyp) {
+      CostType Diagonal = PrevRow[IdxHyp - 1] + (InputSentence[IdxHyp - 1] == RefId ? 0 : SubCost);
+      CurRow[IdxHyp] = std::min(Diagonal, std::min(PrevRow[IdxHyp], CurRow[IdxHyp - 1]) + InsDelCost);
+    }
+    if (!OutputEditOperations) {
+      std::swap(PrevRow, CurRow);
+    }
+  }
+  CostType Cost = OutputEditOperations ? Costs.back() : PrevRow[NumHyp];
+
+  // the counts follow from the number of errors and substitutions
+  int NumErrors = Cost >> 32;
+  int NumSub = Cost & 0xffffffff;
+  int NumIns = (NumErrors - NumSub + static_cast<int>(NumHyp) - static_cast<int>(NumRef)) / 2;
+  int NumDel = NumErrors - NumSub - NumIns;
+  (*InsDelSubCorrNFoundNRef)[0] += NumIns;
+  (*InsDelSubCorrNFoundNRef)[1] += NumDel;
+  (*InsDelSubCorrNFoundNRef)[2] += NumSub;
+  (*InsDelSubCorrNFoundNRef)[3] += NumRef - NumDel - NumSub;
+  (*InsDelSubCorrNFoundNRef)[4] += NumHyp;
+  (*InsDelSubCorrNFoundNRef)[5] += NumRef;
+
+  if (!OutputEditOperations) {
+    return;
+  }
+
+  // trace back from the end, the operations are written in the same
+  // (reversed) order as the arcs of the shortest path fst
+  std::ofstream myfile(*Prefix + *FileName);
+  std::size_t IdxRef = NumRef;
+  std::size_t IdxHyp = NumHyp;
+  while (IdxRef > 0 || IdxHyp > 0) {
+    CostType CurCost = Costs[IdxRef * NumCols + IdxHyp];
+    int ILabel = EPS_SYMBOLID;
+    int OLabel = EPS_SYMBOLID;
+    char Operation;
+    if (IdxRef > 0 && IdxHyp > 0 && ReferenceSentence[IdxRef - 1] == InputSentence[IdxHyp - 1] &&
+        CurCost == Costs[(IdxRef - 1) * NumCols + IdxHyp - 1]) {
+      Operation = 'c';
+      ILabel = ReferenceSentence[--IdxRef];
+      OLabel = InputSentence[--IdxHyp];
+    } else if (IdxRef > 0 && IdxHyp > 0 && CurCost == Costs[(IdxRef - 1) * NumCols + IdxHyp - 1] + SubCost) {
+      Operation = 's';
+      ILabel = ReferenceSentence[--IdxRef];
+      OLabel = InputSentence[--IdxHyp];
+    } else if (IdxRef > 0 && CurCost == Costs[(IdxRef - 1) * NumCols + IdxHyp] + InsDelCost) {
+      Operation = 'd';
+      ILabel = ReferenceSentence[--IdxRef];
+    } else {
+      Operation = 'i';
+      OLabel = InputSentence[--IdxHyp];
+    }
+    myfile << Operation << ":[" << ILabel << "," << Id2CharacterSequenceVector->at(ILabel) << " --> " << OLabel << "," << Id2CharacterSequenceVector->at(OLabel) << "]" << std::endl;
+  }
+}
+
 const vector< int > &EditDistanceCalculator::GetInsDelSubCorrNFoundNRef() const
 {
   return InsDelSubCorrNFoundNRef;
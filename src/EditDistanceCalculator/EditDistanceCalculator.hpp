@@ -90,7 +90,7 @@ class EditDistanceCalculator {
   /* internal functions */
   void BuildLeftAndRightFactors();
 
-  void CalculateEditDistance();
+  void CalculateEditDistance(bool AlignIdSequences);
 
   static inline void CalculateEditDistanceIdxRange(
     const std::vector< fst::VectorFst< fst::StdArc > > *InputFsts,
@@ -107,6 +107,30 @@ class EditDistanceCalculator {
     bool OutputEditOperations
   );
   
+  static inline void AlignIdSequencesIdxRange(
+    const std::vector< std::vector< int > > *InputSentences,
+    const std::vector< std::vector< int > > *ReferenceSentences,
+    std::vector< int > *InsDelSubCorrNFoundNRef,
+    unsigned int StartIdx,
+    unsigned int EndIdx,
+    const std::vector< std::string > *Id2CharacterSequenceVector,
+    const std::vector< std::string > *Filenames,
+    const std::string *Prefix,
+    bool OutputEditOperations
+  );
+
+  // align two id sequences by dynamic programming, equivalent to the
+  // shortest path through the composition with the edit factors
+  static inline void AlignIdSequencesSingleIdx(
+    const std::vector< int > &InputSentence,
+    const std::vector< int > &ReferenceSentence,
+    std::vector< int > *InsDelSubCorrNFoundNRef,
+    const std::vector< std::string > *Id2CharacterSequenceVector,
+    const std::string *FileName,
+    const std::string *Prefix,
+    bool OutputEditOperations
+  );
+
   static inline void BuildFstFromIdSequence(
     const std::vector< int > &IdSequence,
     fst::VectorFst< fst::StdArc > *Fst
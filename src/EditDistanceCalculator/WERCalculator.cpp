@@ -41,7 +41,11 @@
    Author: Oliver Walter
 */
 // ----------------------------------------------------------------------------
+#include <algorithm>
+#include <atomic>
 #include <numeric>
+#include <thread>
+#include <unordered_map>
 #include "WERCalculator.hpp"
 #include "../ParseLib.hpp"
 
@@ -52,10 +56,87 @@ using std::cout;
 using std::endl;
 using std::cerr;
 
+ReferenceWordSequences::ReferenceWordSequences(
+  const vector< fst::VectorFst< fst::LogArc > > &ReferenceFsts,
+  const Dictionary &dict
+)
+{
+  // parse into a scratch copy of the dictionary and keep the character
+  // sequences of the words, they do not depend on the dictionary state
+  Dictionary ScratchDict(dict);
+  std::unordered_map<int, int> WordId2IdxWord;
+  vector<int> Sentence;
+  Sentences.resize(ReferenceFsts.size());
+  for (std::size_t IdxReferenceFst = 0;
+       IdxReferenceFst < ReferenceFsts.size();
+       ++IdxReferenceFst) {
+    ParseLib::ParseSampleAndAddCharacterIdSequenceToDictionary(
+      ReferenceFsts.at(IdxReferenceFst),
+      &ScratchDict,
+      &Sentence,
+      nullptr,
+      std::vector<ArcInfo>()
+    );
+    if (!Sentence.empty()) {
+      Sentence.pop_back();
+    }
+    Sentences.at(IdxReferenceFst).reserve(Sentence.size());
+    for (int WordId : Sentence) {
+      auto IdxWord = WordId2IdxWord.find(WordId);
+      if (IdxWord == WordId2IdxWord.end()) {
+        IdxWord = WordId2IdxWord.insert(
+          std::make_pair(WordId, static_cast<int>(Words.size()))).first;
+        WordBeginLengthPair WordBeginLength =
+          ScratchDict.GetWordBeginLength(WordId);
+        Words.emplace_back(WordBeginLength.first,
+                           WordBeginLength.first + WordBeginLength.second);
+      }
+      Sentences.at(IdxReferenceFst).push_back(IdxWord->second);
+    }
+  }
+}
+
+const vector< vector< int > > &ReferenceWordSequences::GetWords() const
+{
+  return Words;
+}
+
+const vector< vector< int > > &ReferenceWordSequences::GetSentences() const
+{
+  return Sentences;
+}
+
+
+template<typename FunctionType>
+void WERCalculator::ParallelFor(
+  std::size_t NumItems,
+  unsigned int NumThreads,
+  const FunctionType &Fn
+)
+{
+  std::atomic<std::size_t> NextItem(0);
+  auto Worker = [&](unsigned int IdxThread) {
+    for (std::size_t IdxItem = NextItem++;
+         IdxItem < NumItems;
+         IdxItem = NextItem++) {
+      Fn(IdxItem, IdxThread);
+    }
+  };
+
+  std::vector<std::thread> Threads;
+  for (unsigned int IdxThread = 0; IdxThread + 1 < NumThreads; ++IdxThread) {
+    Threads.emplace_back(Worker, IdxThread);
+  }
+  Worker(NumThreads > 0 ? NumThreads - 1 : 0);
+  for (std::thread &Thread : Threads) {
+    Thread.join();
+  }
+}
+
 WERCalculator::WERCalculator(
   const vector< vector< int > > &InputSentences_,
-  const vector< fst::VectorFst< fst::LogArc > > &ReferenceFsts_,
-  const Dictionary &dict_,
+  const ReferenceWordSequences &References,
+  const Dictionary &dict,
   int WHPYLMContextLength,
   unsigned int NumThreads_,
   const std::vector<std::string> &FileNames_,
@@ -64,89 +145,107 @@ WERCalculator::WERCalculator(
 ) :
   EditDistanceCalculator(NumThreads_, FileNames_,
                          Prefix_, OutputEditOperations_),
-  dict(dict_),
-  LexiconCorrNFoundNRef(3, 0),
-  TotalNumReferenceWords(0)
+  LexiconCorrNFoundNRef(3, 0)
 {
-//   std::cout << "Setting LexiconCorrNFoundNRef[1]" << std::endl;
-  LexiconCorrNFoundNRef[1] = dict.GetId2Word().size() - 1;
-//   std::cout << "Triming input sentences" << std::endl;
-  TrimInputSentences(InputSentences_, WHPYLMContextLength);
-//   std::cout << "Parsing reference sentences" << std::endl;
-  ParseReferenceFsts(ReferenceFsts_);
-//   std::cout << "Setting input and reference sentences" << std::endl;
+  vector< vector< int > > InputSentences;
+  TrimInputSentences(InputSentences_, WHPYLMContextLength, NumThreads_,
+                     &InputSentences);
+
+  // translate the cached reference sentences to word ids
+  vector<int> ReferenceWordIds;
+  MapReferenceWords(References, dict, NumThreads_, &ReferenceWordIds);
+  const vector< vector< int > > &ReferenceWordIndices =
+    References.GetSentences();
+  vector< vector< int > > ReferenceSentences(ReferenceWordIndices.size());
+  ParallelFor(ReferenceWordIndices.size(), NumThreads_,
+              [&](std::size_t IdxSentence, unsigned int) {
+    ReferenceSentences[IdxSentence].reserve(
+      ReferenceWordIndices[IdxSentence].size());
+    for (int IdxWord : ReferenceWordIndices[IdxSentence]) {
+      ReferenceSentences[IdxSentence].push_back(ReferenceWordIds[IdxWord]);
+    }
+  });
+
+  int MaxId = dict.GetMaxNumWords() +
+              (LexiconCorrNFoundNRef[2] - LexiconCorrNFoundNRef[0]);
+  vector<int> InputAndReferenceIds(MaxId - dict.GetWordsBegin());
+  std::iota(InputAndReferenceIds.begin(),
+            InputAndReferenceIds.end(),
+            dict.GetWordsBegin());
+
+  // the written forms are only needed to output the edit operations
+  vector<string> Id2CharacterSequenceVector;
+  if (OutputEditOperations_) {
+    Id2CharacterSequenceVector = dict.GetId2CharacterSequenceVector();
+    Id2CharacterSequenceVector.resize(MaxId);
+    const vector< vector< int > > &Words = References.GetWords();
+    for (std::size_t IdxWord = 0; IdxWord < Words.size(); ++IdxWord) {
+      string &WrittenForm =
+        Id2CharacterSequenceVector[ReferenceWordIds[IdxWord]];
+      if (WrittenForm.empty()) {
+        for (int Character : Words[IdxWord]) {
+          WrittenForm += dict.GetCharacterSequence(Character);
+        }
+      }
+    }
+  }
+
   SetInputAndReferenceSentences(InputSentences,
                                 ReferenceSentences,
                                 InputAndReferenceIds,
-                                dict.GetId2CharacterSequenceVector());
-//   std::cout << "Calculating LexiconCorrNFoundNRef" << std::endl;
-  CalcLexiconCorrNFoundNRef();
+                                Id2CharacterSequenceVector);
 }
 
 void WERCalculator::TrimInputSentences(
   const vector< vector< int > > &InputSentences_,
-  int WHPYLMContextLength
+  int WHPYLMContextLength,
+  unsigned int NumThreads,
+  vector< vector< int > > *InputSentences
 )
 {
-  int NumInputSentences = InputSentences_.size();
-  InputSentences.resize(NumInputSentences);
-  for (int IdxInputSentence = 0;
-       IdxInputSentence < NumInputSentences;
-       ++IdxInputSentence) {
-    InputSentences.at(IdxInputSentence).assign(
+  InputSentences->resize(InputSentences_.size());
+  ParallelFor(InputSentences_.size(), NumThreads,
+              [&](std::size_t IdxInputSentence, unsigned int) {
+    InputSentences->at(IdxInputSentence).assign(
       InputSentences_.at(IdxInputSentence).begin() + WHPYLMContextLength,
       InputSentences_.at(IdxInputSentence).end() - 1
     );
-  }
+  });
 }
 
-void WERCalculator::ParseReferenceFsts(
-  const vector< fst::VectorFst< fst::LogArc > > &ReferenceFsts
+void WERCalculator::MapReferenceWords(
+  const ReferenceWordSequences &References,
+  const Dictionary &dict,
+  unsigned int NumThreads,
+  vector< int > *ReferenceWordIds
 )
 {
-  int NumReferenceFsts = ReferenceFsts.size();
-  ReferenceSentences.resize(NumReferenceFsts);
-  for (int IdxReferenceFst = 0;
-       IdxReferenceFst < NumReferenceFsts;
-       ++IdxReferenceFst) {
-//     std::cout << "Parsing reference FST " << IdxReferenceFst << std::flush;
-    ParseLib::ParseSampleAndAddCharacterIdSequenceToDictionary(
-      ReferenceFsts.at(IdxReferenceFst),
-      &dict,
-      &ReferenceSentences.at(IdxReferenceFst),
-      nullptr,
-      std::vector<ArcInfo>()
-    );
-//     std::cout << " Done!" << std::endl << std::flush;
-    ReferenceSentences.at(IdxReferenceFst).pop_back();
-    TotalNumReferenceWords += ReferenceSentences.at(IdxReferenceFst).size();
-  }
-  InputAndReferenceIds.resize(dict.GetMaxNumWords() - dict.GetWordsBegin());
-  std::iota(InputAndReferenceIds.begin(),
-            InputAndReferenceIds.end(),
-            dict.GetWordsBegin());
-}
-
-void WERCalculator::CalcLexiconCorrNFoundNRef()
-{
-  std::vector<int> ConcatenatedReferenceSentences;
-  ConcatenatedReferenceSentences.reserve(TotalNumReferenceWords);
-  for (const std::vector<int> &ReferenceSentence : ReferenceSentences) {
-    ConcatenatedReferenceSentences.insert(ConcatenatedReferenceSentences.end(),
-                                          ReferenceSentence.begin(),
-                                          ReferenceSentence.end());
+  // look up the words in parallel, each thread counts its found words
+  const vector< vector< int > > &Words = References.GetWords();
+  ReferenceWordIds->assign(Words.size(), UNKNOWN);
+  vector<int> NumFoundPerThread(std::max(NumThreads, 1u), 0);
+  ParallelFor(Words.size(), NumThreads,
+              [&](std::size_t IdxWord, unsigned int IdxThread) {
+    int WordId = dict.GetWordId(Words[IdxWord].begin(), Words[IdxWord].size());
+    (*ReferenceWordIds)[IdxWord] = WordId;
+    if (WordId != UNKNOWN) {
+      NumFoundPerThread[IdxThread]++;
+    }
+  });
+
+  // merge the lexicon statistics of the threads
+  LexiconCorrNFoundNRef[0] = std::accumulate(NumFoundPerThread.begin(),
+                                             NumFoundPerThread.end(), 0);
+  LexiconCorrNFoundNRef[1] = dict.GetId2Word().size() - 1;
+  LexiconCorrNFoundNRef[2] = Words.size();
+
+  // words missing in the dictionary are numbered behind the known words
+  int NextNewWordId = dict.GetMaxNumWords();
+  for (int &WordId : *ReferenceWordIds) {
+    if (WordId == UNKNOWN) {
+      WordId = NextNewWordId++;
+    }
   }
-
-  std::sort(ConcatenatedReferenceSentences.begin(),
-            ConcatenatedReferenceSentences.end());
-  std::vector<int>::iterator LastUniqueElement =
-    std::unique(ConcatenatedReferenceSentences.begin(),
-                ConcatenatedReferenceSentences.end());
-  LexiconCorrNFoundNRef[2] =
-    std::distance(ConcatenatedReferenceSentences.begin(),
-                  LastUniqueElement);
-  LexiconCorrNFoundNRef[0] = LexiconCorrNFoundNRef[1] -
-                             (dict.GetId2Word().size() - 1 - LexiconCorrNFoundNRef[2]);
 }
 
 
@@ -63,33 +63,64 @@
 #include "../NHPYLM/Dictionary.hpp"
 #include "EditDistanceCalculator.hpp"
 
+/* reference sentences as character sequences, the reference fsts are parsed
+   once and the words are mapped to the ids of the current dictionary for
+   every evaluation */
+class ReferenceWordSequences {
+  std::vector<std::vector<int> > Words;     // distinct reference words (character ids)
+  std::vector<std::vector<int> > Sentences; // reference sentences (indices into Words)
+
+public:
+  /* constructor */
+  // parse reference fsts, dict is only used to interpret the output labels
+  ReferenceWordSequences(
+    const std::vector< fst::VectorFst< fst::LogArc > > &ReferenceFsts,
+    const Dictionary &dict
+  );
+
+  /* interface */
+  const std::vector<std::vector<int> > &GetWords() const;
+
+  const std::vector<std::vector<int> > &GetSentences() const;
+};
+
 /* class to calculate word error rate of input sentences */
 class WERCalculator : public EditDistanceCalculator {
-  Dictionary dict;
   std::vector<int> LexiconCorrNFoundNRef;
-  std::vector<std::vector<int> > InputSentences;
-  std::vector<std::vector<int> > ReferenceSentences;
-  std::vector<int> InputAndReferenceIds;
-  int TotalNumReferenceWords;
 
 
   /* internal functions */
-  void TrimInputSentences(
+  // remove sentence begin and end symbols from the input sentences
+  static void TrimInputSentences(
     const std::vector< std::vector< int > > &InputSentences_,
-    int WHPYLMContextLength
+    int WHPYLMContextLength,
+    unsigned int NumThreads,
+    std::vector< std::vector< int > > *InputSentences
   );
 
-  void ParseReferenceFsts(
-    const std::vector< fst::VectorFst< fst::LogArc > > &ReferenceFsts);
-  
-  void CalcLexiconCorrNFoundNRef();
+  // map reference words to word ids, words not in the dictionary get new ids
+  // starting at the maximum word id, counts the correctly found words
+  void MapReferenceWords(
+    const ReferenceWordSequences &References,
+    const Dictionary &dict,
+    unsigned int NumThreads,
+    std::vector< int > *ReferenceWordIds
+  );
+
+  // call Fn(IdxItem, IdxThread) for every item in [0, NumItems)
+  template<typename FunctionType>
+  static void ParallelFor(
+    std::size_t NumItems,
+    unsigned int NumThreads,
+    const FunctionType &Fn
+  );
 
 public:
   /* constructor */
   WERCalculator(
     const std::vector< std::vector< int > > &InputSentences_,
-    const std::vector< fst::VectorFst< fst::LogArc > > &ReferenceFsts_,
-    const Dictionary &dict_,
+    const ReferenceWordSequences &References,
+    const Dictionary &dict,
     int WHPYLMContextLength,
     unsigned int NumThreads_,
     const std::vector< std::string > &FileNames_,
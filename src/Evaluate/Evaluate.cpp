@@ -43,29 +43,54 @@
 // ----------------------------------------------------------------------------
 #include "Evaluate.hpp"
 #include "../DebugLib.hpp"
-#include "../EditDistanceCalculator/WERCalculator.hpp"
 #include "../EditDistanceCalculator/PERCalculator.hpp"
 #include "../EditDistanceCalculator/LPERCalculator.hpp"
 
 
 
+EvaluationSnapshot::EvaluationSnapshot(
+    const Dictionary& Dict,
+    const std::vector<std::vector<int>>& SampledSentences,
+    const std::vector<std::vector<ArcInfo>>& TimedSampledSentences,
+    const std::vector<LogVectorFst>& SampledFsts,
+    bool CopySampledFsts,
+    std::size_t IdxIter) :
+  Dict(Dict),
+  SampledSentences(SampledSentences),
+  TimedSampledSentences(TimedSampledSentences),
+  IdxIter(IdxIter)
+{
+  // the copy constructor of VectorFst shares the implementation with the
+  // sampled fst, which is overwritten in the next iteration
+  if (CopySampledFsts) {
+    this->SampledFsts.reserve(SampledFsts.size());
+    for (const LogVectorFst& SampledFst : SampledFsts) {
+      this->SampledFsts.emplace_back(
+        static_cast<const fst::Fst<fst::LogArc>&>(SampledFst));
+    }
+  }
+}
+
 void Evaluate::WriteSentencesToOutputFiles(
+    const Dictionary& Dict,
     const std::vector<std::vector<int>>& SampledSentences,
     const std::vector<std::vector<ArcInfo>>& TimedSampledSentences,
     std::size_t IdxIter)
 {
   // write to output
+  const std::vector<std::string> Id2CharacterSequenceVector =
+    Dict.GetId2CharacterSequenceVector();
   DebugLib::PrintSentencesToFile(
     BuildPrefix("Sentences", IdxIter),
     SampledSentences,
-    LanguageModel->GetId2CharacterSequenceVector()
+    Id2CharacterSequenceVector
   );
 
   if (!InputFileData.GetInputArcInfos().empty()) {
     DebugLib::PrintTimedSentencesToFile(
       BuildPrefix("TimedSentences", IdxIter),
       TimedSampledSentences,
-      LanguageModel->GetId2CharacterSequenceVector(),
+      Id2CharacterSequenceVector,
       InputFileData.GetInputFileNames()
     );
   }
@@ -79,17 +104,38 @@ void Evaluate::WriteSentencesToOutputFiles(
  * - Phoneme error rate
  * - Language model statistics
  * - Timing information
+ * The error rates only need the dictionary and can be calculated on a
+ * snapshot in the background (OutputErrorRates)
  ******************************************************************************/
 void Evaluate::OutputMeasureStatistics(
     const std::vector<std::vector<int>>& SampledSentences,
     const std::vector<LogVectorFst>& SampledFsts,
     std::size_t IdxIter)
+{
+    OutputPerplexity(SampledSentences);
+    OutputErrorRates(*LanguageModel, SampledSentences, SampledFsts, IdxIter,
+                     Params.NoThreads, std::cout);
+    OutputLanguageModelStatistics();
+}
+
+void Evaluate::OutputPerplexity(
+    const std::vector<std::vector<int>>& SampledSentences)
 {
     // get perplexity
     Timer.tCalcPerplexity.SetStart();
-    DebugLib::PrintSentencesPerplexity(SampledSentences, *LanguageModel);
+    DebugLib::PrintSentencesPerplexity(SampledSentences, *LanguageModel,
+                                       Params.NoThreads);
     Timer.tCalcPerplexity.AddTimeSinceStartToDuration();
+}
 
+void Evaluate::OutputErrorRates(
+    const Dictionary& Dict,
+    const std::vector<std::vector<int>>& SampledSentences,
+    const std::vector<LogVectorFst>& SampledFsts,
+    std::size_t IdxIter,
+    unsigned int NumThreads,
+    std::ostream& Out)
+{
     bool OutputEditOperations =
       Params.OutputEditOperations && ((IdxIter == (Params.NumIter - 1)) ||
       (IdxIter == (Params.DeactivateCharacterModel - 1)) ||
@@ -98,17 +144,22 @@ void Evaluate::OutputMeasureStatistics(
     // calculate word error rate
     if (Params.CalculateWER && ((IdxIter % Params.EvalInterval) == 0)) {
       Timer.tCalcWER.SetStart();
-      OutputWordErrorRate(SampledSentences, OutputEditOperations, IdxIter);
+      OutputWordErrorRate(Dict, SampledSentences, OutputEditOperations,
+                          IdxIter, NumThreads, Out);
       Timer.tCalcWER.AddTimeSinceStartToDuration();
     }
 
     // calculate phoneme error rate
     if (Params.CalculatePER && ((IdxIter % Params.EvalInterval) == 0)) {
       Timer.tCalcPER.SetStart();
-      OutputPhonemeErrorRate(SampledFsts, OutputEditOperations, IdxIter);
+      OutputPhonemeErrorRate(SampledFsts, OutputEditOperations, IdxIter,
+                             NumThreads, Out);
       Timer.tCalcPER.AddTimeSinceStartToDuration();
     }
+}
 
+void Evaluate::OutputLanguageModelStatistics()
+{
     // output some language model stats
     DebugLib::PrintLanguageModelStats(*LanguageModel);
     if (CharacterLanguageModel != nullptr) {
@@ -119,20 +170,32 @@ void Evaluate::OutputMeasureStatistics(
     Timer.PrintTimingStatistics();
 }
 
+void Evaluate::OutputCostProfile(
+    const std::vector<SentenceCostProfile>& Profiles,
+    std::size_t IdxIter)
+{
+    CostProfile::WriteCSV(BuildPrefix("CostProfile", IdxIter) + ".csv",
+                          Profiles, InputFileData.GetInputFileNames());
+    CostProfile::PrintSummary(Profiles, InputFileData.GetInputFileNames());
+}
+
 void Evaluate::OutputWordErrorRate(
+    const Dictionary& Dict,
     const std::vector<std::vector<int>>& SampledSentences,
     bool OutputEditOperations,
-    std::size_t IdxIter)
+    std::size_t IdxIter,
+    unsigned int NumThreads,
+    std::ostream& Out)
 {
 //       std::cout << "Start WER calculation" << std::endl;
-  std::size_t WHPYLMContextLength = LanguageModel->GetWHPYLMOrder() - 1;
+  std::size_t WHPYLMContextLength = WHPYLMOrder - 1;
 
   WERCalculator SegStatsCalculator(
     SampledSentences,
-    InputFileData.GetReferenceFsts(),
-    *LanguageModel,
+    *ReferenceWords,
+    Dict,
     WHPYLMContextLength,
-    1,
+    NumThreads,
     InputFileData.GetInputFileNames(),
     BuildPrefix("WER", IdxIter) + "_",
     OutputEditOperations
@@ -141,22 +204,26 @@ void Evaluate::OutputWordErrorRate(
   DebugLib::PrintEditDistanceStatistics(
       SegStatsCalculator.GetInsDelSubCorrNFoundNRef(),
       "Word error rate",
-      "WER");
+      "WER",
+      Out);
 
   DebugLib::PrintLexiconStatistics(
-      SegStatsCalculator.GetLexiconCorrNFoundNRef());
+      SegStatsCalculator.GetLexiconCorrNFoundNRef(),
+      Out);
 }
 
 void Evaluate::OutputPhonemeErrorRate(
       const std::vector<LogVectorFst>& SampledFsts,
       bool OutputEditOperations,
-      std::size_t IdxIter)
+      std::size_t IdxIter,
+      unsigned int NumThreads,
+      std::ostream& Out)
 {
     PERCalculator PhonemeStatsCalculator(
       SampledFsts,
       InputFileData.GetReferenceFsts(),
       InputFileData.GetReferenceIntToStringVector(),
-      Params.NoThreads,
+      NumThreads,
       InputFileData.GetInputFileNames(),
       BuildPrefix("PER", IdxIter) + "_",
       OutputEditOperations,
@@ -166,15 +233,16 @@ void Evaluate::OutputPhonemeErrorRate(
     DebugLib::PrintEditDistanceStatistics(
       PhonemeStatsCalculator.GetInsDelSubCorrNFoundNRef(),
       "Phoneme error rate",
-      "PER"
+      "PER",
+      Out
     );
 }
 
 std::string Evaluate::BuildPrefix(std::string specifier, std::size_t IdxIter)
 {
   return Params.OutputDirectoryBasename +
-      "KnownN_" + std::to_string(LanguageModel->GetWHPYLMOrder()) +
-      "_UnkN_" + std::to_string(LanguageModel->GetCHPYLMOrder()) +
+      "KnownN_" + std::to_string(WHPYLMOrder) +
+      "_UnkN_" + std::to_string(CHPYLMOrder) +
       "/" + Params.OutputFilesBasename + specifier +
       "_Iter_" + std::to_string(IdxIter + 1);
 }
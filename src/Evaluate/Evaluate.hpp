@@ -60,10 +60,32 @@
 #ifndef _EVALUATE_HPP_
 #define _EVALUATE_HPP_
 
+#include <ostream>
 #include "../FileReader/FileData.hpp"
 #include "../ParameterParser/ParameterParser.hpp"
 #include "../LatticeWordSegmentationTimer.hpp"
 #include "../NHPYLM/NHPYLM.hpp"
+#include "../EditDistanceCalculator/WERCalculator.hpp"
+#include "../CostProfile.hpp"
+
+/* copy of the results of an iteration, evaluated in the background while
+   the next iteration is sampled */
+struct EvaluationSnapshot {
+  Dictionary Dict;                                         // frozen copy of the dictionary
+  std::vector<std::vector<int>> SampledSentences;          // the segmented sentences
+  std::vector<std::vector<ArcInfo>> TimedSampledSentences; // the segmented sentences with start/end times
+  std::vector<LogVectorFst> SampledFsts;                   // deep copies of the sampled fsts (only for the PER)
+  std::size_t IdxIter;                                     // the evaluated iteration
+
+  EvaluationSnapshot(
+    const Dictionary& Dict,
+    const std::vector<std::vector<int>>& SampledSentences,
+    const std::vector<std::vector<ArcInfo>>& TimedSampledSentences,
+    const std::vector<LogVectorFst>& SampledFsts,
+    bool CopySampledFsts,
+    std::size_t IdxIter
+  );
+};
 
 class Evaluate{
   const ParameterStruct& Params;
@@ -71,18 +93,26 @@ class Evaluate{
   LatticeWordSegmentationTimer& Timer;
   const NHPYLM* LanguageModel;
   const NHPYLM* CharacterLanguageModel;
+  const ReferenceWordSequences* ReferenceWords;
+  std::size_t WHPYLMOrder;
+  std::size_t CHPYLMOrder;
 
   /* internal functions */
   void OutputPhonemeErrorRate(
     const std::vector<LogVectorFst>& SampledFsts,
     bool OutputEditOperations,
-    std::size_t IdxIter
+    std::size_t IdxIter,
+    unsigned int NumThreads,
+    std::ostream& Out
   );
 
   void OutputWordErrorRate(
+    const Dictionary& Dict,
     const std::vector<std::vector<int>>& SampledSentences,
     bool OutputEditOperations,
-    std::size_t IdxIter
+    std::size_t IdxIter,
+    unsigned int NumThreads,
+    std::ostream& Out
   );
 
   std::string BuildPrefix(
@@ -97,27 +127,59 @@ public:
     const FileData& InputFileData,
     LatticeWordSegmentationTimer& Timer,
     const NHPYLM* LanguageModel,
-    const NHPYLM* CharacterLanguageModel
+    const NHPYLM* CharacterLanguageModel,
+    const ReferenceWordSequences* ReferenceWords
   ) :
     Params(Params),
     InputFileData(InputFileData),
     Timer(Timer),
     LanguageModel(LanguageModel),
-    CharacterLanguageModel(CharacterLanguageModel) {};
+    CharacterLanguageModel(CharacterLanguageModel),
+    ReferenceWords(ReferenceWords),
+    WHPYLMOrder(LanguageModel->GetWHPYLMOrder()),
+    CHPYLMOrder(LanguageModel->GetCHPYLMOrder()) {};
 
 
   /* interface */
+  // the dictionary may be a snapshot, the language models are not used
   void WriteSentencesToOutputFiles(
+    const Dictionary& Dict,
     const std::vector<std::vector<int>>& SampledSentences,
     const std::vector<std::vector<ArcInfo>>& TimedSampledSentences,
     std::size_t IdxIter
   );
 
+  // all statistics below in the order of the synchronous evaluation
   void OutputMeasureStatistics(
     const std::vector<std::vector<int>>& SampledSentences,
     const std::vector<LogVectorFst>& SampledFsts,
     std::size_t IdxIter
   );
+
+  void OutputPerplexity(
+    const std::vector<std::vector<int>>& SampledSentences
+  );
+
+  // word and phoneme error rate calculated with NumThreads threads and
+  // printed to Out, the dictionary may be a snapshot, the language models
+  // are not used
+  void OutputErrorRates(
+    const Dictionary& Dict,
+    const std::vector<std::vector<int>>& SampledSentences,
+    const std::vector<LogVectorFst>& SampledFsts,
+    std::size_t IdxIter,
+    unsigned int NumThreads,
+    std::ostream& Out
+  );
+
+  // language model and timing statistics
+  void OutputLanguageModelStatistics();
+
+  // write the per sentence costs of the sampling and print their percentiles
+  void OutputCostProfile(
+    const std::vector<SentenceCostProfile>& Profiles,
+    std::size_t IdxIter
+  );
 };
 
 
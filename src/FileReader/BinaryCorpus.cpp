@@ -0,0 +1,329 @@
+// ----------------------------------------------------------------------------
+/**
+   File: BinaryCorpus.cpp
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+*/
+// ----------------------------------------------------------------------------
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "BinaryCorpus.hpp"
+
+const char BinaryCorpus::Magic[8] = {'L', 'W', 'S', 'C', 'O', 'R', 'P', '\0'};
+const uint32_t BinaryCorpus::kFileVersion = 1;
+
+uint64_t BinaryCorpus::Align(uint64_t Size)
+{
+  return (Size + 7) & ~static_cast<uint64_t>(7);
+}
+
+void BinaryCorpus::WriteArray(std::ostream &Out, const void *Data, uint64_t Size)
+{
+  static const char Padding[8] = {0};
+  Out.write(static_cast<const char *>(Data), Size);
+  Out.write(Padding, Align(Size) - Size);
+}
+
+void BinaryCorpus::WriteStrings(std::ostream &Out, const std::vector<std::string> &Strings)
+{
+  std::vector<uint64_t> Offsets(1, 0);
+  Offsets.reserve(Strings.size() + 1);
+  std::string Characters;
+  for (const std::string &String : Strings) {
+    Characters += String;
+    Offsets.push_back(Characters.size());
+  }
+  WriteArray(Out, Offsets.data(), Offsets.size() * sizeof(uint64_t));
+  WriteArray(Out, Characters.data(), Characters.size());
+}
+
+const char *BinaryCorpus::SkipSection(const char *Data, const char *End, uint64_t NumElements, uint64_t ElementSize)
+{
+  if ((Data == nullptr) || (NumElements > static_cast<uint64_t>(End - Data) / ElementSize) ||
+      (Align(NumElements * ElementSize) > static_cast<uint64_t>(End - Data))) {
+    return nullptr;
+  }
+  return Data + Align(NumElements * ElementSize);
+}
+
+bool BinaryCorpus::ValidOffsets(const uint64_t *Offsets, uint64_t NumOffsets, uint64_t Total)
+{
+  if ((Offsets[0] != 0) || (Offsets[NumOffsets] != Total)) {
+    return false;
+  }
+  for (uint64_t Idx = 0; Idx < NumOffsets; ++Idx) {
+    if (Offsets[Idx] > Offsets[Idx + 1]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const char *BinaryCorpus::ReadStrings(const char *Data, const char *End, uint64_t NumStrings, std::vector<std::string> *Strings)
+{
+  const uint64_t *Offsets = reinterpret_cast<const uint64_t *>(Data);
+  const char *Characters = SkipSection(Data, End, NumStrings + 1, sizeof(uint64_t));
+  if ((Characters == nullptr) ||
+      !ValidOffsets(Offsets, NumStrings, Offsets[NumStrings]) ||
+      (SkipSection(Characters, End, Offsets[NumStrings], 1) == nullptr)) {
+    return nullptr;
+  }
+  Strings->clear();
+  Strings->reserve(NumStrings);
+  for (uint64_t StringIdx = 0; StringIdx < NumStrings; ++StringIdx) {
+    Strings->emplace_back(Characters + Offsets[StringIdx],
+                          Offsets[StringIdx + 1] - Offsets[StringIdx]);
+  }
+  return Characters + Align(Offsets[NumStrings]);
+}
+
+void BinaryCorpus::Write(
+  const std::string &FileName,
+  const std::vector<std::string> &Symbols,
+  const std::vector<LogVectorFst> &Fsts,
+  const std::vector<std::string> &FstFileNames,
+  const std::vector<ArcInfo> &ArcInfos
+)
+{
+  std::cout << "  Writing binary corpus to " << FileName << std::endl;
+
+  // flatten all lattices into state and arc arrays
+  std::vector<uint64_t> LatticeOffsets(1, 0);
+  std::vector<int32_t> StartStates;
+  std::vector<uint64_t> StateOffsets(1, 0);
+  std::vector<float> FinalWeights;
+  std::vector<Arc> Arcs;
+  LatticeOffsets.reserve(Fsts.size() + 1);
+  StartStates.reserve(Fsts.size());
+  for (const LogVectorFst &Fst : Fsts) {
+    for (StateId State = 0; State < Fst.NumStates(); ++State) {
+      for (fst::ArcIterator<LogVectorFst> aiter(Fst, State); !aiter.Done(); aiter.Next()) {
+        const fst::LogArc &LogArc = aiter.Value();
+        Arcs.push_back({LogArc.ilabel, LogArc.olabel, LogArc.weight.Value(), LogArc.nextstate});
+      }
+      StateOffsets.push_back(Arcs.size());
+      FinalWeights.push_back(Fst.Final(State).Value());
+    }
+    LatticeOffsets.push_back(FinalWeights.size());
+    StartStates.push_back(Fst.Start());
+  }
+
+  std::vector<StoredArcInfo> StoredArcInfos;
+  StoredArcInfos.reserve(ArcInfos.size());
+  for (const ArcInfo &Info : ArcInfos) {
+    StoredArcInfos.push_back({Info.label, Info.start, Info.end});
+  }
+
+  Header FileHeader;
+  std::memset(&FileHeader, 0, sizeof(Header));
+  std::memcpy(FileHeader.Magic, Magic, sizeof(Magic));
+  FileHeader.Version = kFileVersion;
+  FileHeader.NumSymbols = Symbols.size();
+  FileHeader.NumLattices = Fsts.size();
+  FileHeader.NumStates = FinalWeights.size();
+  FileHeader.NumArcs = Arcs.size();
+  FileHeader.NumArcInfos = StoredArcInfos.size();
+
+  std::ofstream Out(FileName, std::ios::binary);
+  if (!Out) {
+    std::ostringstream err;
+    err << "Could not open binary corpus file " << FileName << " for writing" << std::endl;
+    throw std::runtime_error(err.str());
+  }
+  WriteArray(Out, &FileHeader, sizeof(Header));
+  WriteStrings(Out, Symbols);
+  WriteStrings(Out, FstFileNames);
+  WriteArray(Out, LatticeOffsets.data(), LatticeOffsets.size() * sizeof(uint64_t));
+  WriteArray(Out, StartStates.data(), StartStates.size() * sizeof(int32_t));
+  WriteArray(Out, StateOffsets.data(), StateOffsets.size() * sizeof(uint64_t));
+  WriteArray(Out, FinalWeights.data(), FinalWeights.size() * sizeof(float));
+  WriteArray(Out, Arcs.data(), Arcs.size() * sizeof(Arc));
+  WriteArray(Out, StoredArcInfos.data(), StoredArcInfos.size() * sizeof(StoredArcInfo));
+  if (!Out) {
+    std::ostringstream err;
+    err << "Could not write binary corpus file " << FileName << std::endl;
+    throw std::runtime_error(err.str());
+  }
+}
+
+void BinaryCorpus::Read(
+  const std::string &FileName,
+  StringToIntMapper *Symbols,
+  std::vector<LogVectorFst> *Fsts,
+  std::vector<std::string> *FstFileNames,
+  std::vector<ArcInfo> *ArcInfos
+)
+{
+  std::cout << "  Reading binary corpus from " << FileName << std::endl;
+
+  // map the whole file read only, so that pages are shared between processes
+  int FileDescriptor = open(FileName.c_str(), O_RDONLY);
+  struct stat FileStatus;
+  if ((FileDescriptor < 0) || (fstat(FileDescriptor, &FileStatus) != 0)) {
+    std::ostringstream err;
+    err << "Could not open binary corpus file " << FileName << std::endl;
+    throw std::runtime_error(err.str());
+  }
+  std::size_t FileSize = FileStatus.st_size;
+  void *Mapping = (FileSize >= sizeof(Header)) ?
+    mmap(nullptr, FileSize, PROT_READ, MAP_SHARED, FileDescriptor, 0) : MAP_FAILED;
+  close(FileDescriptor);
+  if (Mapping == MAP_FAILED) {
+    std::ostringstream err;
+    err << "Could not map binary corpus file " << FileName << std::endl;
+    throw std::runtime_error(err.str());
+  }
+
+  const char *Data = static_cast<const char *>(Mapping);
+  Header FileHeader;
+  std::memcpy(&FileHeader, Data, sizeof(Header));
+  if ((std::memcmp(FileHeader.Magic, Magic, sizeof(Magic)) != 0) ||
+      (FileHeader.Version != kFileVersion)) {
+    munmap(Mapping, FileSize);
+    std::ostringstream err;
+    err << "File " << FileName << " is not a binary corpus of version "
+        << kFileVersion << std::endl;
+    throw std::runtime_error(err.str());
+  }
+
+  // every section is checked to lie within the file before it is read
+  const char *End = Data + FileSize;
+  auto ThrowTruncated = [&]() {
+    munmap(Mapping, FileSize);
+    std::ostringstream err;
+    err << "Binary corpus file " << FileName << " is truncated" << std::endl;
+    throw std::runtime_error(err.str());
+  };
+
+  // every element takes at least one byte, so larger counts cannot be valid
+  // (this also keeps the counts + 1 from overflowing)
+  if ((FileHeader.NumSymbols >= FileSize) || (FileHeader.NumLattices >= FileSize) ||
+      (FileHeader.NumStates >= FileSize) || (FileHeader.NumArcs >= FileSize) ||
+      (FileHeader.NumArcInfos >= FileSize)) {
+    ThrowTruncated();
+  }
+
+  // locate the sections
+  std::vector<std::string> SymbolStrings;
+  Data = ReadStrings(Data + Align(sizeof(Header)), End, FileHeader.NumSymbols, &SymbolStrings);
+  Data = (Data != nullptr) ? ReadStrings(Data, End, FileHeader.NumLattices, FstFileNames) : nullptr;
+  const uint64_t *LatticeOffsets = reinterpret_cast<const uint64_t *>(Data);
+  Data = SkipSection(Data, End, FileHeader.NumLattices + 1, sizeof(uint64_t));
+  const int32_t *StartStates = reinterpret_cast<const int32_t *>(Data);
+  Data = SkipSection(Data, End, FileHeader.NumLattices, sizeof(int32_t));
+  const uint64_t *StateOffsets = reinterpret_cast<const uint64_t *>(Data);
+  Data = SkipSection(Data, End, FileHeader.NumStates + 1, sizeof(uint64_t));
+  const float *FinalWeights = reinterpret_cast<const float *>(Data);
+  Data = SkipSection(Data, End, FileHeader.NumStates, sizeof(float));
+  const Arc *Arcs = reinterpret_cast<const Arc *>(Data);
+  Data = SkipSection(Data, End, FileHeader.NumArcs, sizeof(Arc));
+  const StoredArcInfo *StoredArcInfos = reinterpret_cast<const StoredArcInfo *>(Data);
+  Data = SkipSection(Data, End, FileHeader.NumArcInfos, sizeof(StoredArcInfo));
+  if (Data == nullptr) {
+    ThrowTruncated();
+  }
+
+  // the lattices have to partition the states and the states the arcs
+  if (!ValidOffsets(LatticeOffsets, FileHeader.NumLattices, FileHeader.NumStates) ||
+      !ValidOffsets(StateOffsets, FileHeader.NumStates, FileHeader.NumArcs)) {
+    ThrowTruncated();
+  }
+
+  // the symbols have to keep the ids they had when writing the corpus
+  for (uint64_t SymbolIdx = 0; SymbolIdx < SymbolStrings.size(); ++SymbolIdx) {
+    if (Symbols->Insert(SymbolStrings[SymbolIdx]) != static_cast<int>(SymbolIdx)) {
+      munmap(Mapping, FileSize);
+      std::ostringstream err;
+      err << "Symbol " << SymbolStrings[SymbolIdx] << " of binary corpus "
+          << FileName << " does not match the symbol table" << std::endl;
+      throw std::runtime_error(err.str());
+    }
+  }
+
+  // rebuild the lattices directly from the flat arrays
+  Fsts->resize(FileHeader.NumLattices);
+  for (uint64_t LatticeIdx = 0; LatticeIdx < FileHeader.NumLattices; ++LatticeIdx) {
+    LogVectorFst &Fst = (*Fsts)[LatticeIdx];
+    uint64_t StatesBegin = LatticeOffsets[LatticeIdx];
+    uint64_t NumStates = LatticeOffsets[LatticeIdx + 1] - StatesBegin;
+    if ((NumStates > 0) && ((StartStates[LatticeIdx] < 0) ||
+                            (static_cast<uint64_t>(StartStates[LatticeIdx]) >= NumStates))) {
+      ThrowTruncated();
+    }
+    Fst.DeleteStates();
+    Fst.ReserveStates(NumStates);
+    for (uint64_t State = 0; State < NumStates; ++State) {
+      Fst.AddState();
+    }
+    for (uint64_t State = 0; State < NumStates; ++State) {
+      uint64_t ArcsBegin = StateOffsets[StatesBegin + State];
+      uint64_t ArcsEnd = StateOffsets[StatesBegin + State + 1];
+      Fst.ReserveArcs(State, ArcsEnd - ArcsBegin);
+      for (uint64_t ArcIdx = ArcsBegin; ArcIdx < ArcsEnd; ++ArcIdx) {
+        const Arc &StoredArc = Arcs[ArcIdx];
+        if ((StoredArc.nextstate < 0) || (static_cast<uint64_t>(StoredArc.nextstate) >= NumStates)) {
+          ThrowTruncated();
+        }
+        Fst.AddArc(State, fst::LogArc(StoredArc.ilabel, StoredArc.olabel,
+                                      StoredArc.weight, StoredArc.nextstate));
+      }
+      Fst.SetFinal(State, FinalWeights[StatesBegin + State]);
+    }
+    if (NumStates > 0) {
+      Fst.SetStart(StartStates[LatticeIdx]);
+    }
+  }
+
+  ArcInfos->clear();
+  ArcInfos->reserve(FileHeader.NumArcInfos);
+  for (uint64_t InfoIdx = 0; InfoIdx < FileHeader.NumArcInfos; ++InfoIdx) {
+    const StoredArcInfo &Info = StoredArcInfos[InfoIdx];
+    ArcInfos->push_back(ArcInfo(Info.label, Info.start, Info.end));
+  }
+
+  munmap(Mapping, FileSize);
+  std::cout << "  Read " << FileHeader.NumLattices << " lattices with "
+            << FileHeader.NumStates << " states and " << FileHeader.NumArcs
+            << " arcs" << std::endl;
+}
@@ -0,0 +1,178 @@
+// ----------------------------------------------------------------------------
+/**
+   File: BinaryCorpus.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+
+   E-Mail: agent@local
+
+   Description: memory mappable binary file holding preprocessed input lattices
+
+   Limitations: -
+
+   Change History:
+   Date         Author       Description
+   2026-10-19   agent        Initial
+*/
+// ----------------------------------------------------------------------------
+#ifndef _BINARYCORPUS_HPP_
+#define _BINARYCORPUS_HPP_
+
+#include <cstdint>
+#include <fst/vector-fst.h>
+#include "definitions.hpp"
+#include "StringToIntMapper.hpp"
+
+/* Binary corpus file holding the preprocessed input lattices together with
+   the symbols, file names and arc infos. All lattices are stored in one flat
+   CSR style arc array, so the file can be memory mapped and read without any
+   parsing. Layout (native byte order, every section aligned to 8 bytes):
+     Header
+     symbol offsets    uint64_t[NumSymbols + 1], symbol characters
+     file name offsets uint64_t[NumLattices + 1], file name characters
+     lattice offsets   uint64_t[NumLattices + 1] (first state of lattice)
+     start states      int32_t[NumLattices]
+     state offsets     uint64_t[NumStates + 1] (first arc of state)
+     final weights     float[NumStates]
+     arcs              Arc[NumArcs]
+     arc infos         StoredArcInfo[NumArcInfos] */
+class BinaryCorpus {
+  static const char Magic[8];        // file identifier
+  static const uint32_t kFileVersion; // version of the file layout
+
+  /* header at the beginning of the file */
+  struct Header {
+    char Magic[8];
+    uint32_t Version;
+    uint32_t Reserved;
+    uint64_t NumSymbols;
+    uint64_t NumLattices;
+    uint64_t NumStates;
+    uint64_t NumArcs;
+    uint64_t NumArcInfos;
+  };
+
+  /* arc as stored in the file */
+  struct Arc {
+    int32_t ilabel;
+    int32_t olabel;
+    float weight;
+    int32_t nextstate;
+  };
+
+  /* arc info as stored in the file */
+  struct StoredArcInfo {
+    int32_t label;
+    float start;
+    float end;
+  };
+
+  /* internal functions */
+  // size rounded up to the section alignment
+  static uint64_t Align(
+    uint64_t Size
+  );
+
+  // write strings as offset array followed by the characters
+  static void WriteStrings(
+    std::ostream &Out,
+    const std::vector<std::string> &Strings
+  );
+
+  // write array and pad to the section alignment
+  static void WriteArray(
+    std::ostream &Out,
+    const void *Data,
+    uint64_t Size
+  );
+
+  // pointer behind the section of NumElements elements of ElementSize bytes
+  // starting at Data, nullptr if the section does not end before End
+  static const char *SkipSection(
+    const char *Data,
+    const char *End,
+    uint64_t NumElements,
+    uint64_t ElementSize
+  );
+
+  // check that Offsets[0 .. NumOffsets] start with 0, do not decrease and
+  // end with Total
+  static bool ValidOffsets(
+    const uint64_t *Offsets,
+    uint64_t NumOffsets,
+    uint64_t Total
+  );
+
+  // read strings written by WriteStrings, returns pointer behind the section,
+  // nullptr if the section is invalid or does not end before End
+  static const char *ReadStrings(
+    const char *Data,
+    const char *End,
+    uint64_t NumStrings,
+    std::vector<std::string> *Strings
+  );
+
+public:
+  /* interface */
+  // write lattices, symbols, file names and arc infos to file
+  static void Write(
+    const std::string &FileName,
+    const std::vector<std::string> &Symbols,
+    const std::vector<LogVectorFst> &Fsts,
+    const std::vector<std::string> &FstFileNames,
+    const std::vector<ArcInfo> &ArcInfos
+  );
+
+  // map file into memory and read lattices, symbols, file names and arc infos
+  static void Read(
+    const std::string &FileName,
+    StringToIntMapper *Symbols,
+    std::vector<LogVectorFst> *Fsts,
+    std::vector<std::string> *FstFileNames,
+    std::vector<ArcInfo> *ArcInfos
+  );
+};
+
+#endif
@@ -41,6 +41,7 @@
    Author: Thomas Glarner
 */
 // ----------------------------------------------------------------------------
+#include <utility>
 #include "FileData.hpp"
 
 FileData::FileData(
@@ -57,34 +58,18 @@ FileData::FileData(
   std::vector<std::string> ReferenceFileNames,
   LogVectorFst WordEndTransducer
 ) :
-  GlobalStringToInt(GlobalStringToInt),
-  InitStringToInt(InitStringToInt),
-  InitFsts(InitFsts),
-  InitFileNames(InitFileNames),
-  InputStringToInt(InputStringToInt),
-  InputFsts(InputFsts),
-  InputFileNames(InputFileNames),
-  InputArcInfos(InputArcInfos),
-  ReferenceStringToInt(ReferenceStringToInt),
-  ReferenceFsts(ReferenceFsts),
-  ReferenceFileNames(ReferenceFileNames),
-  WordEndTransducer(WordEndTransducer)
-{
-}
-
-FileData::FileData(const FileData& lhs) :
-  GlobalStringToInt(lhs.GlobalStringToInt),
-  InitStringToInt(lhs.InitStringToInt),
-  InitFsts(lhs.InitFsts),
-  InitFileNames(lhs.InitFileNames),
-  InputStringToInt(lhs.InputStringToInt),
-  InputFsts(lhs.InputFsts),
-  InputFileNames(lhs.InputFileNames),
-  InputArcInfos(lhs.InputArcInfos),
-  ReferenceStringToInt(lhs.ReferenceStringToInt),
-  ReferenceFsts(lhs.ReferenceFsts),
-  ReferenceFileNames(lhs.ReferenceFileNames),
-  WordEndTransducer(lhs.WordEndTransducer)
+  GlobalStringToInt(std::move(GlobalStringToInt)),
+  InitStringToInt(std::move(InitStringToInt)),
+  InitFsts(std::move(InitFsts)),
+  InitFileNames(std::move(InitFileNames)),
+  InputStringToInt(std::move(InputStringToInt)),
+  InputFsts(std::move(InputFsts)),
+  InputFileNames(std::move(InputFileNames)),
+  InputArcInfos(std::move(InputArcInfos)),
+  ReferenceStringToInt(std::move(ReferenceStringToInt)),
+  ReferenceFsts(std::move(ReferenceFsts)),
+  ReferenceFileNames(std::move(ReferenceFileNames)),
+  WordEndTransducer(std::move(WordEndTransducer))
 {
 }
 
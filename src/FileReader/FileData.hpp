@@ -106,8 +106,9 @@ public:
   );
 
 
-  /* Copy Constructor */
-  FileData(const FileData& lhs);
+  /* FileData holds the whole corpus, it is moved and never copied */
+  FileData(const FileData& lhs) = delete;
+  FileData(FileData&& rhs) = default;
 
 
   /* interface */
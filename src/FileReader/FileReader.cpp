@@ -42,11 +42,16 @@
 */
 // ----------------------------------------------------------------------------
 #include <unordered_map>
+#include <atomic>
+#include <memory>
+#include <thread>
 #include <boost/filesystem/path.hpp>
 #include <fst/rmepsilon.h>
 #include <fst/arcsort.h>
 #include <fst/compose.h>
 #include "FileReader.hpp"
+#include "BinaryCorpus.hpp"
+#include "HTKLatticeParser.hpp"
 #include <CustomArcMappers.hpp>
 #include <cstdlib>
 #include "definitions.hpp"
@@ -66,13 +71,18 @@ FileReader::FileReader(const ParameterStruct& Params) :
   // read the initialization, input and reference data,
   // export data if specified and do some prepocessing
   // of the input lattices (acoustic model scaling and
-  // application of word end and sentence end transducers
-  if (!Params.SymbolFile.empty()) {
-    ReadSymbols();
-  }
+  // application of word end and sentence end transducers)
+  // or read the already preprocessed input from a binary corpus
+  if (!Params.ReadCorpusFile.empty()) {
+    ReadBinaryCorpus();
+  } else {
+    if (!Params.SymbolFile.empty()) {
+      ReadSymbols();
+    }
 
-  if (!Params.InputArcInfosFile.empty()) {
-    ReadInputArcInfos();
+    if (!Params.InputArcInfosFile.empty()) {
+      ReadInputArcInfos();
+    }
   }
 
   if (Params.UseDictFile) {
@@ -83,6 +93,18 @@ FileReader::FileReader(const ParameterStruct& Params) :
     ReadInitTranscription();
   }
 
+  if (!Params.ReadCorpusFile.empty()) {
+    InputStringToInt = GlobalStringToInt;
+    if (Params.UseReferenceTranscription) {
+      ReadReferenceTranscription();
+      if (Params.CalculateLPER) {
+        std::cout << "Warning: LPER can not be calculated from the"
+                  << " preprocessed lattices of a binary corpus!" << std::endl;
+      }
+    }
+    return;
+  }
+
   ReadInputFilesFromList();
 
   if (Params.ExportLattices) {
@@ -102,14 +124,22 @@ FileReader::FileReader(const ParameterStruct& Params) :
   ApplyWordEndTransducer();
   ApplySentEndTransducer();
 
+  if (!Params.WriteCorpusFile.empty()) {
+    WriteBinaryCorpus();
+  }
 }
 
-FileData FileReader::GetInputFileData()
+FileData FileReader::GetInputFileData() &&
 {
-  return FileData(GlobalStringToInt, InitStringToInt, InitFsts, InitFileNames,
-                  InputStringToInt, InputFsts, InputFileNames, InputArcInfos,
-                  ReferenceStringToInt, ReferenceFsts, ReferenceFileNames,
-                  GetWordEndTransducer());
+  // build the transducer first, the symbols are moved out below
+  LogVectorFst WordEndTransducer =
+    GetWordEndTransducer(InputStringToInt.GetSize());
+  return FileData(std::move(GlobalStringToInt), std::move(InitStringToInt),
+                  std::move(InitFsts), std::move(InitFileNames),
+                  std::move(InputStringToInt), std::move(InputFsts),
+                  std::move(InputFileNames), std::move(InputArcInfos),
+                  std::move(ReferenceStringToInt), std::move(ReferenceFsts),
+                  std::move(ReferenceFileNames), std::move(WordEndTransducer));
 }
 
 
@@ -127,6 +157,22 @@ void FileReader::WriteInputArcInfos() const
 }
 
 
+void FileReader::ReadBinaryCorpus()
+{
+  BinaryCorpus::Read(Params.ReadCorpusFile, &GlobalStringToInt, &InputFsts,
+                     &InputFileNames, &InputArcInfos);
+  InputStringToInt = GlobalStringToInt;
+}
+
+
+void FileReader::WriteBinaryCorpus() const
+{
+  BinaryCorpus::Write(Params.WriteCorpusFile,
+                      InputStringToInt.GetIntToStringVector(), InputFsts,
+                      InputFileNames, InputArcInfos);
+}
+
+
 void FileReader::ReadInputArcInfos()
 {
   std::cout << "  Reading input arc information from "
@@ -218,295 +264,383 @@ void FileReader::ReadInputFilesFromList()
 }
 
 
-void FileReader::ReadHTKLattices()
+void FileReader::ParallelForEach(
+  std::size_t NumItems,
+  const std::function<void(std::size_t)> &Fn
+) const
 {
-  for (std::size_t InputFileId = 0;
-       InputFileId < Params.InputFiles.size(); InputFileId++) {
-    std::cout << "Reading nBest file [" << InputFileId << "/"
-              << Params.InputFiles.size() << "] from HTK FST "
-              << Params.InputFiles.at(InputFileId) << std::endl;
-
-    // some variables
-    float lmscale = Params.HTKLMScale;
-    int debug_ = 0;
-    std::string line;
-    std::string utterance;
-
-    // open file
-    std::ifstream in(Params.InputFiles[InputFileId]);
-
-    //get Version (first line)
-    std::getline(in, line);
-
-    //get Utterance
-    std::getline(in, line);
-    std::size_t pos = line.find("=");
-    utterance = line.substr(pos + 1);
-    if (debug_) {
-      std::cout << "Reading utterance: " << utterance << std::endl;
+  std::size_t NumThreads =
+    std::max<std::size_t>(1, std::min<std::size_t>(Params.NoThreads, NumItems));
+
+  // items are handed out one by one, since lattice sizes vary a lot
+  std::atomic<std::size_t> NextItem(0);
+  auto Worker = [&]() {
+    for (std::size_t Item = NextItem++; Item < NumItems; Item = NextItem++) {
+      Fn(Item);
     }
+  };
+
+  std::vector<std::thread> Threads(NumThreads - 1);
+  for (std::size_t IdxThread = 0; IdxThread < (NumThreads - 1); ++IdxThread) {
+    Threads[IdxThread] = std::thread(Worker);
+  }
+  Worker();
+  for (std::size_t IdxThread = 0; IdxThread < (NumThreads - 1); ++IdxThread) {
+    Threads[IdxThread].join();
+  }
+}
 
-//     //get LM factor
-//     while (std::getline(in, line) &&
-//         line.substr(0, 7) != "lmscale" && line.substr(0, 1) != "N") {
-//       std::getline(in, line);
-//     }
-// 
-//     if (line.substr(0, 7) == "lmscale") {
-//       std::istringstream iss(line);
-//       string lmScaleString;
-//       iss >> lmScaleString;
-//       pos = lmScaleString.find("=");
-//       lmscale = std::stof(lmScaleString.substr(pos + 1));
-//     }
 
-    //get Nodes and Links
-    while (in.good() && line.substr(0, 1) != "N") {
-      std::getline(in, line);
+void FileReader::ReadHTKLattices()
+{
+  // parse the files in parallel, every lattice uses its own symbols
+  std::vector<LocalLattice> Lattices(Params.InputFiles.size());
+  ParallelForEach(Lattices.size(), [&](std::size_t InputFileId) {
+    Lattices[InputFileId].Log << "Reading nBest file [" << InputFileId << "/"
+                              << Params.InputFiles.size() << "] from HTK FST "
+                              << Params.InputFiles.at(InputFileId) << std::endl;
+    ReadHTKLattice(Params.InputFiles.at(InputFileId), InputFileId,
+                   &Lattices[InputFileId]);
+  });
+
+  // merge the symbols in file order, so that the global ids are the same as
+  // for reading the files one after another
+  std::vector<std::vector<int> > SymbolMaps(Lattices.size());
+  std::vector<std::size_t> ArcInfoOffsets(Lattices.size());
+  for (std::size_t InputFileId = 0; InputFileId < Lattices.size(); InputFileId++) {
+    LocalLattice &Lattice = Lattices[InputFileId];
+    for (const std::string &Symbol : Lattice.Symbols.GetIntToStringVector()) {
+      SymbolMaps[InputFileId].push_back(GlobalStringToInt.Insert(Symbol));
     }
+    ArcInfoOffsets[InputFileId] = InputArcInfos.size();
+    for (const ArcInfo &Info : Lattice.ArcInfos) {
+      InputArcInfos.push_back(ArcInfo(SymbolMaps[InputFileId][Info.label],
+                                      Info.start, Info.end));
+    }
+  }
 
-    std::istringstream iss(line);
-    string nodeStr;
-    iss >> nodeStr;
-    pos = nodeStr.find("=");
-    std::size_t nodes = std::stoull(nodeStr.substr(pos + 1));
-    string linksStr;
-    iss >> linksStr;
-    pos = linksStr.find("=");
-    int linksLeft = std::stoi(linksStr.substr(pos + 1));
-
-    // prepare the fst -> it gets a unique start and end state
-    LogVectorFst latticeFst;
-    latticeFst.AddState();
-    latticeFst.SetStart(0);
+  // relabel and preprocess the lattices in parallel
+  ParallelForEach(Lattices.size(), [&](std::size_t InputFileId) {
+    PreprocessHTKLattice(Params, SymbolMaps[InputFileId],
+                         ArcInfoOffsets[InputFileId], &Lattices[InputFileId]);
+  });
 
-    // create the nodes
-    latticeFst.ReserveStates(nodes);
-    for (std::size_t s = 1; s < nodes; s++) {
-      latticeFst.AddState();
-    }
-    // latticeFst.SetFinal(nodes - 1, 0);
+  for (std::size_t InputFileId = 0; InputFileId < Lattices.size(); InputFileId++) {
+    std::cout << Lattices[InputFileId].Log.str();
+    InputFsts.push_back(std::move(Lattices[InputFileId].Fst));
+    InputFileNames.push_back(
+      boost::filesystem::path(
+        Params.InputFiles.at(InputFileId)).filename().string());
+  }
+}
 
-    // read node times
-    std::vector<float> NodeTimes;
-    if (Params.ReadNodeTimes) {
 
-      // read nodes
-      NodeTimes.resize(nodes, -1);
-      for (std::size_t NodeId = 0; NodeId < nodes; NodeId++) {
-        // find next node entry
-        std::getline(in, line);
-        while (in.good() && line.substr(0, 1) != "I") {
-          std::getline(in, line);
-        }
-        std::istringstream iss(line);
-        string nodeStr;
-        iss >> nodeStr; // discard node number
-        iss >> nodeStr;
-        pos = nodeStr.find("=");
-        NodeTimes[NodeId] = std::stof(nodeStr.substr(pos + 1));
-        if (debug_) {
-          std::cout << "Reading Node " << NodeId << " at time "
-                    << NodeTimes[NodeId] << std::endl;
-        }
-      }
-      InputArcInfos.push_back(ArcInfo(EPS_SYMBOLID, -1, -1));
+void FileReader::PruneLattice(
+  const ParameterStruct &Params,
+  LocalLattice *Lattice
+)
+{
+  if (Params.PruneFactor != std::numeric_limits<double>::infinity()) {
+    LogToStdMapFst InStdArcFst(Lattice->Fst, fst::LogToStdMapper());
+    StdVectorFst OutStdArcFst;
+    fst::Prune(InStdArcFst, &OutStdArcFst, Params.PruneFactor);
+    fst::ArcMap(OutStdArcFst, &Lattice->Fst, fst::StdToLogMapper());
+    fst::ArcSort(&Lattice->Fst, fst::OLabelCompare<fst::LogArc>());
+    int arcCnt = 0;
+    for (LogStateIterator StateIter(Lattice->Fst);
+         !StateIter.Done(); StateIter.Next()) {
+      arcCnt += Lattice->Fst.NumArcs(StateIter.Value());
     }
+    Lattice->Log << " (" << Lattice->Fst.NumStates()
+                 << " States | " << arcCnt << " Arcs after pruning)";
+  }
+}
 
-    //  read segment list
-    bool ReadSegList = false;
-    if (ReadSegList) {
-      ReadSegmentList(InputFileId, line, debug_);
+void FileReader::PreprocessHTKLattice(
+  const ParameterStruct &Params,
+  const std::vector<int> &SymbolMap,
+  std::size_t ArcInfoOffset,
+  LocalLattice *Lattice
+)
+{
+  std::ostringstream &Log = Lattice->Log;
+  int debug_ = 0;
+  for (LogStateIterator siter(Lattice->Fst); !siter.Done(); siter.Next()) {
+    for (fst::MutableArcIterator<LogVectorFst> aiter(&Lattice->Fst, siter.Value());
+         !aiter.Done(); aiter.Next()) {
+      fst::LogArc arc = aiter.Value();
+      arc.olabel = SymbolMap[arc.olabel];
+      if (!Params.ReadNodeTimes) {
+        arc.ilabel = SymbolMap[arc.ilabel];
+      } else if (arc.ilabel != EPS_SYMBOLID) {
+        arc.ilabel += ArcInfoOffset;
+      }
+      aiter.SetValue(arc);
     }
+  }
 
-    //read the path
-    std::vector<bool> IsFinal(nodes, true);
+  // rmepsilon
+  if (debug_ > 2) {
+    Log << "RmEpsilon";
+  }
+  fst::RmEpsilon(&Lattice->Fst);
 
-    while (std::getline(in, line)) {
-      if (line.substr(0, 1) == "J") {       //only evaluate the links
-        //Format example: J=5 S=0 E=5 W="zh"  v=0 a=-273.284  l=-3.80666
-        // J: link no; S: start node; E: end node; W: phone;
-        // v: ???; a: acoustic model score; l: lm score
+  // topsort
+  if (debug_ > 2) {
+    Log << " | TopSort";
+  }
+  fst::TopSort(&Lattice->Fst);
 
-        //variables
-        CharId ilab;
-        CharId olab;
-        fst::LogArc arc;
-        string cur;
-        string phone;
-        std::istringstream iss(line);
+  // arcsort
+  if (debug_ > 2) {
+    Log << " | ArcSort";
+  }
+  fst::ArcSort(&Lattice->Fst, fst::OLabelCompare<fst::LogArc>());
 
-        //discard link number
-        iss >> cur;
+  // print number of states
+  if (debug_ > 2) {
+    Log << std::endl;
+  }
+  int arcCnt = 0;
+  for (LogStateIterator siter(Lattice->Fst); !siter.Done(); siter.Next()) {
+    arcCnt += Lattice->Fst.NumArcs(siter.Value());
+  }
+  Log << Lattice->Fst.NumStates() << " States | " << arcCnt << " Arcs";
 
-        //start
-        int start;
-        if (!(iss >> cur)) {
-          break;
-        }
-        pos = cur.find("=");
-        start = std::stoi(cur.substr(pos + 1));
-        IsFinal.at(start) = false;
-
-        //end
-        int end;
-        if (!(iss >> cur)) {
-          break;
-        }
-        pos = cur.find("=");
-        end = std::stoi(cur.substr(pos + 1));
+  //Pruning
+  PruneLattice(Params, Lattice);
+  Log << std::endl;
 
-        // phone
-        if (!(iss >> cur)) {
-          break;
-        }
-        pos = cur.find("=");
-        int off = 0; //RASR quotes the phones. We only want the phone
-        if (cur.substr(pos + 1, 1) == "\"") {
-          off = 1;
-        }
-        phone = cur.substr(pos + 1 + off, cur.length() - pos - 1 - (2 * off));
+  if (Lattice->Fst.NumStates() == 0) {
+    Log << "Error: no states for utterance " << Lattice->Utterance << std::endl;
+    std::runtime_error("Exiting");
+  }
+}
 
-        //discard v
-        iss >> cur;
-        if (cur.substr(0, 2) == "v=") {
-          iss >> cur;
-        }
 
-        //acoustic model score
-        float amScore;
-        pos = cur.find("=");
-        amScore = -(std::stof(cur.substr(pos + 1)) + Params.AMScoreShift);
-
-        //lm score
-        iss >> cur;
-        float lmScore;
-        pos = cur.find("=");
-        lmScore = -std::stof(cur.substr(pos + 1));
-        amScore = amScore / log(10);
-        amScore += lmscale * lmScore / log(10);
-
-        //replace silence with eps
-        if (IsSilence(phone)) {
-          olab = EPS_SYMBOLID;
-          ilab = EPS_SYMBOLID;
-        } else {
-          olab = GlobalStringToInt.Insert(phone);
-          if (Params.ReadNodeTimes) {
-            InputArcInfos.push_back(
-              ArcInfo(olab, NodeTimes[start], NodeTimes[end]));
-            ilab = InputArcInfos.size() - 1;
-          } else {
-            ilab = olab;
-          }
-        }
+void FileReader::ReadHTKLattice(
+  const std::string &FileName,
+  std::size_t InputFileId,
+  LocalLattice *Lattice
+)
+{
+  // parse the file
+  HTKLattice Parsed;
+  HTKLatticeParser::Parse(FileName, Params.ReadNodeTimes, &Parsed);
+
+  //  read segment list
+  bool ReadSegList = false;
+  if (ReadSegList) {
+    ReadSegmentList(InputFileId, std::string(), 0);
+  }
 
-        //Add arc
-        fst::MutableArcIterator< LogVectorFst > ArcIter(&latticeFst, start);
-        while (!ArcIter.Done() && !(ArcIter.Value().olabel == olab &&
-                                    ArcIter.Value().nextstate == end)) {
-          ArcIter.Next();
-        }
-        if (!ArcIter.Done()) {
-          fst::LogArc arc = ArcIter.Value();
-          if (debug_ > 2) {
-            std::cout << "Found arc: Old: " << start << "->" << arc.nextstate
-                      << "[" << arc.weight.Value() << "] new: " << start
-                      << "->" << end << "[" << amScore << "]" << std::endl;
-          }
-          arc.weight = fst::Plus(arc.weight, fst::LogWeight(amScore));
-          ArcIter.SetValue(arc);
-          if (debug_ > 2) {
-            std::cout << "Modified phone: " << phone << "[" << olab << "]"
-                      << " start: " << start << " end: " << end
-                      << " score: " << arc.weight.Value() << " | "
-                      << linksLeft << " left" << std::endl;
-          }
-        } else {
-          latticeFst.AddArc(start, fst::LogArc(ilab, olab, amScore, end));
-          if (debug_ > 2) {
-            std::cout << "Added: phone: " << phone << "[" << olab << "]"
-                      << " start: " << start << " end: " << end
-                      << " score: " << amScore << " | "
-                      << linksLeft << " left" << std::endl;
-          }
-        }
-        linksLeft--;
-      } //end if
-    } //end read line
-
-    // set final nodes
-    if (!IsFinal.at(nodes - 1)){
-      std::cout << "Warning: The last node is not a final node!"
-                << std::endl;
-    }
-
-    for(std::size_t NodeId = 0; NodeId < nodes; NodeId++) {
-      if (IsFinal.at(NodeId)) {
-        latticeFst.SetFinal(NodeId, 0);
-        if (NodeId != nodes - 1) {
-          std::cout << "Warning: Final node " << NodeId
-                    << " is not the last node!" << std::endl;
-        }
+  ConvertHTKLattice(Params, Parsed, Lattice);
+}
+
+
+void FileReader::ConvertHTKLattice(
+  const ParameterStruct &Params,
+  const HTKLattice &Parsed,
+  LocalLattice *Lattice
+)
+{
+  std::ostringstream &Log = Lattice->Log;
+  Lattice->Symbols.Insert(EPS_SYMBOL);
+
+  // some variables
+  float lmscale = Params.HTKLMScale;
+  int debug_ = 0;
+
+  Lattice->Utterance = Parsed.Utterance;
+  if (debug_) {
+    Log << "Reading utterance: " << Parsed.Utterance << std::endl;
+  }
+  std::size_t nodes = Parsed.NumNodes;
+  int linksLeft = Parsed.NumLinks;
+
+  // prepare the fst -> it gets a unique start and end state
+  LogVectorFst &latticeFst = Lattice->Fst;
+  latticeFst.AddState();
+  latticeFst.SetStart(0);
+
+  // create the nodes
+  latticeFst.ReserveStates(nodes);
+  for (std::size_t s = 1; s < nodes; s++) {
+    latticeFst.AddState();
+  }
+  // latticeFst.SetFinal(nodes - 1, 0);
+
+  // node times
+  const std::vector<float> &NodeTimes = Parsed.NodeTimes;
+  if (Params.ReadNodeTimes) {
+    if (debug_) {
+      for (std::size_t NodeId = 0; NodeId < nodes; NodeId++) {
+        Log << "Reading Node " << NodeId << " at time "
+            << NodeTimes[NodeId] << std::endl;
       }
     }
+    Lattice->ArcInfos.push_back(ArcInfo(EPS_SYMBOLID, -1, -1));
+  }
+
+  // map the distinct phones to symbols, silence is replaced by eps
+  std::vector<CharId> PhoneSymbols(Parsed.Phones.size());
+  for (std::size_t PhoneId = 0; PhoneId < Parsed.Phones.size(); PhoneId++) {
+    PhoneSymbols[PhoneId] = IsSilence(Parsed.Phones[PhoneId]) ?
+      EPS_SYMBOLID : Lattice->Symbols.Insert(Parsed.Phones[PhoneId]);
+  }
 
-    // rmepsilon
-    if (debug_ > 2) {
-      std::cout << "RmEpsilon";
+  //read the path
+  std::vector<bool> IsFinal(nodes, true);
+
+  for (const HTKLink &Link : Parsed.Links) {
+    int start = Link.Start;
+    int end = Link.End;
+    IsFinal.at(start) = false;
+    const std::string &phone = Parsed.Phones[Link.PhoneId];
+
+    //acoustic model score
+    float amScore = -(Link.AmScore + Params.AMScoreShift);
+
+    //lm score
+    float lmScore = -Link.LmScore;
+    amScore = amScore / log(10);
+    amScore += lmscale * lmScore / log(10);
+
+    CharId olab = PhoneSymbols[Link.PhoneId];
+    CharId ilab = olab;
+    if (Params.ReadNodeTimes && (olab != EPS_SYMBOLID)) {
+      Lattice->ArcInfos.push_back(
+        ArcInfo(olab, NodeTimes[start], NodeTimes[end]));
+      ilab = Lattice->ArcInfos.size() - 1;
     }
-    fst::RmEpsilon(&latticeFst);
 
-    // topsort
-    if (debug_ > 2) {
-      std::cout << " | TopSort";
+    //Add arc
+    fst::MutableArcIterator< LogVectorFst > ArcIter(&latticeFst, start);
+    while (!ArcIter.Done() && !(ArcIter.Value().olabel == olab &&
+                                ArcIter.Value().nextstate == end)) {
+      ArcIter.Next();
+    }
+    if (!ArcIter.Done()) {
+      fst::LogArc arc = ArcIter.Value();
+      if (debug_ > 2) {
+        Log << "Found arc: Old: " << start << "->" << arc.nextstate
+            << "[" << arc.weight.Value() << "] new: " << start
+            << "->" << end << "[" << amScore << "]" << std::endl;
+      }
+      arc.weight = fst::Plus(arc.weight, fst::LogWeight(amScore));
+      ArcIter.SetValue(arc);
+      if (debug_ > 2) {
+        Log << "Modified phone: " << phone << "[" << olab << "]"
+            << " start: " << start << " end: " << end
+            << " score: " << arc.weight.Value() << " | "
+            << linksLeft << " left" << std::endl;
+      }
+    } else {
+      latticeFst.AddArc(start, fst::LogArc(ilab, olab, amScore, end));
+      if (debug_ > 2) {
+        Log << "Added: phone: " << phone << "[" << olab << "]"
+            << " start: " << start << " end: " << end
+            << " score: " << amScore << " | "
+            << linksLeft << " left" << std::endl;
+      }
     }
-    fst::TopSort(&latticeFst);
+    linksLeft--;
+  }
+
+  // set final nodes
+  if (!IsFinal.at(nodes - 1)){
+    Log << "Warning: The last node is not a final node!"
+        << std::endl;
+  }
 
-    // arcsort
-    if (debug_ > 2) {
-      std::cout << " | ArcSort";
+  for(std::size_t NodeId = 0; NodeId < nodes; NodeId++) {
+    if (IsFinal.at(NodeId)) {
+      latticeFst.SetFinal(NodeId, 0);
+      if (NodeId != nodes - 1) {
+        Log << "Warning: Final node " << NodeId
+            << " is not the last node!" << std::endl;
+      }
     }
-    fst::ArcSort(&latticeFst, fst::OLabelCompare<fst::LogArc>());
+  }
+
+}
 
-    // print number of states
-    if (debug_ > 2) {
-      std::cout << std::endl;
+
+void FileReader::ReadLatticeFromMemory(
+  const ParameterStruct &Params,
+  bool IsHTKLattice,
+  const std::string &Contents,
+  const StringToIntMapper &Symbols,
+  LogVectorFst *LatticeFst,
+  std::vector<ArcInfo> *ArcInfos
+)
+{
+  LocalLattice Lattice;
+  ArcInfos->clear();
+  if (IsHTKLattice) {
+    HTKLattice Parsed;
+    HTKLatticeParser::Parse(Contents.data(), Contents.data() + Contents.size(),
+                            Params.ReadNodeTimes, &Parsed);
+    ConvertHTKLattice(Params, Parsed, &Lattice);
+
+    // the symbols are fixed by the language model
+    std::vector<int> SymbolMap;
+    for (const std::string &Symbol : Lattice.Symbols.GetIntToStringVector()) {
+      int SymbolId = Symbols.GetInt(Symbol);
+      if (SymbolId == StringToIntMapper::NOT_FOUND) {
+        throw std::runtime_error("Unknown phone '" + Symbol + "'");
+      }
+      SymbolMap.push_back(SymbolId);
     }
-    int arcCnt = 0;
-    for (LogStateIterator siter(latticeFst); !siter.Done(); siter.Next()) {
-      arcCnt += latticeFst.NumArcs(siter.Value());
+    for (const ArcInfo &Info : Lattice.ArcInfos) {
+      ArcInfos->push_back(ArcInfo(SymbolMap[Info.label], Info.start, Info.end));
     }
-    std::cout << latticeFst.NumStates() << " States | " << arcCnt << " Arcs";
-
-    //Pruning
-    if (Params.PruneFactor != std::numeric_limits<double>::infinity()) {
-      LogToStdMapFst InStdArcFst(latticeFst, fst::LogToStdMapper());
-      StdVectorFst OutStdArcFst;
-      fst::Prune(InStdArcFst, &OutStdArcFst, Params.PruneFactor);
-      fst::ArcMap(OutStdArcFst, &latticeFst, fst::StdToLogMapper());
-      fst::ArcSort(&latticeFst, fst::OLabelCompare<fst::LogArc>());
-      arcCnt = 0;
-      for (LogStateIterator StateIter(latticeFst);
-           !StateIter.Done(); StateIter.Next()) {
-        arcCnt += latticeFst.NumArcs(StateIter.Value());
+    PreprocessHTKLattice(Params, SymbolMap, 0, &Lattice);
+  } else {
+    std::istringstream Stream(Contents);
+    std::unique_ptr<LogVectorFst> ReadFst(
+      LogVectorFst::Read(Stream, fst::FstReadOptions("<memory>")));
+    if (!ReadFst) {
+      throw std::runtime_error("Invalid OpenFst lattice");
+    }
+    Lattice.Fst = *ReadFst;
+    const int NumStates = Lattice.Fst.NumStates();
+    for (LogStateIterator StateIter(Lattice.Fst);
+         !StateIter.Done(); StateIter.Next()) {
+      for (fst::ArcIterator<LogVectorFst> ArcIter(Lattice.Fst, StateIter.Value());
+           !ArcIter.Done(); ArcIter.Next()) {
+        const fst::LogArc &Arc = ArcIter.Value();
+        if ((Arc.olabel < 0) || (Arc.olabel >= Symbols.GetSize())) {
+          throw std::runtime_error("Lattice label " +
+                                   std::to_string(Arc.olabel) +
+                                   " is not in the symbol table");
+        }
+        if ((Arc.nextstate < 0) || (Arc.nextstate >= NumStates)) {
+          throw std::runtime_error("Lattice arc to state " +
+                                   std::to_string(Arc.nextstate) +
+                                   " is out of range");
+        }
       }
-      std::cout << " (" << latticeFst.NumStates()
-                << " States | " << arcCnt << " Arcs after pruning)";
     }
-    std::cout << std::endl;
+    PruneLattice(Params, &Lattice);
+  }
+  if (Lattice.Fst.NumStates() == 0) {
+    throw std::runtime_error("Lattice has no states");
+  }
 
-    if (latticeFst.NumStates() == 0) {
-      std::cout << "Error: no states for utterance " << utterance << std::endl;
-      std::runtime_error("Exiting");
-    }
-    InputFsts.push_back(latticeFst);
-    InputFileNames.push_back(
-      boost::filesystem::path(
-        Params.InputFiles.at(InputFileId)).filename().string());
+  // same preprocessing as for the input lattices
+  if (Params.AmScale != 1) {
+    fst::WeightedMapper AcousticModelScalingFactorMapper(Params.AmScale);
+    fst::Map(&Lattice.Fst, AcousticModelScalingFactorMapper);
   }
+  Lattice.Fst = LogComposeFst(Lattice.Fst,
+                              GetWordEndTransducer(Symbols.GetSize()));
+  *LatticeFst = LogComposeFst(Lattice.Fst,
+                              GetSentEndTransducer(Symbols.GetSize()));
+  fst::Connect(LatticeFst);
 }
 
+
 void FileReader::ReadSegmentList(std::size_t InputFileId,
                                  std::string line, int debug_){
   std::size_t NumSegments;
@@ -549,43 +683,37 @@ void FileReader::ReadSegmentList(std::size_t InputFileId,
 }
 void FileReader::ReadOpenFSTLattices()
 {
-  for (std::size_t i = 0; i < Params.InputFiles.size(); i++) {
-    std::cout << "Reading lattice file [" << i << "/"
-              << Params.InputFiles.size() << "] from OpenFst FST "
-              << Params.InputFiles.at(i) << std::endl;
-    LogVectorFst LogArcVectorFst(*LogVectorFst::Read(Params.InputFiles.at(i)));
+  std::vector<LocalLattice> Lattices(Params.InputFiles.size());
+  ParallelForEach(Lattices.size(), [&](std::size_t i) {
+    std::ostringstream &Log = Lattices[i].Log;
+    Log << "Reading lattice file [" << i << "/"
+        << Params.InputFiles.size() << "] from OpenFst FST "
+        << Params.InputFiles.at(i) << std::endl;
+    std::unique_ptr<LogVectorFst> ReadFst(
+      LogVectorFst::Read(Params.InputFiles.at(i)));
+    LogVectorFst &LogArcVectorFst = Lattices[i].Fst;
+    LogArcVectorFst = *ReadFst;
     int arcCnt = 0;
     for (LogStateIterator StateIter(LogArcVectorFst);
          !StateIter.Done(); StateIter.Next()) {
       arcCnt += LogArcVectorFst.NumArcs(StateIter.Value());
     }
-    std::cout << LogArcVectorFst.NumStates()
-              << " States | " << arcCnt << " Arcs";
+    Log << LogArcVectorFst.NumStates()
+        << " States | " << arcCnt << " Arcs";
 
     //Pruning
-    if (Params.PruneFactor != std::numeric_limits<double>::infinity()) {
-      LogToStdMapFst InStdArcFst(LogArcVectorFst, fst::LogToStdMapper());
-      StdVectorFst OutStdArcFst;
-      fst::Prune(InStdArcFst, &OutStdArcFst, Params.PruneFactor);
-      fst::ArcMap(OutStdArcFst, &LogArcVectorFst, fst::StdToLogMapper());
-      fst::ArcSort(&LogArcVectorFst, fst::OLabelCompare<fst::LogArc>());
-      arcCnt = 0;
-      for (LogStateIterator StateIter(LogArcVectorFst);
-           !StateIter.Done(); StateIter.Next()) {
-        arcCnt += LogArcVectorFst.NumArcs(StateIter.Value());
-      }
-      std::cout << " (" << LogArcVectorFst.NumStates()
-                << " States | " << arcCnt << " Arcs after pruning)";
-    }
-    std::cout << std::endl;
+    PruneLattice(Params, &Lattices[i]);
+    Log << std::endl;
 
     if (LogArcVectorFst.NumStates() == 0) {
-      std::cout << "Error: no states for utterance " << i << std::endl;
+      Log << "Error: no states for utterance " << i << std::endl;
       std::runtime_error("Exiting");
     }
+  });
 
-    InputFsts.push_back(LogArcVectorFst);
-
+  for (std::size_t i = 0; i < Lattices.size(); i++) {
+    std::cout << Lattices[i].Log.str();
+    InputFsts.push_back(std::move(Lattices[i].Fst));
     InputFileNames.push_back(
       boost::filesystem::path(Params.InputFiles.at(i)).filename().string());
   }
@@ -731,7 +859,8 @@ StateId FileReader::AddPhoneToFst(LogVectorFst& LatticeFst, StateId State,
 void FileReader::PruneLattices(double PruningFactor)
 {
   if (PruningFactor != std::numeric_limits<double>::infinity()) {
-    for (auto& currentInputFst: InputFsts) {
+    ParallelForEach(InputFsts.size(), [&](std::size_t InputFstIdx) {
+      LogVectorFst &currentInputFst = InputFsts[InputFstIdx];
       LogToStdMapFst InStdArcFst(currentInputFst, fst::LogToStdMapper());
       StdVectorFst OutStdArcFst;
       fst::Prune(InStdArcFst, &OutStdArcFst, PruningFactor);
@@ -746,7 +875,7 @@ void FileReader::PruneLattices(double PruningFactor)
 //       std::cout << " (" << InputFsts.at(InputFstIdx).NumStates()
 //                 << " States | " << arcCnt << " Arcs after pruning)"
 //                 << std::endl;
-    }
+    });
   }
 }
 
@@ -783,15 +912,15 @@ void FileReader::WriteOpenFSTLattices() const
 void FileReader::ApplyAcousticModelScalingFactor()
 {
   fst::WeightedMapper AcousticModelScalingFactorMapper(Params.AmScale);
-  for (auto& currentInputFst: InputFsts) {
-    fst::Map(&currentInputFst, AcousticModelScalingFactorMapper);
+  ParallelForEach(InputFsts.size(), [&](std::size_t InputFstIdx) {
+    fst::Map(&InputFsts[InputFstIdx], AcousticModelScalingFactorMapper);
 //     std::cout << "Scaling FST: " << InputFstIdx << " with factor: "
 //               << Params.AmScale << std::endl;
-  }
+  });
 }
 
 
-LogVectorFst FileReader::GetWordEndTransducer()
+LogVectorFst FileReader::GetWordEndTransducer(std::size_t NumSymbols)
 {
   LogVectorFst WordEndTransducer;
   StateId UNKState = WordEndTransducer.AddState();
@@ -803,8 +932,7 @@ LogVectorFst FileReader::GetWordEndTransducer()
     fst::LogArc(EPS_SYMBOLID, UNKEND_SYMBOLID, 0, UNKState));
   WordEndTransducer.AddArc(CharacterState,
     fst::LogArc(UNKEND_SYMBOLID, UNKEND_SYMBOLID, 0, UNKState));
-  for (std::size_t k = SENTEND_SYMBOLID;
-       k < InputStringToInt.GetIntToStringVector().size(); k++) {
+  for (std::size_t k = SENTEND_SYMBOLID; k < NumSymbols; k++) {
 
     WordEndTransducer.AddArc(UNKState,
       fst::LogArc(k, k, 0, CharacterState));
@@ -819,14 +947,16 @@ LogVectorFst FileReader::GetWordEndTransducer()
 
 void FileReader::ApplyWordEndTransducer()
 {
-  LogVectorFst WordEndTransducer(GetWordEndTransducer());
+  LogVectorFst WordEndTransducer(
+    GetWordEndTransducer(InputStringToInt.GetSize()));
 
-  for (auto& currentInputFst: InputFsts) {
-    currentInputFst = LogComposeFst(currentInputFst, WordEndTransducer);
-  }
+  ParallelForEach(InputFsts.size(), [&](std::size_t InputFstIdx) {
+    InputFsts[InputFstIdx] =
+      LogComposeFst(InputFsts[InputFstIdx], WordEndTransducer);
+  });
 }
 
-void FileReader::ApplySentEndTransducer()
+LogVectorFst FileReader::GetSentEndTransducer(std::size_t NumSymbols)
 {
   LogVectorFst SentEndTransducer;
   StateId CharacterState = SentEndTransducer.AddState();
@@ -840,8 +970,7 @@ void FileReader::ApplySentEndTransducer()
   SentEndTransducer.AddArc(CharacterState,
     fst::LogArc(UNKEND_SYMBOLID, UNKEND_SYMBOLID, 0, CharacterState));
 
-  for (std::size_t k = CHARACTERSBEGIN;
-       k < InputStringToInt.GetIntToStringVector().size(); k++) {
+  for (std::size_t k = CHARACTERSBEGIN; k < NumSymbols; k++) {
 
     SentEndTransducer.AddArc(CharacterState,
       fst::LogArc(k, k, 0, CharacterState));
@@ -849,10 +978,19 @@ void FileReader::ApplySentEndTransducer()
   SentEndTransducer.AddArc(SentEndState,
     fst::LogArc(EPS_SYMBOLID, UNKEND_SYMBOLID, 0, FinalUNKState));
 
-  for (auto& currentInputFst: InputFsts) {
-    currentInputFst = LogComposeFst(currentInputFst, SentEndTransducer);
-    fst::Connect(&currentInputFst);
-  }
+  return SentEndTransducer;
+}
+
+void FileReader::ApplySentEndTransducer()
+{
+  LogVectorFst SentEndTransducer(
+    GetSentEndTransducer(InputStringToInt.GetSize()));
+
+  ParallelForEach(InputFsts.size(), [&](std::size_t InputFstIdx) {
+    InputFsts[InputFstIdx] =
+      LogComposeFst(InputFsts[InputFstIdx], SentEndTransducer);
+    fst::Connect(&InputFsts[InputFstIdx]);
+  });
 }
 
 void FileReader::CalculateLatticePhonemeErrorRate()
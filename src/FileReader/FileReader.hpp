@@ -60,10 +60,13 @@
 #ifndef _FILEREADER_HPP_
 #define _FILEREADER_HPP_
 
+#include <functional>
+#include <sstream>
 #include <fst/vector-fst.h>
 #include "StringToIntMapper.hpp"
 #include "../ParameterParser/ParameterParser.hpp"
 #include "FileData.hpp"
+#include "HTKLatticeParser.hpp"
 
 /* class to read input files */
 class FileReader {
@@ -93,9 +96,55 @@ class FileReader {
   static const bool PARSE_REFERENCES = true;
 
   PronDictType PronDict;
+
+  /* lattice read by a worker thread, labels refer to its own symbols */
+  struct LocalLattice {
+    LogVectorFst Fst;
+    StringToIntMapper Symbols;     // symbols in order of first occurence
+    std::vector<ArcInfo> ArcInfos; // arc infos, input labels point to these
+    std::string Utterance;         // name of the utterance
+    std::ostringstream Log;        // messages, printed in file order
+  };
+
+  /* internal functions: parallelization */
+  // call Fn for every index in [0, NumItems) using Params.NoThreads threads
+  void ParallelForEach(
+    std::size_t NumItems,
+    const std::function<void(std::size_t)> &Fn
+  ) const;
+
   /* internal functions: input */
   void ReadHTKLattices();
 
+  // parse a single HTK lattice with local symbols (thread safe)
+  void ReadHTKLattice(
+    const std::string &FileName,
+    std::size_t InputFileId,
+    LocalLattice *Lattice
+  );
+
+  // build the fst of a parsed HTK lattice with local symbols (thread safe)
+  static void ConvertHTKLattice(
+    const ParameterStruct &Params,
+    const HTKLattice &Parsed,
+    LocalLattice *Lattice
+  );
+
+  // map local symbols to global ones, input labels to arc infos starting at
+  // ArcInfoOffset, remove epsilons, sort and prune the lattice (thread safe)
+  static void PreprocessHTKLattice(
+    const ParameterStruct &Params,
+    const std::vector<int> &SymbolMap,
+    std::size_t ArcInfoOffset,
+    LocalLattice *Lattice
+  );
+
+  // prune lattice with Params.PruneFactor (thread safe)
+  static void PruneLattice(
+    const ParameterStruct &Params,
+    LocalLattice *Lattice
+  );
+
   void ReadSegmentList(
     std::size_t InputFileId,
     std::string line, int debug_
@@ -123,6 +172,9 @@ class FileReader {
 
   void ReadInputArcInfos();
 
+  // read preprocessed input lattices, symbols and arc infos from binary corpus
+  void ReadBinaryCorpus();
+
 
   /* Modifications */
   void PruneLattices(
@@ -142,7 +194,10 @@ class FileReader {
 
   void WriteInputArcInfos() const;
 
-  bool IsSilence(
+  // write preprocessed input lattices, symbols and arc infos to binary corpus
+  void WriteBinaryCorpus() const;
+
+  static bool IsSilence(
     std::string phone
   );
 
@@ -158,7 +213,15 @@ class FileReader {
     const std::string& phone
   );
   
-  LogVectorFst GetWordEndTransducer();
+  // transducer inserting the end of word symbol after characters
+  static LogVectorFst GetWordEndTransducer(
+    std::size_t NumSymbols
+  );
+
+  // transducer appending the end of sentence symbol
+  static LogVectorFst GetSentEndTransducer(
+    std::size_t NumSymbols
+  );
 
 public:
   /* constructor */
@@ -167,8 +230,22 @@ public:
     const ParameterStruct &Params
   );
 
-  // return class for input file handling
-  FileData GetInputFileData();
+  // return class for input file handling, the data is moved out of the
+  // reader, so this can only be called on a temporary
+  FileData GetInputFileData() &&;
+
+  // read a single lattice in HTK SLF or OpenFst binary format from memory and
+  // preprocess it like the input lattices, the symbols are fixed and unknown
+  // phones throw, input labels refer to the returned arc infos if node times
+  // are read (thread safe)
+  static void ReadLatticeFromMemory(
+    const ParameterStruct &Params,
+    bool IsHTKLattice,
+    const std::string &Contents,
+    const StringToIntMapper &Symbols,
+    LogVectorFst *LatticeFst,
+    std::vector<ArcInfo> *ArcInfos
+  );
 };
 
 #endif
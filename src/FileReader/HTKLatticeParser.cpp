@@ -0,0 +1,411 @@
+// ----------------------------------------------------------------------------
+/**
+   File: HTKLatticeParser.cpp
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+*/
+// ----------------------------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "HTKLatticeParser.hpp"
+
+namespace {
+
+/* part of the parsed buffer */
+struct Token {
+  const char *Begin;
+  const char *End;
+};
+
+/* hash and comparison for interning phones by their characters */
+struct TokenHash {
+  std::size_t operator()(const Token &Key) const {
+    // FNV-1a
+    std::size_t Hash = 14695981039346656037ULL;
+    for (const char *c = Key.Begin; c != Key.End; ++c) {
+      Hash = (Hash ^ static_cast<unsigned char>(*c)) * 1099511628211ULL;
+    }
+    return Hash;
+  }
+};
+
+struct TokenEqual {
+  bool operator()(const Token &Lhs, const Token &Rhs) const {
+    return ((Lhs.End - Lhs.Begin) == (Rhs.End - Rhs.Begin)) &&
+           (std::memcmp(Lhs.Begin, Rhs.Begin, Lhs.End - Lhs.Begin) == 0);
+  }
+};
+
+/* reads the buffer line by line and every line token by token */
+class SLFScanner {
+  const char *Pos;     // begin of next line
+  const char *End;     // end of buffer
+  const char *LinePos; // current position in current line
+  const char *LineBegin;
+  const char *LineEnd;
+
+public:
+  SLFScanner(const char *Begin, const char *End) :
+    Pos(Begin), End(End), LinePos(Begin), LineBegin(Begin), LineEnd(Begin) {}
+
+  // advance to next line, returns false at the end of the buffer
+  bool NextLine() {
+    if (Pos >= End) {
+      return false;
+    }
+    LineBegin = Pos;
+    LinePos = Pos;
+    const char *NewLine =
+      static_cast<const char *>(std::memchr(Pos, '\n', End - Pos));
+    LineEnd = NewLine ? NewLine : End;
+    Pos = NewLine ? NewLine + 1 : End;
+    return true;
+  }
+
+  // first character of current line, '\0' for empty lines
+  char LineStart() const {
+    return (LineBegin < LineEnd) ? *LineBegin : '\0';
+  }
+
+  // current line without the line break
+  Token Line() const {
+    return Token{LineBegin, (LineEnd > LineBegin && LineEnd[-1] == '\r') ?
+                 LineEnd - 1 : LineEnd};
+  }
+
+  // next whitespace separated token of current line
+  bool NextToken(Token *Next) {
+    while (LinePos < LineEnd &&
+           (*LinePos == ' ' || *LinePos == '\t' || *LinePos == '\r')) {
+      ++LinePos;
+    }
+    if (LinePos == LineEnd) {
+      return false;
+    }
+    Next->Begin = LinePos;
+    while (LinePos < LineEnd &&
+           !(*LinePos == ' ' || *LinePos == '\t' || *LinePos == '\r')) {
+      ++LinePos;
+    }
+    Next->End = LinePos;
+    return true;
+  }
+};
+
+// part of token after the first '=', the whole token if there is none
+Token Value(const Token &Field)
+{
+  const char *Separator =
+    static_cast<const char *>(std::memchr(Field.Begin, '=', Field.End - Field.Begin));
+  return Token{Separator ? Separator + 1 : Field.Begin, Field.End};
+}
+
+/* file mapped into memory, unmapped when going out of scope */
+struct MappedFile {
+  void *Mapping = MAP_FAILED;
+  std::size_t Size = 0;
+
+  ~MappedFile() {
+    if (Mapping != MAP_FAILED) {
+      munmap(Mapping, Size);
+    }
+  }
+};
+
+} // namespace
+
+
+float HTKLatticeParser::ParseFloat(const char *Begin, const char *End)
+{
+  static const double PowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+
+  const char *c = Begin;
+  bool Negative = false;
+  if ((c < End) && ((*c == '-') || (*c == '+'))) {
+    Negative = (*c == '-');
+    ++c;
+  }
+
+  // up to 19 significant digits fit into the mantissa
+  uint64_t Mantissa = 0;
+  int NumSignificantDigits = 0;
+  int Exponent = 0;
+  bool HasDigits = false;
+  for (; (c < End) && (*c >= '0') && (*c <= '9'); ++c) {
+    HasDigits = true;
+    if (NumSignificantDigits < 19) {
+      Mantissa = Mantissa * 10 + (*c - '0');
+      NumSignificantDigits += (Mantissa != 0);
+    } else {
+      ++Exponent;
+    }
+  }
+  if ((c < End) && (*c == '.')) {
+    for (++c; (c < End) && (*c >= '0') && (*c <= '9'); ++c) {
+      HasDigits = true;
+      if (NumSignificantDigits < 19) {
+        Mantissa = Mantissa * 10 + (*c - '0');
+        NumSignificantDigits += (Mantissa != 0);
+        --Exponent;
+      }
+    }
+  }
+  if (HasDigits && (c < End) && ((*c == 'e') || (*c == 'E'))) {
+    ++c;
+    bool NegativeExponent = false;
+    if ((c < End) && ((*c == '-') || (*c == '+'))) {
+      NegativeExponent = (*c == '-');
+      ++c;
+    }
+    int ExplicitExponent = 0;
+    for (; (c < End) && (*c >= '0') && (*c <= '9'); ++c) {
+      ExplicitExponent = std::min(ExplicitExponent * 10 + (*c - '0'), 100000);
+    }
+    Exponent += NegativeExponent ? -ExplicitExponent : ExplicitExponent;
+  }
+
+  // anything unusual (inf, nan, hex, trailing characters) goes the slow way
+  if (!HasDigits || (c != End)) {
+    return std::stof(std::string(Begin, End));
+  }
+
+  double Result = static_cast<double>(Mantissa);
+  if ((Exponent >= 0) && (Exponent <= 22)) {
+    Result *= PowersOfTen[Exponent];
+  } else if ((Exponent < 0) && (Exponent >= -22)) {
+    Result /= PowersOfTen[-Exponent];
+  } else {
+    Result *= std::pow(10.0, Exponent);
+  }
+  return static_cast<float>(Negative ? -Result : Result);
+}
+
+
+long HTKLatticeParser::ParseInt(const char *Begin, const char *End)
+{
+  long Result = 0;
+  const char *c = Begin;
+  for (; (c < End) && (*c >= '0') && (*c <= '9'); ++c) {
+    Result = Result * 10 + (*c - '0');
+    if (Result > std::numeric_limits<int>::max()) {
+      throw std::runtime_error("Number \"" + std::string(Begin, End) +
+                               "\" is too large in HTK lattice");
+    }
+  }
+  if (c == Begin) {
+    throw std::runtime_error("Expected number but got \"" +
+                             std::string(Begin, End) + "\" in HTK lattice");
+  }
+  return Result;
+}
+
+
+void HTKLatticeParser::Parse(
+  const std::string &FileName,
+  bool ReadNodeTimes,
+  HTKLattice *Lattice
+)
+{
+  // map the whole file read only
+  MappedFile File;
+  int FileDescriptor = open(FileName.c_str(), O_RDONLY);
+  struct stat FileStatus;
+  if ((FileDescriptor < 0) || (fstat(FileDescriptor, &FileStatus) != 0)) {
+    if (FileDescriptor >= 0) {
+      close(FileDescriptor);
+    }
+    std::ostringstream err;
+    err << "Could not open HTK lattice " << FileName << std::endl;
+    throw std::runtime_error(err.str());
+  }
+  File.Size = FileStatus.st_size;
+  if (File.Size > 0) {
+    File.Mapping =
+      mmap(nullptr, File.Size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+  }
+  close(FileDescriptor);
+  if (File.Mapping == MAP_FAILED) {
+    std::ostringstream err;
+    err << "Could not map HTK lattice " << FileName << std::endl;
+    throw std::runtime_error(err.str());
+  }
+  madvise(File.Mapping, File.Size, MADV_SEQUENTIAL);
+
+  const char *Data = static_cast<const char *>(File.Mapping);
+  try {
+    Parse(Data, Data + File.Size, ReadNodeTimes, Lattice);
+  } catch (const std::exception &e) {
+    std::ostringstream err;
+    err << "Error parsing HTK lattice " << FileName << ": " << e.what()
+        << std::endl;
+    throw std::runtime_error(err.str());
+  }
+}
+
+
+void HTKLatticeParser::Parse(
+  const char *Begin,
+  const char *End,
+  bool ReadNodeTimes,
+  HTKLattice *Lattice
+)
+{
+  SLFScanner Scanner(Begin, End);
+  Token Field;
+
+  // first line: version, second line: utterance
+  Scanner.NextLine();
+  if (!Scanner.NextLine()) {
+    throw std::runtime_error("missing utterance line");
+  }
+  Token Utterance = Value(Scanner.Line());
+  Lattice->Utterance.assign(Utterance.Begin, Utterance.End);
+
+  // size line: N=<nodes> L=<links>
+  while ((Scanner.LineStart() != 'N') && Scanner.NextLine()) {}
+  if ((Scanner.LineStart() != 'N') || !Scanner.NextToken(&Field)) {
+    throw std::runtime_error("missing N= line");
+  }
+  Token Number = Value(Field);
+  Lattice->NumNodes = ParseInt(Number.Begin, Number.End);
+  if (Lattice->NumNodes == 0) {
+    throw std::runtime_error("lattice has no nodes");
+  }
+  if (!Scanner.NextToken(&Field)) {
+    throw std::runtime_error("missing L= field");
+  }
+  Number = Value(Field);
+  Lattice->NumLinks = ParseInt(Number.Begin, Number.End);
+
+  // node lines: I=<node> t=<time>
+  Lattice->NodeTimes.clear();
+  if (ReadNodeTimes) {
+    Lattice->NodeTimes.resize(Lattice->NumNodes, -1);
+    for (std::size_t NodeId = 0; NodeId < Lattice->NumNodes; NodeId++) {
+      bool HasLine = Scanner.NextLine();
+      while (HasLine && (Scanner.LineStart() != 'I')) {
+        HasLine = Scanner.NextLine();
+      }
+      if (!HasLine || !Scanner.NextToken(&Field) ||
+          !Scanner.NextToken(&Field)) {
+        throw std::runtime_error("missing I= line");
+      }
+      Number = Value(Field);
+      Lattice->NodeTimes[NodeId] = ParseFloat(Number.Begin, Number.End);
+    }
+  }
+
+  // link lines: J=<link> S=<start> E=<end> W=<phone> [v=<var>] a=<am> l=<lm>
+  std::unordered_map<Token, int, TokenHash, TokenEqual> PhoneIds;
+  Lattice->Phones.clear();
+  Lattice->Links.clear();
+  // the header is not trusted, every link line takes at least 8 characters
+  Lattice->Links.reserve(
+    std::min<std::size_t>(Lattice->NumLinks, (End - Begin) / 8));
+  while (Scanner.NextLine()) {
+    if (Scanner.LineStart() != 'J') {
+      continue;
+    }
+    HTKLink Link;
+    Scanner.NextToken(&Field); // link number
+
+    // incomplete link lines end the link section
+    if (!Scanner.NextToken(&Field)) {
+      break;
+    }
+    Number = Value(Field);
+    Link.Start = ParseInt(Number.Begin, Number.End);
+    if (!Scanner.NextToken(&Field)) {
+      break;
+    }
+    Number = Value(Field);
+    Link.End = ParseInt(Number.Begin, Number.End);
+    if ((static_cast<std::size_t>(Link.Start) >= Lattice->NumNodes) ||
+        (static_cast<std::size_t>(Link.End) >= Lattice->NumNodes)) {
+      throw std::runtime_error("link " + std::to_string(Link.Start) + "->" +
+                               std::to_string(Link.End) +
+                               " refers to a node out of range");
+    }
+    if (!Scanner.NextToken(&Field)) {
+      break;
+    }
+
+    // RASR quotes the phones, we only want the phone
+    Token Phone = Value(Field);
+    if ((Phone.Begin < Phone.End) && (*Phone.Begin == '"')) {
+      ++Phone.Begin;
+      if (Phone.End > Phone.Begin) {
+        --Phone.End;
+      }
+    }
+    auto PhoneId = PhoneIds.find(Phone);
+    if (PhoneId == PhoneIds.end()) {
+      PhoneId = PhoneIds.emplace(Phone, Lattice->Phones.size()).first;
+      Lattice->Phones.emplace_back(Phone.Begin, Phone.End);
+    }
+    Link.PhoneId = PhoneId->second;
+
+    // scores, a missing field repeats the previous one like the stream reader
+    Scanner.NextToken(&Field);
+    if ((Field.End - Field.Begin >= 2) && (Field.Begin[0] == 'v') &&
+        (Field.Begin[1] == '=')) {
+      Scanner.NextToken(&Field);
+    }
+    Number = Value(Field);
+    Link.AmScore = ParseFloat(Number.Begin, Number.End);
+    Scanner.NextToken(&Field);
+    Number = Value(Field);
+    Link.LmScore = ParseFloat(Number.Begin, Number.End);
+
+    Lattice->Links.push_back(Link);
+  }
+}
@@ -0,0 +1,127 @@
+// ----------------------------------------------------------------------------
+/**
+   File: HTKLatticeParser.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+
+   E-Mail: agent@local
+
+   Description: fast parser for lattices in HTK standard lattice format (SLF)
+
+   Limitations: only the fields used by the segmentation are parsed
+
+   Change History:
+   Date         Author       Description
+   2026-10-19   agent        Initial
+*/
+// ----------------------------------------------------------------------------
+#ifndef _HTKLATTICEPARSER_HPP_
+#define _HTKLATTICEPARSER_HPP_
+
+#include <string>
+#include <vector>
+
+/* link of a HTK lattice, phones are indices into HTKLattice::Phones */
+struct HTKLink {
+  int Start;     // start node
+  int End;       // end node
+  int PhoneId;   // index of the phone in HTKLattice::Phones
+  float AmScore; // acoustic model score (a=)
+  float LmScore; // language model score (l=)
+};
+
+/* contents of a HTK lattice file */
+struct HTKLattice {
+  std::string Utterance;           // name of the utterance
+  std::size_t NumNodes = 0;        // number of nodes (N=)
+  std::size_t NumLinks = 0;        // number of links as given in the header (L=)
+  std::vector<float> NodeTimes;    // node times (t=), only if requested
+  std::vector<std::string> Phones; // distinct phones in order of first occurence
+  std::vector<HTKLink> Links;      // links in file order
+};
+
+/* Parser for HTK SLF lattices. The file is memory mapped and scanned field
+   by field without creating intermediate strings, every distinct phone is
+   only copied once. The fields are interpreted by position like in the
+   original line based reader:
+     line 2:         utterance name (after the first '=')
+     first N= line:  N=<nodes> L=<links>
+     I= lines:       I=<node> t=<time> (only if node times are read)
+     J= lines:       J=<link> S=<start> E=<end> W=<phone> [v=<var>] a=<am> l=<lm>
+   Phones in quotes (as written by RASR) are unquoted. */
+class HTKLatticeParser {
+  /* internal functions */
+  // parse float from [Begin, End), falls back to std::stof for inf/nan
+  static float ParseFloat(
+    const char *Begin,
+    const char *End
+  );
+
+  // parse non negative integer from [Begin, End), throws if it does not fit
+  // into an int
+  static long ParseInt(
+    const char *Begin,
+    const char *End
+  );
+
+public:
+  /* interface */
+  // parse lattice from file
+  static void Parse(
+    const std::string &FileName,
+    bool ReadNodeTimes,
+    HTKLattice *Lattice
+  );
+
+  // parse lattice from buffer
+  static void Parse(
+    const char *Begin,
+    const char *End,
+    bool ReadNodeTimes,
+    HTKLattice *Lattice
+  );
+};
+
+#endif
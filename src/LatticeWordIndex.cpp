@@ -0,0 +1,276 @@
+// ----------------------------------------------------------------------------
+/**
+   File: LatticeWordIndex.cpp
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+*/
+// ----------------------------------------------------------------------------
+#include <algorithm>
+#include <map>
+#include <iostream>
+#include "LatticeWordIndex.hpp"
+
+using std::vector;
+
+LatticeWordIndex::SequenceEntry::SequenceEntry() :
+  LatticeIndices(),
+  Positions(),
+  WordId(-1)
+{
+}
+
+LatticeWordIndex::LatticeWordIndex(
+  const vector< LogVectorFst > &InputFsts,
+  unsigned int MaxSequenceLength_,
+  std::size_t MaxNumSequencesPerLattice_
+) :
+  MaxSequenceLength(MaxSequenceLength_),
+  MaxNumSequencesPerLattice(MaxNumSequencesPerLattice_),
+  Sequences(),
+  CandidateWordIds(InputFsts.size()),
+  CandidateEntries(InputFsts.size()),
+  Indexed(InputFsts.size(), false),
+  LongWords(),
+  LongWordIds()
+{
+  Sequences.set_deleted_key(vector<int>(1, DELETED));
+  Sequences.set_empty_key(vector<int>(1, EMPTY));
+  LongWords.set_deleted_key(vector<int>(1, DELETED));
+  LongWords.set_empty_key(vector<int>(1, EMPTY));
+
+  std::size_t NumIndexed = 0;
+  vector<vector<int> > LatticeSequences;
+  vector<int> Sequence;
+  vector<StateId> States;
+  for (std::size_t LatticeIdx = 0; LatticeIdx < InputFsts.size(); ++LatticeIdx) {
+    const LogVectorFst &InputFst = InputFsts[LatticeIdx];
+
+    // collect the character sequences starting in every state of the lattice
+    LatticeSequences.clear();
+    bool Complete = true;
+    for (LogStateIterator siter(InputFst); !siter.Done() && Complete; siter.Next()) {
+      States.assign(1, siter.Value());
+      AddSkipClosure(InputFst, &States);
+      Complete = CollectSequences(InputFst, States, &Sequence, &LatticeSequences);
+    }
+    if (!Complete) {
+      continue;
+    }
+
+    // add lattice to the entries of all distinct sequences
+    std::sort(LatticeSequences.begin(), LatticeSequences.end());
+    LatticeSequences.erase(std::unique(LatticeSequences.begin(), LatticeSequences.end()), LatticeSequences.end());
+    for (const vector<int> &LatticeSequence : LatticeSequences) {
+      Sequences[LatticeSequence].LatticeIndices.push_back(LatticeIdx);
+    }
+    Indexed[LatticeIdx] = true;
+    ++NumIndexed;
+  }
+
+  std::cout << " Lattice word index: " << NumIndexed << " of " << InputFsts.size()
+            << " lattices indexed with " << Sequences.size()
+            << " character sequences" << std::endl << std::endl;
+}
+
+void LatticeWordIndex::AddSkipClosure(
+  const LogVectorFst &InputFst,
+  vector<StateId> *States
+)
+{
+  for (std::size_t StateIdx = 0; StateIdx < States->size(); ++StateIdx) {
+    for (fst::ArcIterator<LogVectorFst> aiter(InputFst, (*States)[StateIdx]); !aiter.Done(); aiter.Next()) {
+      const fst::LogArc &Arc = aiter.Value();
+      if (((Arc.olabel == EPS_SYMBOLID) || (Arc.olabel == UNKEND_SYMBOLID)) &&
+          (std::find(States->begin(), States->end(), Arc.nextstate) == States->end())) {
+        States->push_back(Arc.nextstate);
+      }
+    }
+  }
+}
+
+bool LatticeWordIndex::CollectSequences(
+  const LogVectorFst &InputFst,
+  const vector<StateId> &States,
+  vector<int> *Sequence,
+  vector<vector<int> > *LatticeSequences
+) const
+{
+  // group the successor states by character, so that every distinct sequence
+  // is only expanded once
+  std::map<int, vector<StateId> > NextStates;
+  for (StateId State : States) {
+    for (fst::ArcIterator<LogVectorFst> aiter(InputFst, State); !aiter.Done(); aiter.Next()) {
+      const fst::LogArc &Arc = aiter.Value();
+      if ((Arc.olabel != EPS_SYMBOLID) && (Arc.olabel != UNKEND_SYMBOLID)) {
+        vector<StateId> &Next = NextStates[Arc.olabel];
+        if (std::find(Next.begin(), Next.end(), Arc.nextstate) == Next.end()) {
+          Next.push_back(Arc.nextstate);
+        }
+      }
+    }
+  }
+
+  for (auto &Next : NextStates) {
+    Sequence->push_back(Next.first);
+    LatticeSequences->push_back(*Sequence);
+    bool Complete = LatticeSequences->size() <= MaxNumSequencesPerLattice;
+    if (Complete && (Sequence->size() < MaxSequenceLength)) {
+      AddSkipClosure(InputFst, &Next.second);
+      Complete = CollectSequences(InputFst, Next.second, Sequence, LatticeSequences);
+    }
+    Sequence->pop_back();
+    if (!Complete) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void LatticeWordIndex::EraseWordId(int WordId, vector<int> *WordIds)
+{
+  vector<int>::iterator it = std::find(WordIds->begin(), WordIds->end(), WordId);
+  if (it != WordIds->end()) {
+    *it = WordIds->back();
+    WordIds->pop_back();
+  }
+}
+
+void LatticeWordIndex::ClearWords()
+{
+  for (SequenceHashmap::iterator it = Sequences.begin(); it != Sequences.end(); ++it) {
+    it->second.WordId = -1;
+  }
+  for (vector<int> &WordIds : CandidateWordIds) {
+    WordIds.clear();
+  }
+  for (vector<CandidateEntry> &Entries : CandidateEntries) {
+    Entries.clear();
+  }
+  LongWords.clear();
+  LongWordIds.clear();
+}
+
+void LatticeWordIndex::AddWord(
+  vector<int>::const_iterator WordBegin,
+  int WordLength,
+  int WordId
+)
+{
+  if (WordLength <= 0) {
+    return;
+  }
+
+  vector<int> Word(WordBegin, WordBegin + WordLength);
+  if (static_cast<unsigned int>(WordLength) > MaxSequenceLength) {
+    if (LongWords.insert(std::make_pair(Word, WordId)).second) {
+      LongWordIds.push_back(WordId);
+    }
+    return;
+  }
+
+  // words not contained in any lattice have no entry
+  SequenceHashmap::iterator it = Sequences.find(Word);
+  if ((it == Sequences.end()) || (it->second.WordId != -1)) {
+    return;
+  }
+  SequenceEntry &Entry = it->second;
+  Entry.WordId = WordId;
+  Entry.Positions.resize(Entry.LatticeIndices.size());
+  for (std::size_t IdxLattice = 0; IdxLattice < Entry.LatticeIndices.size(); ++IdxLattice) {
+    int LatticeIdx = Entry.LatticeIndices[IdxLattice];
+    Entry.Positions[IdxLattice] = CandidateWordIds[LatticeIdx].size();
+    CandidateWordIds[LatticeIdx].push_back(WordId);
+    CandidateEntries[LatticeIdx].push_back({&Entry, static_cast<int>(IdxLattice)});
+  }
+}
+
+void LatticeWordIndex::RemoveWord(
+  vector<int>::const_iterator WordBegin,
+  int WordLength
+)
+{
+  if (WordLength <= 0) {
+    return;
+  }
+
+  vector<int> Word(WordBegin, WordBegin + WordLength);
+  if (static_cast<unsigned int>(WordLength) > MaxSequenceLength) {
+    Word2IdHashmap::iterator it = LongWords.find(Word);
+    if (it != LongWords.end()) {
+      EraseWordId(it->second, &LongWordIds);
+      LongWords.erase(it);
+    }
+    return;
+  }
+
+  SequenceHashmap::iterator it = Sequences.find(Word);
+  if ((it == Sequences.end()) || (it->second.WordId == -1)) {
+    return;
+  }
+  // replace the word by the last candidate of each lattice, whose position
+  // is updated in its entry
+  SequenceEntry &Entry = it->second;
+  for (std::size_t IdxLattice = 0; IdxLattice < Entry.LatticeIndices.size(); ++IdxLattice) {
+    int LatticeIdx = Entry.LatticeIndices[IdxLattice];
+    int Position = Entry.Positions[IdxLattice];
+    vector<int> &WordIds = CandidateWordIds[LatticeIdx];
+    vector<CandidateEntry> &Entries = CandidateEntries[LatticeIdx];
+    WordIds[Position] = WordIds.back();
+    Entries[Position] = Entries.back();
+    Entries[Position].Entry->Positions[Entries[Position].IdxLattice] = Position;
+    WordIds.pop_back();
+    Entries.pop_back();
+  }
+  Entry.WordId = -1;
+}
+
+bool LatticeWordIndex::IsIndexed(std::size_t LatticeIdx) const
+{
+  return Indexed[LatticeIdx];
+}
+
+const vector<int> &LatticeWordIndex::GetCandidateWordIds(std::size_t LatticeIdx) const
+{
+  return CandidateWordIds[LatticeIdx];
+}
+
+const vector<int> &LatticeWordIndex::GetLongWordIds() const
+{
+  return LongWordIds;
+}
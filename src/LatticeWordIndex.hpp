@@ -0,0 +1,159 @@
+// ----------------------------------------------------------------------------
+/**
+   File: LatticeWordIndex.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+
+   E-Mail: agent@local
+
+   Description: index of candidate words contained in the input lattices
+
+   Limitations: -
+
+   Change History:
+   Date         Author       Description
+   2026-10-19   agent        Initial
+*/
+// ----------------------------------------------------------------------------
+#ifndef _LATTICEWORDINDEX_HPP_
+#define _LATTICEWORDINDEX_HPP_
+
+#include <fst/vector-fst.h>
+#include "definitions.hpp"
+
+/* index mapping every input lattice to the lexicon words whose character
+   sequence occurs on one of its paths */
+class LatticeWordIndex {
+  /* lattices containing a character sequence and the word id of the sequence */
+  struct SequenceEntry {
+    std::vector<int> LatticeIndices; // lattices containing the character sequence
+    std::vector<int> Positions;      // position of the word in the candidates of each lattice
+    int WordId;                      // id of the word if in lexicon, -1 otherwise
+    SequenceEntry();                 // initialize entry without word id
+  };
+
+  /* sequence entry of a candidate word and the index of the lattice in it */
+  struct CandidateEntry {
+    SequenceEntry *Entry; // entry of the word (the entries are not moved after construction)
+    int IdxLattice;       // index of the lattice in the lattice indices of the entry
+  };
+
+  typedef google::dense_hash_map<std::vector<int>, SequenceEntry, boost::hash< std::vector<int> > > SequenceHashmap;
+
+  const unsigned int MaxSequenceLength;            // maximum length of indexed character sequences
+  const std::size_t MaxNumSequencesPerLattice;     // maximum number of collected sequences per lattice before giving up
+  SequenceHashmap Sequences;                       // character sequences found in the lattices
+  std::vector<std::vector<int> > CandidateWordIds; // candidate word ids for every lattice
+  std::vector<std::vector<CandidateEntry> > CandidateEntries; // sequence entries of the candidate word ids
+  std::vector<bool> Indexed;                       // indicates if the lattice could be indexed
+  Word2IdHashmap LongWords;                        // words longer than MaxSequenceLength, candidates for every lattice
+  std::vector<int> LongWordIds;                    // ids of the long words
+
+
+  /* internal functions */
+  // add all states reachable from the given states via epsilon or word end
+  // arcs, which do not belong to a character sequence
+  static void AddSkipClosure(
+    const LogVectorFst &InputFst,
+    std::vector<StateId> *States
+  );
+
+  // collect all character sequences continuing from the given states, returns
+  // false if the maximum number of sequences is exceeded
+  bool CollectSequences(
+    const LogVectorFst &InputFst,
+    const std::vector<StateId> &States,
+    std::vector<int> *Sequence,
+    std::vector<std::vector<int> > *LatticeSequences
+  ) const;
+
+  // remove word id from vector by swapping with last element
+  static void EraseWordId(
+    int WordId,
+    std::vector<int> *WordIds
+  );
+
+public:
+  /* constructor */
+  // build the index for the given input lattices
+  LatticeWordIndex(
+    const std::vector<LogVectorFst> &InputFsts,
+    unsigned int MaxSequenceLength_,
+    std::size_t MaxNumSequencesPerLattice_ = 1000000
+  );
+
+
+  /* interface */
+  // remove all words from the index, e.g. before rebuilding the lexicon
+  void ClearWords();
+
+  // add word to the candidate words of all lattices containing its characters
+  void AddWord(
+    std::vector<int>::const_iterator WordBegin,
+    int WordLength,
+    int WordId
+  );
+
+  // remove word from the candidate words of all lattices
+  void RemoveWord(
+    std::vector<int>::const_iterator WordBegin,
+    int WordLength
+  );
+
+  // return true if the candidates of given lattice are available
+  bool IsIndexed(
+    std::size_t LatticeIdx
+  ) const;
+
+  // return candidate word ids of given lattice (without the long words)
+  const std::vector<int> &GetCandidateWordIds(
+    std::size_t LatticeIdx
+  ) const;
+
+  // return ids of words too long to be indexed, candidates for all lattices
+  const std::vector<int> &GetLongWordIds() const;
+};
+
+#endif
@@ -46,6 +46,10 @@
 #include <iomanip>
 #include <numeric>
 #include <chrono>
+#include <atomic>
+#include <set>
+#include <sstream>
+#include <cstdio>
 #include <fst/compose.h>
 #include <fst/arcsort.h>
 #include "LatticeWordSegmentation.hpp"
@@ -55,6 +59,7 @@
 #include "NHPYLMFst.hpp"
 #include "WordLengthProbCalculator.hpp"
 #include "Evaluate/Evaluate.hpp"
+#include "FileReader/FileReader.hpp"
 
 using std::vector;
 using std::string;
@@ -77,6 +82,13 @@ LatticeWordSegmentation::LatticeWordSegmentation(
   Threads(MaxNumThreads - 1),
   Timer(MaxNumThreads, Params.AddCharN > 0 ? 5 : 4)
 {
+  if (!Params.TraceFile.empty()) {
+    Timer.EnableTrace(Params.TraceCapacity, Params.AsyncEvaluation);
+  }
+  if (Params.PerfCounters && !Timer.EnableCounters()) {
+    std::cout << " Hardware performance counters are not available, "
+              << "continuing without them" << std::endl;
+  }
 }
 
 /*****************************************************************************
@@ -93,32 +105,72 @@ LatticeWordSegmentation::LatticeWordSegmentation(
  *   - Sample new segmentation for imput lattices using lexicon and language
  *     model
  *   - Add segmentation result to dictionary, language model and fsts
+ * - Entry function for segmenting new data: DoDecoding
+ *   - Load and freeze language model from checkpoint and segment all
+ *     input lattices once without updating the language model
  ******************************************************************************/
 
-void LatticeWordSegmentation::DoWordSegmentation()
+bool LatticeWordSegmentation::DoWordSegmentation()
 {
   std::cout << " Starting word segmentation!" << std::endl;
 
   // initialize empty language model and dictionary and perform
   // language model initialization from initialization sentences
   // (parse reference fsts, add to language model and retrain)
-  InitializeLanguageModel(Params.UnkN, Params.KnownN, Params.AddCharN);
-
-  // initialize output vector for sampled sentences and fsts
+  // or restore language model and sampled sentences from a checkpoint
   NumSampledSentences = InputFileData.GetInputFsts().size();
-  SampledSentences.resize(
-    NumSampledSentences,
-    std::vector<int>(WHPYLMContextLength, SentEndWordId)
-  );
-  TimedSampledSentences.resize(NumSampledSentences);
+  std::size_t FirstIter = 0;
+  if (Params.ResumeFile.empty()) {
+    InitializeLanguageModel(Params.UnkN, Params.KnownN, Params.AddCharN);
+
+    // initialize output vector for sampled sentences
+    SampledSentences.resize(
+      NumSampledSentences,
+      std::vector<int>(WHPYLMContextLength, SentEndWordId)
+    );
+    TimedSampledSentences.resize(NumSampledSentences);
+  } else {
+    FirstIter = ReadCheckpoint(Params.ResumeFile);
+  }
+
+  // the sampled fsts are regenerated for every sentence in each iteration
   SampledFsts.resize(NumSampledSentences);
+  if (Params.CostProfile) {
+    CostProfiles.resize(NumSampledSentences);
+  }
 
   // create index vector of shuffled sentence indices
   std::vector<int> ShuffledIndices(NumSampledSentences);
   std::iota(ShuffledIndices.begin(), ShuffledIndices.end(), 0);
 
+  // index the character sequences of the input lattices once, the candidate
+  // words are then kept in sync with the lexicon transducer
+  if (Params.CandidateIndexLength > 0) {
+    Timer.tLexFst.SetStart();
+    CandidateIndex = std::unique_ptr<LatticeWordIndex>(new LatticeWordIndex(
+      InputFileData.GetInputFsts(), Params.CandidateIndexLength));
+    Timer.tLexFst.AddTimeSinceStartToDuration();
+  }
+
+  // parse the reference sentences once for all evaluations
+  InitializeReferenceWords();
+
+  // with sharded sampling every worker process runs the iterations on its
+  // own part of the sentences, the calling process only relays messages
+  if (Params.NumShards > 0) {
+    ShuffledIndices = InitializeShards();
+    if (Shards->IsCoordinator()) {
+      Shards->RelayMessages();
+      Shards.reset();
+      delete LanguageModel;
+      delete CharacterLanguageModel;
+      return true;
+    }
+  }
+  bool IsFirstShard = (Shards == nullptr) || (Shards->GetShardId() == 0);
+
   // run the actual iterations
-  for (std::size_t IdxIter = 0; IdxIter < Params.NumIter; ++IdxIter) {
+  for (std::size_t IdxIter = FirstIter; IdxIter < Params.NumIter; ++IdxIter) {
     std::cout << "  Iteration: " << IdxIter + 1
               << " of " << Params.NumIter << std::endl;
 
@@ -137,27 +189,45 @@ void LatticeWordSegmentation::DoWordSegmentation()
       CHARACTERSBEGIN,
       LanguageModel->GetWHPYLMBaseProbabilitiesScale()
     );
+    if (CandidateIndex != nullptr) {
+      CandidateIndex->ClearWords();
+      LexiconTransducer.SetCandidateIndex(CandidateIndex.get());
+    }
     LexiconTransducer.BuildLexiconTansducer(LanguageModel->GetWord2Id());
     Timer.tLexFst.AddTimeSinceStartToDuration();
 
     // iterate over every sentence
-    DoWordSegmentationSentenceIterations(
-      ShuffledIndices, &LexiconTransducer, IdxIter
-    );
-
-    // calculate and update word length statistics
-    WordLengthProbCalculator::UpdateWHPYLMBaseProbabilitiesScale(
-      LanguageModel,
-      Params.WordLengthModulation
-    );
+    if (Shards == nullptr) {
+      DoWordSegmentationSentenceIterations(
+        ShuffledIndices, 0, ShuffledIndices.size(), &LexiconTransducer, IdxIter
+      );
+    } else {
+      DoShardedWordSegmentationSentenceIterations(
+        ShuffledIndices, &LexiconTransducer, IdxIter
+      );
+    }
+    std::cout << std::endl << std::endl;
+    PrintMemoryUsage(&LexiconTransducer);
+
+    // calculate and update word length statistics and resample
+    // hyperparameters of language model, with sharded sampling the first
+    // shard does it for all
+    if (IsFirstShard) {
+      WordLengthProbCalculator::UpdateWHPYLMBaseProbabilitiesScale(
+        LanguageModel,
+        Params.WordLengthModulation
+      );
 
-    // resample hyperparameters of language model
-    Timer.tHypSample.SetStart();
-    LanguageModel->ResampleHyperParameters();
-    if (CharacterLanguageModel != nullptr) {
-      CharacterLanguageModel->ResampleHyperParameters();
+      Timer.tHypSample.SetStart();
+      LanguageModel->ResampleHyperParameters();
+      if (CharacterLanguageModel != nullptr) {
+        CharacterLanguageModel->ResampleHyperParameters();
+      }
+      Timer.tHypSample.AddTimeSinceStartToDuration();
+    }
+    if (Shards != nullptr) {
+      ExchangeHyperParameters();
     }
-    Timer.tHypSample.AddTimeSinceStartToDuration();
 
     // set discount and concentration to zero for unigram word model
     // (no new words allowed)
@@ -167,18 +237,11 @@ void LatticeWordSegmentation::DoWordSegmentation()
       LanguageModel->SetParameter("WHPYLM", "Concentration", 0, 0.00001);
     }
 
-    // Evaluation of current iteration
-    Evaluate Eval(
-      Params,
-      InputFileData,
-      Timer,
-      LanguageModel,
-      CharacterLanguageModel
-    );
-    Eval.WriteSentencesToOutputFiles(
-      SampledSentences, TimedSampledSentences, IdxIter
-    );
-    Eval.OutputMeasureStatistics(SampledSentences, SampledFsts, IdxIter);
+    // Evaluation of current iteration, all shards have the same
+    // segmentation, so only the first one evaluates
+    if (IsFirstShard) {
+      EvaluateIteration(IdxIter);
+    }
 
     // switch language model order, if specified
     if ((IdxIter + 1) == Params.SwitchIter) {
@@ -188,30 +251,324 @@ void LatticeWordSegmentation::DoWordSegmentation()
         Params.NewAddCharN
       );
     }
+
+    // capture sampler state, the file is written in the background
+    if (IsFirstShard && (Params.CheckpointInterval > 0) &&
+        (((IdxIter + 1) % Params.CheckpointInterval) == 0)) {
+      WriteCheckpoint(IdxIter + 1);
+    }
   }
+  JoinCheckpointThread();
+  JoinEvaluationThread();
 
-  if (Params.WriteRescoredLattices) {
+  if (IsFirstShard && Params.WriteRescoredLattices) {
     WriteRescoredLattices();
   }
+  WriteTrace();
+  WriteTimingStatistics();
 
   // cleanup
   delete LanguageModel;
   delete CharacterLanguageModel;
+
+  // the workers are ended by the caller, only the coordinator goes on
+  if (Shards != nullptr) {
+    Shards.reset();
+    return false;
+  }
+  return true;
+}
+
+void LatticeWordSegmentation::DoDecoding()
+{
+  std::cout << " Starting decoding with frozen language model from "
+            << Params.DecodeFile << std::endl;
+
+  InitializeDecoding(Params.DecodeFile);
+
+  NumSampledSentences = InputFileData.GetInputFsts().size();
+  SampledSentences.assign(NumSampledSentences, std::vector<int>());
+  TimedSampledSentences.assign(NumSampledSentences, std::vector<ArcInfo>());
+  SampledFsts.resize(NumSampledSentences);
+
+  // segment sentences in parallel
+  Timer.tSample.SetStart();
+  ParallelForEach(NumSampledSentences,
+    [&](std::size_t IdxSentence, std::size_t IdxThread) {
+      Timer.tSentences[IdxThread].SetStart();
+      DecodeLattice(InputFileData.GetInputFsts().at(IdxSentence), IdxThread,
+                    &SampledFsts[IdxSentence]);
+      Timer.tSentences[IdxThread].AddTimeSinceStartToDuration(IdxSentence);
+    });
+  Timer.tSample.AddTimeSinceStartToDuration();
+
+  // parse samples, new words are only added to the dictionary
+  Timer.tParseAndAdd.SetStart();
+  for (std::size_t IdxSentence = 0; IdxSentence < NumSampledSentences;
+       ++IdxSentence) {
+    ParseLib::ParseSampleAndAddCharacterIdSequenceToDictionary(
+      SampledFsts[IdxSentence],
+      LanguageModel,
+      &SampledSentences[IdxSentence],
+      &TimedSampledSentences[IdxSentence],
+      InputFileData.GetInputArcInfos()
+    );
+    SampledSentences[IdxSentence].insert(SampledSentences[IdxSentence].begin(),
+                                         WHPYLMContextLength, SentEndWordId);
+  }
+  Timer.tParseAndAdd.AddTimeSinceStartToDuration();
+
+  // write results and statistics
+  InitializeReferenceWords();
+  Evaluate Eval(
+    Params,
+    InputFileData,
+    Timer,
+    LanguageModel,
+    CharacterLanguageModel,
+    ReferenceWords.get()
+  );
+  Eval.WriteSentencesToOutputFiles(*LanguageModel, SampledSentences,
+                                   TimedSampledSentences, 0);
+  Eval.OutputMeasureStatistics(SampledSentences, SampledFsts, 0);
+  PrintMemoryUsage(nullptr);
+  WriteTrace();
+  WriteTimingStatistics();
+
+  // cleanup
+  delete LanguageModel;
+  delete CharacterLanguageModel;
+}
+
+void LatticeWordSegmentation::Serve()
+{
+  std::cout << " Starting segmentation server with frozen language model from "
+            << Params.DecodeFile << std::endl;
+
+  InitializeDecoding(Params.DecodeFile);
+
+  // symbols of the lattices sent by the clients
+  StringToIntMapper Symbols;
+  for (const auto &Symbol : InputFileData.GetInputIntToStringVector()) {
+    Symbols.Insert(Symbol);
+  }
+
+  // words of the model, new words of a request are removed again after the
+  // request is answered
+  std::vector<bool> IsModelWord(LanguageModel->GetMaxNumWords(), false);
+  for (const auto &Word : LanguageModel->GetId2Word()) {
+    IsModelWord[Word.first] = true;
+  }
+
+  SegmentationServer Server(
+    Params.ServeSocket,
+    Params.ServeBatchSize,
+    [&](std::vector<SegmentationRequest> *Requests) {
+      DecodeRequests(Symbols, IsModelWord, Requests);
+    }
+  );
+  Server.Run();
+  Timer.PrintTimingStatistics();
+  WriteTrace();
+  WriteTimingStatistics();
+
+  // cleanup
+  delete LanguageModel;
+  delete CharacterLanguageModel;
+}
+
+void LatticeWordSegmentation::InitializeDecoding(const std::string &FileName)
+{
+  // restore the language models, the sampled sentences of the training data
+  // are not needed
+  {
+    CheckpointReader Reader(FileName);
+    std::size_t NumFinishedIter = Reader.Read<uint64_t>();
+    Reader.Read<uint64_t>();
+    std::cout << "  Language model after iteration " << NumFinishedIter
+              << std::endl;
+    ReadLanguageModelsFromCheckpoint(&Reader, FileName);
+  }
+
+  // the models are not changed anymore, all probability calculations
+  // can be done without locking
+  LanguageModel->Freeze();
+  if (CharacterLanguageModel != nullptr) {
+    CharacterLanguageModel->Freeze();
+  }
+
+  // build lexicon transducer for the words of the model
+  Timer.tLexFst.SetStart();
+  DecodingLexiconTransducer = std::unique_ptr<LexFst>(new LexFst(
+    Params.Debug,
+    InputFileData.GetInputIntToStringVector(),
+    CHARACTERSBEGIN,
+    LanguageModel->GetWHPYLMBaseProbabilitiesScale()
+  ));
+  DecodingLexiconTransducer->BuildLexiconTansducer(LanguageModel->GetWord2Id());
+  Timer.tLexFst.AddTimeSinceStartToDuration();
+
+  // language model fsts with all words active, their arcs are expanded once
+  // and then shared by all threads
+  DecodingLanguageModelFST = std::unique_ptr<NHPYLMFst>(new NHPYLMFst(
+      *LanguageModel, SentEndWordId, AllWordsActive));
+  if (CharacterLanguageModel != nullptr) {
+    DecodingCharacterLanguageModelFST = std::unique_ptr<NHPYLMFst>(new NHPYLMFst(
+        *CharacterLanguageModel, EOW, AllWordsActive, true, AvailChars));
+  }
+}
+
+void LatticeWordSegmentation::ParallelForEach(
+  std::size_t NumItems,
+  const std::function<void(std::size_t, std::size_t)> &Fn
+)
+{
+  // each thread fetches the next item when it is done with the previous one,
+  // the last thread runs in the main program
+  std::atomic<std::size_t> NextItem(0);
+  auto Worker = [&](std::size_t IdxThread) {
+    for (std::size_t IdxItem = NextItem++; IdxItem < NumItems;
+         IdxItem = NextItem++) {
+      Fn(IdxItem, IdxThread);
+    }
+  };
+
+  std::size_t NumThreads = std::max<std::size_t>(
+    1, std::min(MaxNumThreads, NumItems));
+  for (std::size_t IdxThread = 0; IdxThread < (NumThreads - 1); ++IdxThread) {
+    Threads[IdxThread] = std::thread(Worker, IdxThread);
+  }
+  Worker(NumThreads - 1);
+  for (std::size_t IdxThread = 0; IdxThread < (NumThreads - 1); ++IdxThread) {
+    Threads[IdxThread].join();
+  }
+}
+
+void LatticeWordSegmentation::DecodeLattice(
+  const LogVectorFst &InputFst,
+  std::size_t IdxThread,
+  LogVectorFst *SampledFst
+)
+{
+  LogVectorFst const *LexiconInputFst = &InputFst;
+  std::unique_ptr<LogVectorFst> CharFst;
+  if (DecodingCharacterLanguageModelFST != nullptr) {
+    CharFst = std::unique_ptr<LogVectorFst>(new LogVectorFst);
+    SampleLib::ComposeAndSampleFromInputAndAddCharLM(
+      &InputFst,
+      DecodingCharacterLanguageModelFST.get(),
+      CharFst.get(),
+      &InputFileData.GetWordEndTransducer(),
+      &Timer.tInSamples[IdxThread]
+    );
+    LexiconInputFst = CharFst.get();
+  }
+
+  SampleLib::ComposeAndSampleFromInputLexiconAndSharedLM(
+    LexiconInputFst,
+    DecodingLexiconTransducer.get(),
+    DecodingLanguageModelFST.get(),
+    SampledFst,
+    &Timer.tInSamples[IdxThread],
+    Params.BeamWidth,
+    Params.UseViterby > 0
+  );
+}
+
+void LatticeWordSegmentation::DecodeRequests(
+  const StringToIntMapper &Symbols,
+  const std::vector<bool> &IsModelWord,
+  std::vector<SegmentationRequest> *Requests
+)
+{
+  // read and segment the lattices in parallel
+  std::vector<LogVectorFst> SampledRequestFsts(Requests->size());
+  std::vector<std::vector<ArcInfo> > RequestArcInfos(Requests->size());
+  Timer.tSample.SetStart();
+  ParallelForEach(Requests->size(),
+    [&](std::size_t IdxRequest, std::size_t IdxThread) {
+      SegmentationRequest &Request = (*Requests)[IdxRequest];
+      try {
+        LogVectorFst InputFst;
+        FileReader::ReadLatticeFromMemory(Params, Request.IsHTKLattice,
+                                          Request.Lattice, Symbols, &InputFst,
+                                          &RequestArcInfos[IdxRequest]);
+        DecodeLattice(InputFst, IdxThread, &SampledRequestFsts[IdxRequest]);
+      } catch (const std::exception &e) {
+        Request.Error = e.what();
+      }
+    });
+  Timer.tSample.AddTimeSinceStartToDuration();
+
+  // parse the samples, new words are added to the dictionary to get their
+  // written form
+  Timer.tParseAndAdd.SetStart();
+  std::set<int> NewWords;
+  for (std::size_t IdxRequest = 0; IdxRequest < Requests->size(); ++IdxRequest) {
+    SegmentationRequest &Request = (*Requests)[IdxRequest];
+    if (!Request.Error.empty()) {
+      continue;
+    }
+    std::vector<int> Sentence;
+    std::vector<ArcInfo> TimedSentence;
+    try {
+      ParseLib::ParseSampleAndAddCharacterIdSequenceToDictionary(
+        SampledRequestFsts[IdxRequest],
+        LanguageModel,
+        &Sentence,
+        &TimedSentence,
+        RequestArcInfos[IdxRequest]
+      );
+    } catch (const std::exception &e) {
+      Request.Error = e.what();
+      continue;
+    }
+    if (RequestArcInfos[IdxRequest].empty()) {
+      for (int WordId : Sentence) {
+        TimedSentence.push_back(ArcInfo(WordId, -1, -1));
+      }
+    }
+    for (const ArcInfo &Word : TimedSentence) {
+      if (Word.label == static_cast<int>(SentEndWordId)) {
+        continue;
+      }
+      SegmentedWord Segmented;
+      Segmented.Word = LanguageModel->GetCharacterSequence(Word.label);
+      Segmented.Start = Word.start;
+      Segmented.End = Word.end;
+      Request.Words.push_back(Segmented);
+      if ((static_cast<std::size_t>(Word.label) >= IsModelWord.size()) ||
+          !IsModelWord[Word.label]) {
+        NewWords.insert(Word.label);
+      }
+    }
+  }
+
+  // keep the dictionary at the words of the model
+  for (int WordId : NewWords) {
+    LanguageModel->RemoveWordFromDictionary(WordId);
+  }
+  Timer.tParseAndAdd.AddTimeSinceStartToDuration();
 }
 
 void LatticeWordSegmentation::DoWordSegmentationSentenceIterations(
   const vector< int > &ShuffledIndices,
+  std::size_t IdxBegin,
+  std::size_t IdxEnd,
   LexFst *LexiconTransducer,
   std::size_t IdxIter
 )
 {
-  for (std::size_t IdxSentence = 0; IdxSentence < NumSampledSentences;
+  bool ShowProgress = (Shards == nullptr) || (Shards->GetShardId() == 0);
+  for (std::size_t IdxSentence = IdxBegin; IdxSentence < IdxEnd;
        IdxSentence += MaxNumThreads) {
     std::size_t NumThreads =
-      std::min(MaxNumThreads, NumSampledSentences - IdxSentence);
+      std::min(MaxNumThreads, IdxEnd - IdxSentence);
 
-    std::cerr << "\r   Sentence: " << IdxSentence + 1
-              << " of " << NumSampledSentences;
+    if (ShowProgress) {
+      std::cerr << "\r   Sentence: " << IdxSentence + 1
+                << " of " << ShuffledIndices.size();
+    }
 
     // remove words from lexicon, fst and lm
     Timer.tRemove.SetStart();
@@ -239,17 +596,30 @@ void LatticeWordSegmentation::DoWordSegmentationSentenceIterations(
     // the last thread will run in the main program since this is
     // more effective if running only one thread
     Timer.tSample.SetStart();
+
     bool UseViterby =
       (Params.UseViterby > 0) && ((IdxIter + 1) >= Params.UseViterby);
 
+    const std::vector<bool> AllCharactersActive;
     std::unique_ptr<NHPYLMFst> CharacterLanguageModelFST;
     if (CharacterLanguageModel != nullptr) {
       CharacterLanguageModelFST = std::unique_ptr<NHPYLMFst>(new NHPYLMFst(
-          *CharacterLanguageModel, EOW, std::vector<bool>(), true, AvailChars));
+          *CharacterLanguageModel, EOW, AllCharactersActive, true, AvailChars));
     }
 
     auto SampleFn = [&](std::size_t IdxSentence, std::size_t IdxThread) {
       std::size_t CurrentIndex = ShuffledIndices[IdxSentence + IdxThread];
+      SentenceCostProfile *Profile = nullptr;
+      std::vector<double> StageStartTimes;
+      double SentenceStartTime = Timer.tSentences[IdxThread].GetDuration();
+      if (Params.CostProfile) {
+        Profile = &CostProfiles[CurrentIndex];
+        *Profile = SentenceCostProfile();
+        for (const auto &t : Timer.tInSamples[IdxThread]) {
+          StageStartTimes.push_back(t.GetDuration());
+        }
+      }
+      Timer.tSentences[IdxThread].SetStart();
       LogVectorFst const *InputFst;
       std::unique_ptr<LogVectorFst> CharFst;
 
@@ -275,8 +645,28 @@ void LatticeWordSegmentation::DoWordSegmentationSentenceIterations(
         &SampledFsts[CurrentIndex],
         &Timer.tInSamples[IdxThread],
         Params.BeamWidth,
-        UseViterby
+        UseViterby,
+        CandidateIndex.get(),
+        CurrentIndex,
+        Profile
       );
+      Timer.tSentences[IdxThread].AddTimeSinceStartToDuration(CurrentIndex);
+
+      if (Profile != nullptr) {
+        Profile->Recorded = true;
+        Profile->NumInputStates = InputFst->NumStates();
+        for (int s = 0; s < InputFst->NumStates(); ++s) {
+          Profile->NumInputArcs += InputFst->NumArcs(s);
+        }
+        for (std::size_t IdxStage = 0; IdxStage < StageStartTimes.size();
+             ++IdxStage) {
+          Profile->StageTimes.push_back(
+            Timer.tInSamples[IdxThread][IdxStage].GetDuration() -
+            StageStartTimes[IdxStage]);
+        }
+        Profile->Time =
+          Timer.tSentences[IdxThread].GetDuration() - SentenceStartTime;
+      }
     };
 
     for (std::size_t IdxThread = 0; IdxThread < (NumThreads - 1); ++IdxThread) {
@@ -317,7 +707,354 @@ void LatticeWordSegmentation::DoWordSegmentationSentenceIterations(
     Timer.tParseAndAdd.AddTimeSinceStartToDuration();
 //     std::cout << "End parse sample and add charactrer id sequence to dictionary" << std::endl << std::flush;
   }
-  std::cout << std::endl << std::endl;
+}
+
+/*****************************************************************************
+ * Sharded sampling (-Shards N K)
+ * - Every worker process samples the sentences with index i % N == ShardId
+ *   with its own language model. After every K sentences of each worker the
+ *   segmentations of the block are exchanged and every worker replaces the
+ *   old segmentations of the other shards' sentences in its model. Words are
+ *   exchanged as character sequences and mapped to process local word ids.
+ * - The first shard updates the hyper parameters after each iteration and
+ *   sends them to the other shards, it also does the evaluation and writes
+ *   the checkpoints.
+ ******************************************************************************/
+
+std::vector<int> LatticeWordSegmentation::InitializeShards()
+{
+  std::cout << " Starting " << Params.NumShards
+            << " worker processes for sharded sampling" << std::endl;
+  Shards = std::unique_ptr<ShardGroup>(new ShardGroup(Params.NumShards));
+  if (Shards->IsCoordinator()) {
+    return std::vector<int>();
+  }
+
+  // the workers start with the same state, give each one its own seed
+  unsigned int Seed = static_cast<unsigned int>(
+    std::chrono::system_clock::now().time_since_epoch().count()) +
+    static_cast<unsigned int>(Shards->GetShardId());
+  RandomGenerator.seed(Seed);
+  HPYLM::SeedRandomGenerators(Seed + 1);
+  std::srand(Seed + 3);
+
+  // only the first shard writes the results
+  if (Shards->GetShardId() > 0) {
+    if (std::freopen("/dev/null", "w", stdout) == nullptr) {
+      throw std::runtime_error("Could not redirect the output of a shard");
+    }
+  }
+
+  std::vector<int> Indices;
+  for (std::size_t IdxSentence = Shards->GetShardId();
+       IdxSentence < NumSampledSentences; IdxSentence += Params.NumShards) {
+    Indices.push_back(IdxSentence);
+  }
+  return Indices;
+}
+
+void LatticeWordSegmentation::DoShardedWordSegmentationSentenceIterations(
+  const vector< int > &ShuffledIndices,
+  LexFst *LexiconTransducer,
+  std::size_t IdxIter
+)
+{
+  // all shards have to take part in the same number of exchanges
+  std::size_t MaxNumShardSentences =
+    (NumSampledSentences + Params.NumShards - 1) / Params.NumShards;
+  std::size_t NumBlocks =
+    (MaxNumShardSentences + Params.ShardSyncInterval - 1) /
+    Params.ShardSyncInterval;
+
+  for (std::size_t IdxBlock = 0; IdxBlock < NumBlocks; ++IdxBlock) {
+    std::size_t IdxBegin = std::min(IdxBlock * Params.ShardSyncInterval,
+                                    ShuffledIndices.size());
+    std::size_t IdxEnd = std::min(IdxBegin + Params.ShardSyncInterval,
+                                  ShuffledIndices.size());
+    DoWordSegmentationSentenceIterations(
+      ShuffledIndices, IdxBegin, IdxEnd, LexiconTransducer, IdxIter
+    );
+
+    // send the new segmentations and apply the ones of the other shards
+    Timer.tParseAndAdd.SetStart();
+    CheckpointWriter Writer;
+    WriteShardSentences(
+      std::vector<int>(ShuffledIndices.begin() + IdxBegin,
+                       ShuffledIndices.begin() + IdxEnd),
+      &Writer
+    );
+    std::vector<std::string> Messages = Shards->AllGather(Writer.GetPayload());
+    for (std::size_t IdxShard = 0; IdxShard < Messages.size(); ++IdxShard) {
+      if (IdxShard == Shards->GetShardId()) {
+        continue;
+      }
+      const std::string &Message = Messages[IdxShard];
+      CheckpointReader Reader(Message.data(), Message.data() + Message.size());
+      while (!Reader.AtEnd()) {
+        ReadShardSentences(&Reader, LexiconTransducer);
+      }
+    }
+    Timer.tParseAndAdd.AddTimeSinceStartToDuration();
+  }
+}
+
+void LatticeWordSegmentation::WriteShardSentences(
+  const vector< int > &Indices,
+  CheckpointWriter *Writer
+) const
+{
+  for (int CurrentIndex : Indices) {
+    const std::vector<int> &Sentence = SampledSentences[CurrentIndex];
+    Writer->Write<uint64_t>(CurrentIndex);
+    Writer->Write<uint64_t>(Sentence.size() - WHPYLMContextLength);
+    for (std::size_t IdxWord = WHPYLMContextLength; IdxWord < Sentence.size();
+         ++IdxWord) {
+      WordBeginLengthPair WordBeginLength =
+        LanguageModel->GetWordBeginLength(Sentence[IdxWord]);
+      Writer->WriteVector(std::vector<int>(
+        WordBeginLength.first, WordBeginLength.first + WordBeginLength.second));
+    }
+    Writer->WriteVector(TimedSampledSentences[CurrentIndex]);
+
+    // the input labels of the sampled path for the phoneme error rate
+    std::vector<int> InputLabels;
+    const LogVectorFst &SampledFst = SampledFsts[CurrentIndex];
+    for (int sid = SampledFst.Start(); sid != fst::kNoStateId;) {
+      fst::ArcIterator<LogVectorFst> ai(SampledFst, sid);
+      if (ai.Done()) {
+        break;
+      }
+      InputLabels.push_back(ai.Value().ilabel);
+      sid = ai.Value().nextstate;
+    }
+    Writer->WriteVector(InputLabels);
+  }
+}
+
+void LatticeWordSegmentation::ReadShardSentences(
+  CheckpointReader *Reader,
+  LexFst *LexiconTransducer
+)
+{
+  std::size_t CurrentIndex = Reader->Read<uint64_t>();
+  std::vector<std::vector<int> > Words(Reader->Read<uint64_t>());
+  for (std::vector<int> &Word : Words) {
+    Reader->ReadVector(&Word);
+  }
+  if (CurrentIndex >= NumSampledSentences) {
+    throw std::runtime_error("Shard sent segmentation of unknown sentence");
+  }
+
+  // remove the old segmentation
+  std::vector<int> &Sentence = SampledSentences[CurrentIndex];
+  if (CharacterLanguageModel != nullptr) {
+    ParseLib::RemoveWordSequenceFromAddCharLM(
+      Sentence.begin() + WHPYLMContextLength,
+      Sentence.size() - WHPYLMContextLength,
+      *LanguageModel,
+      CharacterLanguageModel
+    );
+  }
+  ParseLib::RemoveWordsFromDictionaryLexFSTAndLM(
+    Sentence.begin() + WHPYLMContextLength,
+    Sentence.size() - WHPYLMContextLength,
+    LanguageModel,
+    LexiconTransducer,
+    SentEndWordId
+  );
+
+  // add the new one with the local word ids
+  ParseLib::AddCharacterIdSequencesToDictionaryLexFstAndLM(
+    Words,
+    SentEndWordId,
+    LanguageModel,
+    LexiconTransducer,
+    &Sentence
+  );
+  if (CharacterLanguageModel != nullptr) {
+    ParseLib::AddWordSequenceToAddCharLM(
+      Sentence.begin() + WHPYLMContextLength,
+      Sentence.size() - WHPYLMContextLength,
+      *LanguageModel,
+      CharacterLanguageModel
+    );
+  }
+  std::vector<ArcInfo> &TimedSentence = TimedSampledSentences[CurrentIndex];
+  Reader->ReadVector(&TimedSentence);
+  for (std::size_t IdxWord = 0; IdxWord < TimedSentence.size(); ++IdxWord) {
+    TimedSentence[IdxWord].label = Sentence.at(WHPYLMContextLength + IdxWord);
+  }
+
+  // rebuild the sampled path from the input labels
+  std::vector<int> InputLabels;
+  Reader->ReadVector(&InputLabels);
+  LogVectorFst &SampledFst = SampledFsts[CurrentIndex];
+  SampledFst.DeleteStates();
+  SampledFst.SetStart(SampledFst.AddState());
+  for (int InputLabel : InputLabels) {
+    int NextState = SampledFst.AddState();
+    SampledFst.AddArc(NextState - 1, fst::LogArc(
+      InputLabel, 0, fst::LogArc::Weight::One(), NextState));
+  }
+  SampledFst.SetFinal(SampledFst.NumStates() - 1, fst::LogArc::Weight::One());
+}
+
+void LatticeWordSegmentation::ExchangeHyperParameters()
+{
+  CheckpointWriter Writer;
+  if (Shards->GetShardId() == 0) {
+    LanguageModel->WriteHyperParameters(&Writer);
+    if (CharacterLanguageModel != nullptr) {
+      CharacterLanguageModel->WriteHyperParameters(&Writer);
+    }
+  }
+  std::vector<std::string> Messages = Shards->AllGather(Writer.GetPayload());
+  if (Shards->GetShardId() == 0) {
+    return;
+  }
+
+  const std::string &Message = Messages.front();
+  CheckpointReader Reader(Message.data(), Message.data() + Message.size());
+  LanguageModel->ReadHyperParameters(&Reader);
+  if (CharacterLanguageModel != nullptr) {
+    CharacterLanguageModel->ReadHyperParameters(&Reader);
+  }
+}
+
+void LatticeWordSegmentation::WriteTrace() const
+{
+  if (Params.TraceFile.empty()) {
+    return;
+  }
+
+  // every shard has its own timers
+  std::string FileName = Params.TraceFile;
+  if (Shards != nullptr) {
+    FileName += "." + std::to_string(Shards->GetShardId());
+  }
+  std::cout << " Writing trace to " << FileName << std::endl;
+  Timer.WriteTrace(FileName);
+}
+
+void LatticeWordSegmentation::WriteTimingStatistics() const
+{
+  if (Params.TimingStatisticsFile.empty()) {
+    return;
+  }
+
+  // every shard has its own timers
+  std::string FileName = Params.TimingStatisticsFile;
+  if (Shards != nullptr) {
+    FileName += "." + std::to_string(Shards->GetShardId());
+  }
+  std::cout << " Writing timing statistics to " << FileName << std::endl;
+  Timer.WriteTimingStatistics(FileName);
+}
+
+void LatticeWordSegmentation::PrintMemoryUsage(
+  const LexFst *LexiconTransducer) const
+{
+  DebugLib::PrintLanguageModelMemoryUsage(*LanguageModel);
+  if (CharacterLanguageModel != nullptr) {
+    DebugLib::PrintLanguageModelMemoryUsage(*CharacterLanguageModel);
+  }
+
+  std::cout << " Transducer memory usage [kB]:";
+  if (LexiconTransducer != nullptr) {
+    std::cout << "\n  " << std::left << std::setw(22) << "Lexicon:"
+              << std::right << std::setw(8)
+              << DebugLib::GetFstMemoryUsage(*LexiconTransducer) / 1024;
+  }
+  std::size_t InputMemoryUsage = InputFileData.GetInputArcInfos().capacity() *
+                                 sizeof(ArcInfo);
+  for (const LogVectorFst &InputFst : InputFileData.GetInputFsts()) {
+    InputMemoryUsage += DebugLib::GetFstMemoryUsage(InputFst);
+  }
+  std::cout << "\n  " << std::left << std::setw(22) << "Input lattices:"
+            << std::right << std::setw(8) << InputMemoryUsage / 1024;
+  if (DecodingLanguageModelFST != nullptr) {
+    std::cout << "\n  " << std::left << std::setw(22) << "Decoding LM:"
+              << std::right << std::setw(8)
+              << DecodingLanguageModelFST->GetMemoryUsage() / 1024;
+  }
+  std::cout << std::endl;
+  DebugLib::PrintMemoryUsage("of process");
+  std::cout << std::endl;
+}
+
+void LatticeWordSegmentation::EvaluateIteration(std::size_t IdxIter)
+{
+  Evaluate Eval(
+    Params,
+    InputFileData,
+    Timer,
+    LanguageModel,
+    CharacterLanguageModel,
+    ReferenceWords.get()
+  );
+  if (Params.CostProfile) {
+    Eval.OutputCostProfile(CostProfiles, IdxIter);
+  }
+  if (!Params.AsyncEvaluation) {
+    Eval.WriteSentencesToOutputFiles(
+      *LanguageModel, SampledSentences, TimedSampledSentences, IdxIter
+    );
+    Eval.OutputMeasureStatistics(SampledSentences, SampledFsts, IdxIter);
+    return;
+  }
+
+  // the language model is changed by the next iteration, so everything that
+  // needs it is done now, the printed timings include the last evaluation
+  JoinEvaluationThread();
+  Eval.OutputPerplexity(SampledSentences);
+  Eval.OutputLanguageModelStatistics();
+
+  // score and write a snapshot of the results while sampling continues
+  EvaluationSnapshot Snapshot(
+    *LanguageModel,
+    SampledSentences,
+    TimedSampledSentences,
+    SampledFsts,
+    Params.CalculatePER && ((IdxIter % Params.EvalInterval) == 0),
+    IdxIter
+  );
+  EvaluationThread = std::thread(
+    [this](Evaluate Eval, const EvaluationSnapshot &Snapshot) {
+      // one thread next to the sampling threads, the report is buffered so
+      // that it does not interleave with the output of the sampling
+      std::ostringstream Report;
+      Report << "  Error rates of iteration " << Snapshot.IdxIter + 1 << ":"
+             << std::endl;
+      try {
+        Eval.WriteSentencesToOutputFiles(Snapshot.Dict,
+                                         Snapshot.SampledSentences,
+                                         Snapshot.TimedSampledSentences,
+                                         Snapshot.IdxIter);
+        Eval.OutputErrorRates(Snapshot.Dict, Snapshot.SampledSentences,
+                              Snapshot.SampledFsts, Snapshot.IdxIter, 1,
+                              Report);
+      } catch (...) {
+        // rethrown by the main thread when joining
+        EvaluationError = std::current_exception();
+      }
+      EvaluationReport = Report.str();
+    },
+    Eval, std::move(Snapshot)
+  );
+}
+
+void LatticeWordSegmentation::JoinEvaluationThread()
+{
+  if (EvaluationThread.joinable()) {
+    EvaluationThread.join();
+  }
+  std::cout << EvaluationReport;
+  EvaluationReport.clear();
+  if (EvaluationError) {
+    std::exception_ptr Error = EvaluationError;
+    EvaluationError = nullptr;
+    std::rethrow_exception(Error);
+  }
 }
 
 /***********************************************************
@@ -408,6 +1145,20 @@ void LatticeWordSegmentation::InitializeLanguageModel(
   }
   std::cout << "!" << std::endl << std::endl;
 
+  CreateLanguageModels(UnkN, KnownN, AddCharN);
+
+  if (Params.InitLM) {
+    ParseInitializationSentencesAndInitializeLanguageModel();
+    TrainLanguageModel(InitializationSentences, Params.InitLmNumIterations);
+  }
+}
+
+void LatticeWordSegmentation::CreateLanguageModels(
+  int UnkN,
+  int KnownN,
+  int AddCharN
+)
+{
   LanguageModel = new NHPYLM(UnkN, KnownN,
       InputFileData.GetInputIntToStringVector(), CHARACTERSBEGIN);
 
@@ -432,11 +1183,6 @@ void LatticeWordSegmentation::InitializeLanguageModel(
         InputFileData.GetInputIntToStringVector(), CHARACTERSBEGIN,
         1.0/(NumCharacters + 2));
   }
-
-  if (Params.InitLM) {
-    ParseInitializationSentencesAndInitializeLanguageModel();
-    TrainLanguageModel(InitializationSentences, Params.InitLmNumIterations);
-  }
 }
 
 void LatticeWordSegmentation::
@@ -494,7 +1240,8 @@ ParseInitializationSentencesAndInitializeLanguageModel()
   }
 
   // get perplexity
-  DebugLib::PrintSentencesPerplexity(InitializationSentences, *LanguageModel);
+  DebugLib::PrintSentencesPerplexity(InitializationSentences, *LanguageModel,
+                                     MaxNumThreads);
 
   // output some language model stats
   DebugLib::PrintLanguageModelStats(*LanguageModel);
@@ -503,6 +1250,17 @@ ParseInitializationSentencesAndInitializeLanguageModel()
   }
 }
 
+void LatticeWordSegmentation::InitializeReferenceWords()
+{
+  if (Params.CalculateWER) {
+    Timer.tCalcWER.SetStart();
+    ReferenceWords = std::unique_ptr<ReferenceWordSequences>(
+      new ReferenceWordSequences(InputFileData.GetReferenceFsts(),
+                                 *LanguageModel));
+    Timer.tCalcWER.AddTimeSinceStartToDuration();
+  }
+}
+
 void LatticeWordSegmentation::TrainLanguageModel(
   const vector< vector< int > > &Sentences,
   std::size_t MaxNumLMTrainIter
@@ -563,7 +1321,8 @@ void LatticeWordSegmentation::TrainLanguageModel(
     }
 
     // get perplexity
-    DebugLib::PrintSentencesPerplexity(Sentences, *LanguageModel);
+    DebugLib::PrintSentencesPerplexity(Sentences, *LanguageModel,
+                                       MaxNumThreads);
 
     // output some language model stats
     DebugLib::PrintLanguageModelStats(*LanguageModel);
@@ -576,8 +1335,10 @@ void LatticeWordSegmentation::TrainLanguageModel(
 
 void LatticeWordSegmentation::WriteRescoredLattices() {
 
+  // the fst keeps a reference to the active words
+  const std::vector<bool> AllCharactersActive;
   NHPYLMFst CharLMFst(*CharacterLanguageModel, EOW,
-      std::vector<bool>(), true, AvailChars);
+      AllCharactersActive, true, AvailChars);
 
   const auto kInputSize = InputFileData.GetInputFsts().size();
   for (std::size_t inputIdx = 0; inputIdx < kInputSize; inputIdx++) {
@@ -602,3 +1363,135 @@ void LatticeWordSegmentation::WriteRescoredLattices() {
                                   RescoredFilename);
   }
 }
+
+/***********************************************************
+ * Functions for checkpointing:
+ * - WriteCheckpoint
+ * - ReadCheckpoint
+************************************************************/
+
+void LatticeWordSegmentation::WriteCheckpoint(std::size_t NumFinishedIter)
+{
+  // serialize the complete state into memory
+  CheckpointWriter Writer;
+  Writer.Write<uint64_t>(NumFinishedIter);
+  Writer.Write<uint64_t>(NumSampledSentences);
+  Writer.Write<uint32_t>(LanguageModel->GetCHPYLMOrder());
+  Writer.Write<uint32_t>(LanguageModel->GetWHPYLMOrder());
+  Writer.Write<uint32_t>(CharacterLanguageModel != nullptr ?
+                         CharacterLanguageModel->GetWHPYLMOrder() : 0);
+  Writer.Write<uint64_t>(InputFileData.GetInputIntToStringVector().size());
+  for (const auto &Symbol : InputFileData.GetInputIntToStringVector()) {
+    Writer.WriteString(Symbol);
+  }
+  LanguageModel->WriteCheckpoint(&Writer);
+  if (CharacterLanguageModel != nullptr) {
+    CharacterLanguageModel->WriteCheckpoint(&Writer);
+  }
+  for (const auto &Sentence : SampledSentences) {
+    Writer.WriteVector(Sentence);
+  }
+  for (const auto &TimedSentence : TimedSampledSentences) {
+    Writer.WriteVector(TimedSentence);
+  }
+
+  std::cout << "  Writing checkpoint after iteration " << NumFinishedIter
+            << " (" << Writer.GetSize() / (1024 * 1024) << " MB) to "
+            << Params.CheckpointFile << std::endl << std::endl;
+
+  // write to disk while sampling continues, only one write at a time
+  JoinCheckpointThread();
+  CheckpointThread = std::thread(
+    [this](const CheckpointWriter &Writer, const std::string &FileName) {
+      try {
+        Writer.WriteToFile(FileName);
+      } catch (...) {
+        // rethrown by the main thread when joining
+        CheckpointError = std::current_exception();
+      }
+    },
+    std::move(Writer), Params.CheckpointFile
+  );
+}
+
+void LatticeWordSegmentation::JoinCheckpointThread()
+{
+  if (CheckpointThread.joinable()) {
+    CheckpointThread.join();
+  }
+  if (CheckpointError) {
+    std::exception_ptr Error = CheckpointError;
+    CheckpointError = nullptr;
+    std::rethrow_exception(Error);
+  }
+}
+
+std::size_t LatticeWordSegmentation::ReadCheckpoint(
+  const std::string &FileName
+)
+{
+  std::cout << " Resuming from checkpoint " << FileName << std::endl;
+
+  CheckpointReader Reader(FileName);
+  std::size_t NumFinishedIter = Reader.Read<uint64_t>();
+  if (Reader.Read<uint64_t>() != NumSampledSentences) {
+    throw std::runtime_error("Checkpoint " + FileName +
+                             " does not match number of input sentences");
+  }
+  std::cout << "  Restoring sampler state after iteration "
+            << NumFinishedIter << std::endl;
+  ReadLanguageModelsFromCheckpoint(&Reader, FileName);
+
+  SampledSentences.resize(NumSampledSentences);
+  for (auto &Sentence : SampledSentences) {
+    Reader.ReadVector(&Sentence);
+  }
+  TimedSampledSentences.resize(NumSampledSentences);
+  for (auto &TimedSentence : TimedSampledSentences) {
+    Reader.ReadVector(&TimedSentence);
+  }
+  if (!Reader.AtEnd()) {
+    throw std::runtime_error("Checkpoint " + FileName + " has trailing data");
+  }
+
+  return NumFinishedIter;
+}
+
+void LatticeWordSegmentation::ReadLanguageModelsFromCheckpoint(
+  CheckpointReader *Reader,
+  const std::string &FileName
+)
+{
+  int UnkN = Reader->Read<uint32_t>();
+  int KnownN = Reader->Read<uint32_t>();
+  int AddCharN = Reader->Read<uint32_t>();
+  std::cout << "  Restoring language model with KnownN=" << KnownN
+            << ", UnkN=" << UnkN;
+  if (AddCharN > 0) {
+    std::cout << ", AddCharN=" << AddCharN;
+  }
+  std::cout << "!" << std::endl << std::endl;
+
+  // the word ids refer to the symbols of the input the model was trained on
+  const std::vector<std::string> &Symbols =
+    InputFileData.GetInputIntToStringVector();
+  bool SymbolsMatch = (Reader->Read<uint64_t>() == Symbols.size());
+  for (std::size_t IdxSymbol = 0; SymbolsMatch && (IdxSymbol < Symbols.size());
+       ++IdxSymbol) {
+    SymbolsMatch = (Reader->ReadString() == Symbols[IdxSymbol]);
+  }
+  if (!SymbolsMatch) {
+    throw std::runtime_error("Checkpoint " + FileName + " does not match the " +
+                             "input symbols, use the symbols of the training " +
+                             "data with -SymbolFile");
+  }
+
+  // construct empty models with the stored orders and replace their state
+  CreateLanguageModels(UnkN, KnownN, AddCharN);
+  LanguageModel->ReadCheckpoint(Reader);
+  SentEndWordId = LanguageModel->GetWordId(
+      std::vector<int>(1, SENTEND_SYMBOLID).begin(), 1);
+  if (CharacterLanguageModel != nullptr) {
+    CharacterLanguageModel->ReadCheckpoint(Reader);
+  }
+}
@@ -61,11 +61,19 @@
 #define _LATTICEWORDSEGEMNTATION_HPP_
 
 #include <thread>
+#include <exception>
+#include <memory>
+#include <functional>
 #include "ParameterParser/ParameterParser.hpp"
 #include "FileReader/FileData.hpp"
 #include "NHPYLM/NHPYLM.hpp"
 #include "LatticeWordSegmentationTimer.hpp"
 #include "LexFst.hpp"
+#include "NHPYLMFst.hpp"
+#include "SegmentationServer.hpp"
+#include "ShardGroup.hpp"
+#include "CostProfile.hpp"
+#include "EditDistanceCalculator/WERCalculator.hpp"
 
 /* main class for the word segmentation */
 class LatticeWordSegmentation {
@@ -80,6 +88,11 @@ class LatticeWordSegmentation {
   const std::size_t MaxNumThreads;    // Maximum number of thread to be used
   std::vector<std::thread> Threads;   // the thread objects
   LatticeWordSegmentationTimer Timer; // object to do some timing
+  std::thread CheckpointThread;       // thread writing the last checkpoint
+  std::exception_ptr CheckpointError; // exception thrown by the checkpoint thread
+  std::thread EvaluationThread;       // thread evaluating the last iteration (-AsyncEvaluation)
+  std::exception_ptr EvaluationError; // exception thrown by the evaluation thread
+  std::string EvaluationReport;       // error rates printed by the main thread after joining the evaluation thread
 
   /* language model and dictionary */
   NHPYLM *LanguageModel;           // the language model
@@ -90,11 +103,27 @@ class LatticeWordSegmentation {
   NHPYLM *CharacterLanguageModel; // the character language model
   std::vector<int> AvailChars; // vector containing availabe character ids
 
+  /* decoding with a frozen language model */
+  const std::vector<bool> AllWordsActive;                        // empty, all words are active
+  std::unique_ptr<LexFst> DecodingLexiconTransducer;             // lexicon transducer of the model words
+  std::unique_ptr<NHPYLMFst> DecodingLanguageModelFST;           // language model fst shared by all threads
+  std::unique_ptr<NHPYLMFst> DecodingCharacterLanguageModelFST;  // character language model fst shared by all threads (optional)
+
+  /* candidate words of the input lattices */
+  std::unique_ptr<LatticeWordIndex> CandidateIndex; // index of candidate words per input lattice (optional)
+
+  /* evaluation data */
+  std::unique_ptr<ReferenceWordSequences> ReferenceWords; // reference sentences parsed once for the WER calculation (optional)
+
+  /* sharded sampling */
+  std::unique_ptr<ShardGroup> Shards; // worker processes sampling disjoint parts of the sentences (optional)
+
   /* sampling data */
   std::size_t NumSampledSentences;                          // number of sentences in input
   std::vector<LogVectorFst > SampledFsts;                   // the sampled fsts
   std::vector<std::vector<int> > SampledSentences;          // the segmented sentences (parsed samples)
   std::vector<std::vector<ArcInfo> > TimedSampledSentences; // the segmented sentences (parsed samples with start/end times on word basis)
+  std::vector<SentenceCostProfile> CostProfiles;            // costs of sampling the sentences in the last iteration (-CostProfile)
 
   /* init data */
   std::size_t NumInitializationSentences;                 // number of sentences for initialization
@@ -109,6 +138,16 @@ class LatticeWordSegmentation {
     int AddCharN
   );
 
+  // create empty language models of given orders
+  void CreateLanguageModels(
+    int UnkN,
+    int KnownN,
+    int AddCharN
+  );
+
+  // parse the reference sentences for the word error rate calculation
+  void InitializeReferenceWords();
+
   // initialize with initiliazation fsts
   void ParseInitializationSentencesAndInitializeLanguageModel();
 
@@ -118,13 +157,65 @@ class LatticeWordSegmentation {
     std::size_t MaxNumLMTrainIter
   );
 
-  // iterate over sentences
+  // iterate over the sentences ShuffledIndices[IdxBegin, IdxEnd)
   void DoWordSegmentationSentenceIterations(
+    const std::vector< int > &ShuffledIndices,
+    std::size_t IdxBegin,
+    std::size_t IdxEnd,
+    LexFst *LexiconTransducer,
+    std::size_t IdxIter
+  );
+
+  // fork the worker processes of the sharded sampling, returns the indices
+  // of the sentences sampled by this worker (nothing in the coordinator)
+  std::vector<int> InitializeShards();
+
+  // iterate over the sentences of this shard in blocks and exchange the
+  // segmentations with the other shards after every block
+  void DoShardedWordSegmentationSentenceIterations(
     const std::vector< int > &ShuffledIndices,
     LexFst *LexiconTransducer,
     std::size_t IdxIter
   );
 
+  // write the segmentations of the given sentences for the other shards,
+  // words are written as character sequences since word ids are process local
+  void WriteShardSentences(
+    const std::vector< int > &Indices,
+    CheckpointWriter *Writer
+  ) const;
+
+  // replace the segmentations of the sentences by the ones of another shard
+  void ReadShardSentences(
+    CheckpointReader *Reader,
+    LexFst *LexiconTransducer
+  );
+
+  // use the hyper parameters of the first shard in all shards
+  void ExchangeHyperParameters();
+
+  // write the recorded timeline of the timers, if requested
+  void WriteTrace() const;
+
+  // write the accumulated timer durations as csv, if requested
+  void WriteTimingStatistics() const;
+
+  // print bytes of the language models, the lexicon transducer (optional),
+  // the input lattices and the decoding fst and the resident set size
+  void PrintMemoryUsage(
+    const LexFst *LexiconTransducer
+  ) const;
+
+  // write the results and statistics of an iteration, with -AsyncEvaluation
+  // the error rates and the output files are done in the background
+  void EvaluateIteration(
+    std::size_t IdxIter
+  );
+
+  // wait for the background evaluation, print its report and rethrow its
+  // exception
+  void JoinEvaluationThread();
+
   // switch to a new language  model order
   void SwitchLanguageModelOrders(
     int NewUnkN,
@@ -132,6 +223,55 @@ class LatticeWordSegmentation {
     int NewAddCharN
   );
 
+  // capture the sampler state and write it to the checkpoint file in the
+  // background
+  void WriteCheckpoint(
+    std::size_t NumFinishedIter
+  );
+
+  // wait for the background checkpoint write and rethrow its exception
+  void JoinCheckpointThread();
+
+  // restore the sampler state from a checkpoint file,
+  // returns the number of finished iterations
+  std::size_t ReadCheckpoint(
+    const std::string &FileName
+  );
+
+  // load and freeze the language models from a checkpoint and build the fsts
+  // shared by all decoding threads
+  void InitializeDecoding(
+    const std::string &FileName
+  );
+
+  // call Fn(IdxItem, IdxThread) for every item in [0, NumItems), the items are
+  // handed out to the threads dynamically
+  void ParallelForEach(
+    std::size_t NumItems,
+    const std::function<void(std::size_t, std::size_t)> &Fn
+  );
+
+  // segment a lattice with the frozen language models (thread safe)
+  void DecodeLattice(
+    const LogVectorFst &InputFst,
+    std::size_t IdxThread,
+    LogVectorFst *SampledFst
+  );
+
+  // read and segment the lattices of a batch of server requests
+  void DecodeRequests(
+    const StringToIntMapper &Symbols,
+    const std::vector<bool> &IsModelWord,
+    std::vector<SegmentationRequest> *Requests
+  );
+
+  // construct the language models from the checkpoint, the input symbols
+  // have to match the symbols of the checkpoint
+  void ReadLanguageModelsFromCheckpoint(
+    CheckpointReader *Reader,
+    const std::string &FileName
+  );
+
     void WriteRescoredLattices();
 public:
   /* constructor */
@@ -142,8 +282,16 @@ public:
 
 
   /* interface */
-  // run the actual word segmentation iterations
-  void DoWordSegmentation();
+  // run the actual word segmentation iterations, returns false in the worker
+  // processes of sharded sampling, which have to end after it
+  bool DoWordSegmentation();
+
+  // segment the input once with the frozen language model from a checkpoint
+  void DoDecoding();
+
+  // answer segmentation requests with the frozen language model from a
+  // checkpoint until a client stops the server
+  void Serve();
 };
 
 #endif
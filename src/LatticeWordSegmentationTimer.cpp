@@ -43,26 +43,91 @@
 // ----------------------------------------------------------------------------
 #include <iostream>
 #include <iomanip>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
 #include "LatticeWordSegmentationTimer.hpp"
 
+namespace {
+
+// names of the timers of the sampling threads
+const char *InSampleNames[] = {
+  "Compose input and lexicon", "Build language model fst",
+  "Compose with language model", "Sample path", "Character language model"
+};
+
+// print one row of the hardware counter table, n/a for unavailable counters
+void PrintCounters(const std::string &Name, const PerfCounterValues &Counters)
+{
+  std::cout << "  " << std::left << std::setw(40) << Name << std::right;
+  for (int Counter = 0; Counter < PerfCounterValues::NUM_COUNTERS; ++Counter) {
+    if (Counters.IsValid(Counter)) {
+      std::cout << std::setw(16) << Counters.Values[Counter];
+    } else {
+      std::cout << std::setw(16) << "n/a";
+    }
+  }
+  if (Counters.IsValid(PerfCounterValues::CYCLES) &&
+      Counters.IsValid(PerfCounterValues::INSTRUCTIONS) &&
+      (Counters.Values[PerfCounterValues::CYCLES] > 0)) {
+    std::cout << std::setw(8) << std::setprecision(2)
+              << static_cast<double>(Counters.Values[PerfCounterValues::INSTRUCTIONS]) /
+                 Counters.Values[PerfCounterValues::CYCLES];
+  } else {
+    std::cout << std::setw(8) << "n/a";
+  }
+  std::cout << "\n";
+}
+
+// csv fields of the hardware counters, empty for unavailable counters
+void WriteCounters(std::ostream &Out, const PerfCounterValues &Counters)
+{
+  for (int Counter = 0; Counter < PerfCounterValues::NUM_COUNTERS; ++Counter) {
+    Out << ",";
+    if (Counters.IsValid(Counter)) {
+      Out << Counters.Values[Counter];
+    }
+  }
+  Out << "\n";
+}
+
+}
+
 LatticeWordSegmentationTimer::LatticeWordSegmentationTimer(int MaxNumThreads, int NumTimersPerThread) :
-  tInSamples(MaxNumThreads, std::vector<SimpleTimer>(NumTimersPerThread))
+  tInSamples(MaxNumThreads, std::vector<SimpleTimer>(NumTimersPerThread)),
+  tSentences(MaxNumThreads),
+  EvaluationLane(0)
 {
 }
 
 LatticeWordSegmentationTimer::SimpleTimer::SimpleTimer() :
-  Duration(0)
+  Duration(0),
+  TraceName(nullptr),
+  TraceLane(0),
+  NumTraceEvents(0)
 {
 }
 
 void LatticeWordSegmentationTimer::SimpleTimer::SetStart()
 {
+  if (!PerfCounters::Read(&StartCounters)) {
+    StartCounters.Valid = 0;
+  }
   Start = std::chrono::high_resolution_clock::now();
 }
 
-void LatticeWordSegmentationTimer::SimpleTimer::AddTimeSinceStartToDuration()
+void LatticeWordSegmentationTimer::SimpleTimer::AddTimeSinceStartToDuration(long long Arg)
 {
-  Duration += std::chrono::duration_cast<std::chrono::duration<double> >(std::chrono::high_resolution_clock::now() - Start);
+  std::chrono::high_resolution_clock::time_point End = std::chrono::high_resolution_clock::now();
+  Duration += std::chrono::duration_cast<std::chrono::duration<double> >(End - Start);
+  PerfCounterValues EndCounters;
+  if (PerfCounters::Read(&EndCounters)) {
+    Counters.AddDifference(StartCounters, EndCounters);
+  }
+  if (!TraceEvents.empty()) {
+    TraceEvents[NumTraceEvents++ % TraceEvents.size()] = {Start, End, Arg};
+  }
 }
 
 double LatticeWordSegmentationTimer::SimpleTimer::GetDuration() const
@@ -70,6 +135,35 @@ double LatticeWordSegmentationTimer::SimpleTimer::GetDuration() const
   return Duration.count();
 }
 
+const PerfCounterValues &LatticeWordSegmentationTimer::SimpleTimer::GetCounters() const
+{
+  return Counters;
+}
+
+void LatticeWordSegmentationTimer::SimpleTimer::EnableTrace(const char *Name, int Lane, std::size_t Capacity)
+{
+  TraceName = Name;
+  TraceLane = Lane;
+  TraceEvents.resize(Capacity);
+  NumTraceEvents = 0;
+}
+
+void LatticeWordSegmentationTimer::SimpleTimer::WriteTraceEvents(std::ostream &Out, std::chrono::high_resolution_clock::time_point Origin) const
+{
+  // times in microseconds since the origin, complete events ("X")
+  std::size_t NumEvents = std::min(NumTraceEvents, TraceEvents.size());
+  for (std::size_t IdxEvent = 0; IdxEvent < NumEvents; ++IdxEvent) {
+    const TraceEvent &Event = TraceEvents[IdxEvent];
+    Out << ",\n{\"name\":\"" << TraceName << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << TraceLane
+        << ",\"ts\":" << std::chrono::duration<double, std::micro>(Event.Start - Origin).count()
+        << ",\"dur\":" << std::chrono::duration<double, std::micro>(Event.End - Event.Start).count();
+    if (Event.Arg >= 0) {
+      Out << ",\"args\":{\"sentence\":" << Event.Arg << "}";
+    }
+    Out << "}";
+  }
+}
+
 void LatticeWordSegmentationTimer::PrintTimingStatistics() const
 {
   // output some timing statistics
@@ -91,4 +185,129 @@ void LatticeWordSegmentationTimer::PrintTimingStatistics() const
             << " Perplexity calc.:   " << std::right << std::setw(8) << tCalcPerplexity.GetDuration() << " s\n"
             << " WER calculation:    " << std::right << std::setw(8) << tCalcWER.GetDuration() << " s\n"
             << " PER calculation:    " << std::right << std::setw(8) << tCalcPER.GetDuration() << " s\n\n";
+
+  // hardware counters of the thread running the timed interval, the
+  // main thread timers do not include the sampling threads
+  if (PerfCounters::IsEnabled()) {
+    std::cout << std::left << std::setw(42) << " Hardware counters:" << std::right;
+    for (int Counter = 0; Counter < PerfCounterValues::NUM_COUNTERS; ++Counter) {
+      std::cout << std::setw(16) << PerfCounters::GetName(Counter);
+    }
+    std::cout << std::setw(8) << "ipc" << "\n";
+    PrintCounters("Build LexFST", tLexFst.GetCounters());
+    PrintCounters("Removing", tRemove.GetCounters());
+    PrintCounters("Sampling", tSample.GetCounters());
+    PrintCounters("Parsing and adding", tParseAndAdd.GetCounters());
+    PrintCounters("Parameter sampling", tHypSample.GetCounters());
+    PrintCounters("Perplexity calculation", tCalcPerplexity.GetCounters());
+    PrintCounters("WER calculation", tCalcWER.GetCounters());
+    PrintCounters("PER calculation", tCalcPER.GetCounters());
+    for (std::size_t IdxThread = 0; IdxThread < tInSamples.size(); ++IdxThread) {
+      std::string Thread = "Thread[" + std::to_string(IdxThread) + "] ";
+      for (std::size_t IdxTimer = 0; IdxTimer < tInSamples[IdxThread].size(); ++IdxTimer) {
+        PrintCounters(Thread + InSampleNames[IdxTimer], tInSamples[IdxThread][IdxTimer].GetCounters());
+      }
+      PrintCounters(Thread + "Sentence", tSentences[IdxThread].GetCounters());
+    }
+    std::cout << std::setprecision(4) << std::endl;
+  }
+}
+
+bool LatticeWordSegmentationTimer::EnableCounters()
+{
+  return PerfCounters::Enable();
+}
+
+void LatticeWordSegmentationTimer::EnableTrace(std::size_t Capacity, bool SeparateEvaluationLane)
+{
+  // lane 0: main thread, 1..N: sampling threads, N + 1: background evaluation
+  EvaluationLane = SeparateEvaluationLane ? tInSamples.size() + 1 : 0;
+  TraceOrigin = std::chrono::high_resolution_clock::now();
+  tLexFst.EnableTrace("Build LexFST", 0, Capacity);
+  tRemove.EnableTrace("Removing", 0, Capacity);
+  tSample.EnableTrace("Sampling", 0, Capacity);
+  tParseAndAdd.EnableTrace("Parsing and adding", 0, Capacity);
+  tHypSample.EnableTrace("Parameter sampling", 0, Capacity);
+  tCalcWER.EnableTrace("WER calculation", EvaluationLane, Capacity);
+  tCalcPerplexity.EnableTrace("Perplexity calculation", 0, Capacity);
+  tCalcPER.EnableTrace("PER calculation", EvaluationLane, Capacity);
+  for (std::size_t IdxThread = 0; IdxThread < tInSamples.size(); ++IdxThread) {
+    for (std::size_t IdxTimer = 0; IdxTimer < tInSamples[IdxThread].size(); ++IdxTimer) {
+      tInSamples[IdxThread][IdxTimer].EnableTrace(InSampleNames[IdxTimer], IdxThread + 1, Capacity);
+    }
+    tSentences[IdxThread].EnableTrace("Sentence", IdxThread + 1, Capacity);
+  }
+}
+
+void LatticeWordSegmentationTimer::WriteTrace(const std::string &FileName) const
+{
+  std::ofstream Out(FileName);
+  if (!Out) {
+    throw std::runtime_error("Could not open trace file " + FileName);
+  }
+
+  // name the lanes
+  Out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+      << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Main\"}}";
+  if (EvaluationLane != 0) {
+    Out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << EvaluationLane
+        << ",\"args\":{\"name\":\"Evaluation\"}}";
+  }
+  for (std::size_t IdxThread = 0; IdxThread < tInSamples.size(); ++IdxThread) {
+    Out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << IdxThread + 1
+        << ",\"args\":{\"name\":\"Thread[" << IdxThread << "]\"}}";
+  }
+
+  Out << std::fixed << std::setprecision(3);
+  for (const SimpleTimer *t : {&tLexFst, &tRemove, &tSample, &tParseAndAdd, &tHypSample, &tCalcWER, &tCalcPerplexity, &tCalcPER}) {
+    t->WriteTraceEvents(Out, TraceOrigin);
+  }
+  for (std::size_t IdxThread = 0; IdxThread < tInSamples.size(); ++IdxThread) {
+    for (const auto &t : tInSamples[IdxThread]) {
+      t.WriteTraceEvents(Out, TraceOrigin);
+    }
+    tSentences[IdxThread].WriteTraceEvents(Out, TraceOrigin);
+  }
+  Out << "\n]}\n";
+  if (!Out) {
+    throw std::runtime_error("Could not write trace file " + FileName);
+  }
+}
+
+void LatticeWordSegmentationTimer::WriteTimingStatistics(const std::string &FileName) const
+{
+  std::ofstream Out(FileName);
+  if (!Out) {
+    throw std::runtime_error("Could not open timing statistics file " + FileName);
+  }
+
+  // timers of the main thread have no thread index
+  // the hardware counter fields are empty if the counters are unavailable
+  Out << "timer,thread,seconds";
+  for (int Counter = 0; Counter < PerfCounterValues::NUM_COUNTERS; ++Counter) {
+    Out << "," << PerfCounters::GetName(Counter);
+  }
+  Out << "\n" << std::fixed << std::setprecision(6);
+  const std::pair<const char *, const SimpleTimer *> MainTimers[] = {
+    {"Build LexFST", &tLexFst}, {"Removing", &tRemove}, {"Sampling", &tSample},
+    {"Parsing and adding", &tParseAndAdd}, {"Parameter sampling", &tHypSample},
+    {"Perplexity calculation", &tCalcPerplexity}, {"WER calculation", &tCalcWER},
+    {"PER calculation", &tCalcPER}
+  };
+  for (const auto &t : MainTimers) {
+    Out << t.first << ",," << t.second->GetDuration();
+    WriteCounters(Out, t.second->GetCounters());
+  }
+  for (std::size_t IdxThread = 0; IdxThread < tInSamples.size(); ++IdxThread) {
+    for (std::size_t IdxTimer = 0; IdxTimer < tInSamples[IdxThread].size(); ++IdxTimer) {
+      Out << InSampleNames[IdxTimer] << "," << IdxThread << ","
+          << tInSamples[IdxThread][IdxTimer].GetDuration();
+      WriteCounters(Out, tInSamples[IdxThread][IdxTimer].GetCounters());
+    }
+    Out << "Sentence," << IdxThread << "," << tSentences[IdxThread].GetDuration();
+    WriteCounters(Out, tSentences[IdxThread].GetCounters());
+  }
+  if (!Out) {
+    throw std::runtime_error("Could not write timing statistics file " + FileName);
+  }
 }
@@ -62,20 +62,39 @@
 
 #include <chrono>
 #include <vector>
+#include <string>
+#include <ostream>
+#include "PerfCounters.hpp"
 
 /* class to hold some timing information */
 class LatticeWordSegmentationTimer {
 public:
+  /* one timed interval for the trace */
+  struct TraceEvent {
+    std::chrono::high_resolution_clock::time_point Start; // start of the interval
+    std::chrono::high_resolution_clock::time_point End;   // end of the interval
+    long long Arg;                                        // sentence index or -1
+  };
+
   /* class for a simple timer */
   class SimpleTimer {
     std::chrono::high_resolution_clock::time_point Start; // starting pint of timer
     std::chrono::duration<double> Duration;               // duration spend for the timer
+    const char *TraceName;                                // name of the intervals in the trace
+    int TraceLane;                                        // lane (thread) of the intervals in the trace
+    std::vector<TraceEvent> TraceEvents;                  // ring buffer with the last intervals, empty if tracing is off
+    std::size_t NumTraceEvents;                           // number of intervals recorded so far
+    PerfCounterValues StartCounters;                      // hardware counters of the thread at the starting point
+    PerfCounterValues Counters;                           // hardware counters accumulated over the intervals
 
   public:
-    SimpleTimer();                      // initialize the simple timeing objects (set duration to zero)
-    void SetStart();                    // set starting point of timer
-    void AddTimeSinceStartToDuration(); // add elapsed time from starting pint to duration
-    double GetDuration() const;         // return duration
+    SimpleTimer();                                          // initialize the simple timeing objects (set duration to zero)
+    void SetStart();                                        // set starting point of timer
+    void AddTimeSinceStartToDuration(long long Arg = -1);   // add elapsed time from starting pint to duration (and record interval if tracing)
+    double GetDuration() const;                             // return duration
+    const PerfCounterValues &GetCounters() const;           // return accumulated hardware counters (if enabled)
+    void EnableTrace(const char *Name, int Lane, std::size_t Capacity); // record the last Capacity intervals
+    void WriteTraceEvents(std::ostream &Out, std::chrono::high_resolution_clock::time_point Origin) const; // write recorded intervals as trace events
   };
 
 
@@ -89,6 +108,7 @@ public:
   SimpleTimer tCalcPerplexity; // time for calculating the perplexity
   SimpleTimer tCalcPER;        // time for calculating the phoneme error rate
   std::vector<std::vector<SimpleTimer> > tInSamples; // times for the different tasks in the sampling threads
+  std::vector<SimpleTimer> tSentences;               // times for complete sentences in the sampling threads
 
 
   /* constructor */
@@ -100,8 +120,37 @@ public:
 
 
   /* interface */
-  // print the statistics
+  // print the statistics (and the hardware counters, if enabled)
   void PrintTimingStatistics() const; 
+
+  // count cycles, instructions, cache and branch misses of the calling
+  // thread in every timed interval, returns false if the counters are not
+  // available
+  bool EnableCounters();
+
+  // record the last Capacity intervals of every timer for the trace, the
+  // error rate calculation gets its own lane if it runs in the background
+  void EnableTrace(
+    std::size_t Capacity,
+    bool SeparateEvaluationLane
+  );
+
+  // write the recorded intervals as trace event json (chrome://tracing,
+  // Perfetto), one lane for the main thread, one per sampling thread and one
+  // for the background evaluation
+  void WriteTrace(
+    const std::string &FileName
+  ) const;
+
+  // write the accumulated durations of all timers as csv
+  // (timer,thread,seconds), the thread is empty for the main thread timers
+  void WriteTimingStatistics(
+    const std::string &FileName
+  ) const;
+
+private:
+  std::chrono::high_resolution_clock::time_point TraceOrigin; // time of EnableTrace
+  int EvaluationLane;                                         // lane of the error rate calculation, 0 (main thread) if not in the background
 };
 
 #endif
\ No newline at end of file
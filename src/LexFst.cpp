@@ -54,7 +54,8 @@ LexFst::LexFst(bool Debug_, const vector< string > &Symbols_, int CharactersBegi
   Symbols(Symbols_),
   CharactersBegin(CharactersBegin_),
   CharactersEnd(Symbols.size()),
-  CharacterSequenceProbabilityScale(CharacterSequenceProbabilityScale_)
+  CharacterSequenceProbabilityScale(CharacterSequenceProbabilityScale_),
+  CandidateIndex(nullptr)
 {
   initializeArcs();
 }
@@ -91,6 +92,12 @@ void LexFst::initializeArcs()
 }
 
 
+void LexFst::SetCandidateIndex(LatticeWordIndex *CandidateIndex_)
+{
+  CandidateIndex = CandidateIndex_;
+}
+
+
 void LexFst::BuildLexiconTansducer(const Word2IdHashmap &Word2Id)
 {
   for (Word2IdHashmap::const_iterator it = Word2Id.begin(); it != Word2Id.end(); ++it) {
@@ -110,6 +117,10 @@ void LexFst::addWord(std::vector< int >::const_iterator WordBegin, int WordLengt
     return;
   }
 
+  if (CandidateIndex != nullptr) {
+    CandidateIndex->AddWord(WordBegin, WordLength, WordId);
+  }
+
   // Add the word to the transducer
   // cout << "Add to transducer" << endl;
   int curState = Start();
@@ -302,6 +313,10 @@ void LexFst::rmWord(std::vector< int >::const_iterator WordBegin, int WordLength
     cout << endl;
   }
 
+  if (CandidateIndex != nullptr) {
+    CandidateIndex->RemoveWord(WordBegin, WordLength);
+  }
+
   //Remove from Transducer
   int curState = Start();
   // Determine the last state with a branch
@@ -62,6 +62,7 @@
 
 #include <fst/vector-fst.h>
 #include "definitions.hpp"
+#include "LatticeWordIndex.hpp"
 
 /* class for lexicon fst */
 class LexFst : public fst::VectorFst<fst::LogArc> {
@@ -74,6 +75,7 @@ class LexFst : public fst::VectorFst<fst::LogArc> {
   StateId HomeState;                      // home state of fst
   StateId UnkState;                       // state for unknown sequences
   std::vector<double> CharacterSequenceProbabilityScale; // weights for character sequence probability scaling
+  LatticeWordIndex *CandidateIndex;       // index of candidate words per lattice, kept in sync with the lexicon (optional)
 
 
   /* internal functions */
@@ -118,6 +120,11 @@ public:
   
   // initialize arcs
   void initializeArcs();
+
+  // set index which is updated on every added or removed word
+  void SetCandidateIndex(
+    LatticeWordIndex *CandidateIndex_
+  );
   
   // add word to lexicon fst
   void addWord(
@@ -0,0 +1,192 @@
+// ----------------------------------------------------------------------------
+/**
+   File: Checkpoint.cpp
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+*/
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Checkpoint.hpp"
+
+namespace {
+
+/* header at the beginning of a checkpoint file */
+struct CheckpointHeader {
+  char Magic[8];
+  uint32_t Version;
+  uint32_t Reserved;
+  uint64_t PayloadSize;
+};
+
+const char kCheckpointMagic[8] = {'L', 'W', 'S', 'C', 'K', 'P', 'T', '\0'};
+const uint32_t kCheckpointVersion = 2;
+
+} // namespace
+
+
+void CheckpointWriter::WriteString(const std::string &Value)
+{
+  Write<uint64_t>(Value.size());
+  Buffer.append(Value);
+}
+
+
+void CheckpointWriter::WriteToFile(const std::string &FileName) const
+{
+  CheckpointHeader Header;
+  std::memcpy(Header.Magic, kCheckpointMagic, sizeof(Header.Magic));
+  Header.Version = kCheckpointVersion;
+  Header.Reserved = 0;
+  Header.PayloadSize = Buffer.size();
+
+  std::string TempFileName = FileName + ".tmp";
+  std::ofstream Out(TempFileName, std::ios::binary);
+  Out.write(reinterpret_cast<const char *>(&Header), sizeof(Header));
+  Out.write(Buffer.data(), Buffer.size());
+  Out.close();
+  if (!Out || (std::rename(TempFileName.c_str(), FileName.c_str()) != 0)) {
+    std::ostringstream err;
+    err << "Could not write checkpoint file " << FileName << std::endl;
+    throw std::runtime_error(err.str());
+  }
+}
+
+
+std::size_t CheckpointWriter::GetSize() const
+{
+  return Buffer.size();
+}
+
+
+const std::string &CheckpointWriter::GetPayload() const
+{
+  return Buffer;
+}
+
+
+CheckpointReader::CheckpointReader(const std::string &FileName) :
+  Mapping(MAP_FAILED),
+  MappingSize(0),
+  Pos(nullptr),
+  End(nullptr)
+{
+  // map the whole file read only
+  int FileDescriptor = open(FileName.c_str(), O_RDONLY);
+  struct stat FileStatus;
+  if ((FileDescriptor < 0) || (fstat(FileDescriptor, &FileStatus) != 0)) {
+    if (FileDescriptor >= 0) {
+      close(FileDescriptor);
+    }
+    std::ostringstream err;
+    err << "Could not open checkpoint file " << FileName << std::endl;
+    throw std::runtime_error(err.str());
+  }
+  MappingSize = FileStatus.st_size;
+  if (MappingSize >= sizeof(CheckpointHeader)) {
+    Mapping = mmap(nullptr, MappingSize, PROT_READ, MAP_PRIVATE,
+                   FileDescriptor, 0);
+  }
+  close(FileDescriptor);
+  if (Mapping == MAP_FAILED) {
+    std::ostringstream err;
+    err << "Could not map checkpoint file " << FileName << std::endl;
+    throw std::runtime_error(err.str());
+  }
+
+  const char *Data = static_cast<const char *>(Mapping);
+  CheckpointHeader Header;
+  std::memcpy(&Header, Data, sizeof(Header));
+  if ((std::memcmp(Header.Magic, kCheckpointMagic, sizeof(Header.Magic)) != 0) ||
+      (Header.Version != kCheckpointVersion) ||
+      (Header.PayloadSize != MappingSize - sizeof(Header))) {
+    munmap(Mapping, MappingSize);
+    std::ostringstream err;
+    err << "File " << FileName << " is not a complete checkpoint of version "
+        << kCheckpointVersion << std::endl;
+    throw std::runtime_error(err.str());
+  }
+  Pos = Data + sizeof(Header);
+  End = Data + MappingSize;
+}
+
+
+CheckpointReader::CheckpointReader(const char *Begin, const char *End) :
+  Mapping(MAP_FAILED),
+  MappingSize(0),
+  Pos(Begin),
+  End(End)
+{
+}
+
+
+CheckpointReader::~CheckpointReader()
+{
+  if (Mapping != MAP_FAILED) {
+    munmap(Mapping, MappingSize);
+  }
+}
+
+
+void CheckpointReader::CheckAvailable(std::size_t Size) const
+{
+  if (static_cast<std::size_t>(End - Pos) < Size) {
+    throw std::runtime_error("Unexpected end of checkpoint file");
+  }
+}
+
+
+std::string CheckpointReader::ReadString()
+{
+  uint64_t Size = Read<uint64_t>();
+  CheckAvailable(Size);
+  std::string Value(Pos, Size);
+  Pos += Size;
+  return Value;
+}
+
+
+bool CheckpointReader::AtEnd() const
+{
+  return Pos == End;
+}
@@ -0,0 +1,175 @@
+// ----------------------------------------------------------------------------
+/**
+   File: Checkpoint.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+
+   E-Mail: agent@local
+
+   Description: binary checkpoint writer and reader for the sampler state
+
+   Limitations: checkpoints are written in native byte order
+
+   Change History:
+   Date         Author       Description
+   2026-10-19   agent        Initial
+*/
+// ----------------------------------------------------------------------------
+#ifndef _CHECKPOINT_HPP_
+#define _CHECKPOINT_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/* Versioned binary checkpoint of the sampler state. The writer serializes
+   into a memory buffer, so the state can be captured quickly between two
+   iterations and written to disk in the background. The reader maps the
+   file and deserializes directly from the mapping. Layout:
+     Header (magic, version, payload size)
+     payload (sequence of plain values, vectors and strings written by the
+              classes holding the state) */
+class CheckpointWriter {
+  std::string Buffer; // serialized payload
+
+public:
+  /* interface */
+  // append plain value (trivially copyable)
+  template<typename T>
+  void Write(const T &Value) {
+    Buffer.append(reinterpret_cast<const char *>(&Value), sizeof(T));
+  }
+
+  // append vector of plain values with its size
+  template<typename T>
+  void WriteVector(const std::vector<T> &Values) {
+    Write<uint64_t>(Values.size());
+    if (!Values.empty()) {
+      Buffer.append(reinterpret_cast<const char *>(Values.data()),
+                    Values.size() * sizeof(T));
+    }
+  }
+
+  // append string with its size
+  void WriteString(
+    const std::string &Value
+  );
+
+  // write header and payload to a temporary file and rename it to FileName,
+  // so an interrupted write never destroys the previous checkpoint
+  void WriteToFile(
+    const std::string &FileName
+  ) const;
+
+  // return size of the serialized payload in bytes
+  std::size_t GetSize() const;
+
+  // return the serialized payload (without header)
+  const std::string &GetPayload() const;
+};
+
+class CheckpointReader {
+  void *Mapping;           // mapped file
+  std::size_t MappingSize; // size of mapped file
+  const char *Pos;         // current read position in payload
+  const char *End;         // end of payload
+
+  // throw if less than Size bytes are left
+  void CheckAvailable(
+    std::size_t Size
+  ) const;
+
+public:
+  /* constructor/destructor */
+  // map checkpoint file and check header
+  explicit CheckpointReader(
+    const std::string &FileName
+  );
+
+  // read payload written by CheckpointWriter from memory (without header),
+  // the memory has to stay valid while reading
+  CheckpointReader(
+    const char *Begin,
+    const char *End
+  );
+  ~CheckpointReader();
+
+  CheckpointReader(const CheckpointReader &) = delete;
+  CheckpointReader &operator=(const CheckpointReader &) = delete;
+
+  /* interface */
+  // read plain value (trivially copyable)
+  template<typename T>
+  T Read() {
+    CheckAvailable(sizeof(T));
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+    std::memcpy(&Storage, Pos, sizeof(T));
+    Pos += sizeof(T);
+    return *reinterpret_cast<const T *>(&Storage);
+  }
+
+  // read vector of plain values written by WriteVector
+  template<typename T>
+  void ReadVector(std::vector<T> *Values) {
+    uint64_t NumValues = Read<uint64_t>();
+    CheckAvailable(NumValues * sizeof(T));
+    Values->clear();
+    Values->reserve(NumValues);
+    for (uint64_t IdxValue = 0; IdxValue < NumValues; ++IdxValue) {
+      Values->push_back(Read<T>());
+    }
+  }
+
+  // read string written by WriteString
+  std::string ReadString();
+
+  // return true if the whole payload has been read
+  bool AtEnd() const;
+};
+
+#endif
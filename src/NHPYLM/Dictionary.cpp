@@ -187,6 +187,12 @@ std::vector<std::string> Dictionary::GetId2CharacterSequenceVector() const
   return Id2CharacterSequenceVector;
 }
 
+/** return written form of a word or character **/
+const std::string &Dictionary::GetCharacterSequence(int Id) const
+{
+  return Id2CharacterSequence.find(Id)->second;
+}
+
 /** return vector of ints containing word lengths **/
 std::vector<int> Dictionary::GetWordLengthVector() const
 {
@@ -218,6 +224,34 @@ std::vector<std::vector<std::string>>
 }
 
 
+/** return bytes of the hashmaps and their entries for given part **/
+std::size_t Dictionary::GetMemoryUsageFor(const std::string &Part) const
+{
+  std::size_t MemoryUsage = 0;
+  if (Part == "Word2Id") {
+    MemoryUsage = Word2Id.bucket_count() * sizeof(Word2IdHashmap::value_type);
+    for (Word2IdHashmap::const_iterator it = Word2Id.begin(); it != Word2Id.end(); ++it) {
+      MemoryUsage += it->first.capacity() * sizeof(int);
+    }
+  } else if (Part == "Id2Word") {
+    MemoryUsage = Id2Word.bucket_count() * sizeof(Id2WordHashmap::value_type);
+    for (Id2WordHashmap::const_iterator it = Id2Word.begin(); it != Id2Word.end(); ++it) {
+      MemoryUsage += it->second.capacity() * sizeof(int);
+    }
+  } else if (Part == "Id2CharacterSequence") {
+    MemoryUsage = Id2CharacterSequence.bucket_count() * sizeof(Id2CharacterSequenceHashmap::value_type);
+    for (Id2CharacterSequenceHashmap::const_iterator it = Id2CharacterSequence.begin(); it != Id2CharacterSequence.end(); ++it) {
+      // short strings are stored inside the string object
+      const char *Data = it->second.data();
+      if ((Data < reinterpret_cast<const char *>(&it->second)) ||
+          (Data >= reinterpret_cast<const char *>(&it->second + 1))) {
+        MemoryUsage += it->second.capacity() + 1;
+      }
+    }
+  }
+  return MemoryUsage;
+}
+
 /** return maximum numer of words **/
 int Dictionary::GetMaxNumWords() const
 {
@@ -228,3 +262,56 @@ int Dictionary::GetWordsBegin() const
 {
   return WordsBegin;
 }
+
+
+/** write words and free ids to checkpoint **/
+void Dictionary::WriteCheckpoint(CheckpointWriter *Writer) const
+{
+  Writer->Write<int32_t>(WordsBegin);
+  Writer->Write<int32_t>(MaxId);
+  Writer->WriteVector(std::vector<int>(FreedIds.begin(), FreedIds.end()));
+  Writer->Write<uint8_t>(SortFreedIds);
+  Writer->Write<uint64_t>(Id2Word.size());
+  for (const auto& Word: Id2Word) {
+    Writer->Write<int32_t>(Word.first);
+    Writer->WriteVector(Word.second);
+  }
+}
+
+/** replace words and free ids by the ones from checkpoint, the written
+ *  forms are rebuilt from the character symbols **/
+void Dictionary::ReadCheckpoint(CheckpointReader *Reader)
+{
+  if (Reader->Read<int32_t>() != WordsBegin) {
+    throw std::runtime_error("Checkpoint does not match symbols of dictionary");
+  }
+  MaxId = Reader->Read<int32_t>();
+  std::vector<int> FreedIdsVector;
+  Reader->ReadVector(&FreedIdsVector);
+  FreedIds.assign(FreedIdsVector.begin(), FreedIdsVector.end());
+  SortFreedIds = Reader->Read<uint8_t>();
+
+  Word2Id.clear();
+  Id2Word.clear();
+  for (auto CharSequence = Id2CharacterSequence.begin();
+       CharSequence != Id2CharacterSequence.end(); ++CharSequence) {
+    if (CharSequence->first >= WordsBegin) {
+      Id2CharacterSequence.erase(CharSequence);
+    }
+  }
+
+  uint64_t NumWords = Reader->Read<uint64_t>();
+  Id2Word.resize(NumWords);
+  Word2Id.resize(NumWords);
+  for (uint64_t IdxWord = 0; IdxWord < NumWords; ++IdxWord) {
+    int WordId = Reader->Read<int32_t>();
+    std::vector<int> &Word = Id2Word[WordId];
+    Reader->ReadVector(&Word);
+    if (Word.size() < CHPYLMContextLength + 1) {
+      throw std::runtime_error("Invalid word in checkpoint");
+    }
+    unsigned int Length = Word.size() - CHPYLMContextLength - 1;
+    Word2Id[std::vector<int>(Word.begin() + CHPYLMContextLength, Word.end() - 1)] = WordId;
+    AddWordToId2CharacterSequence(Word.begin() + CHPYLMContextLength, Length, WordId);
+  }
+}
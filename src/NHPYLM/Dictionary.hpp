@@ -61,6 +61,7 @@
 #define _DICTIONARY_H_
 
 #include "definitions.hpp"
+#include "Checkpoint.hpp"
 
 /* dicitionary class */
 class Dictionary {
@@ -89,11 +90,15 @@ public:
   WordBeginLengthPair GetWordBeginLength(int WordId) const;                                           // return a pair containing Word.begin() iterators and length
   int GetWordLength(int WordId) const;                                                                // return Word length
   std::vector<std::string> GetId2CharacterSequenceVector() const;                                     // construct and return a Id2CharacterSequence vector
+  const std::string &GetCharacterSequence(int Id) const;                                              // return written form of a word or character
   std::vector<int> GetWordLengthVector() const;                                                       // return vector with word lengths
   std::vector<std::vector<std::string>> GetId2SeparatedCharacterSequenceVector() const;               // construct and return a Id2SeparatedCharacterSequenceVector vector
   int GetMaxNumWords() const;                                                                         // return maximum number of words
   int GetWordsBegin() const;                                                                          // get first word id
   const std::vector<int> &GetWordVector(int WordId) const;                                            // return stored word vector from lexicon
+  std::size_t GetMemoryUsageFor(const std::string &Part) const;                                       // return bytes of "Word2Id", "Id2Word" or "Id2CharacterSequence" (buckets and contents)
+  void WriteCheckpoint(CheckpointWriter *Writer) const;                                               // write words and free ids to checkpoint
+  void ReadCheckpoint(CheckpointReader *Reader);                                                      // replace words and free ids by the ones from checkpoint
 };
 
 #endif
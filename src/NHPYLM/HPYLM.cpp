@@ -41,7 +41,9 @@
    Author: Oliver Walter
 */
 // ----------------------------------------------------------------------------
+#include <algorithm>
 #include <chrono>
+#include <numeric>
 #include "HPYLM.hpp"
 
 std::default_random_engine HPYLM::RandomGenerator(std::chrono::system_clock::now().time_since_epoch().count());
@@ -50,12 +52,14 @@ std::discrete_distribution<unsigned int> HPYLM::DiscreteDistribution;
 
 HPYLM::HPYLM(int Order_) :
   Parameters(Order_, 0.5, 0.1),
-  RestaurantTree(Parameters.Discount[0], Parameters.Concentration[0], NULL, 0, std::vector<int>()),
+  RestaurantTree(Parameters.Discount[0], Parameters.Concentration[0], NULL, 0, EMPTY),
   Order(Order_),
   NextUnusedContextId(1),
   FreedIds(),
   SortFreedIds(false),
-  ContextIdToContext()
+  ContextIdToContext(),
+  BaseProbabilitiesScale(),
+  Walks(GetWalkFunctions(Order_))
 {
   ContextIdToContext.set_empty_key(EMPTY);
   ContextIdToContext.set_deleted_key(DELETED);
@@ -78,9 +82,64 @@ void HPYLM::DestructRestaurantTreeRecursively(ContextRestaurant *CurrentRestaura
 bool HPYLM::AddWord(const const_witerator &Word, double BaseProbability)
 {
 //   PrintDebugHeader << ": Adding word/character id " << *Word << " with base probability " << BaseProbability << " recursively to LM" << std::endl;
+  return (this->*Walks.AddWord)(Word, BaseProbability);
+}
+
+HPYLM::WalkFunctions HPYLM::GetWalkFunctions(unsigned int Order_)
+{
+  switch (Order_) {
+    case 1: return GetFixedOrderWalkFunctions<1>();
+    case 2: return GetFixedOrderWalkFunctions<2>();
+    case 3: return GetFixedOrderWalkFunctions<3>();
+    case 4: return GetFixedOrderWalkFunctions<4>();
+    case 5: return GetFixedOrderWalkFunctions<5>();
+    case 6: return GetFixedOrderWalkFunctions<6>();
+    case 7: return GetFixedOrderWalkFunctions<7>();
+    case 8: return GetFixedOrderWalkFunctions<8>();
+    default: {
+      WalkFunctions AnyOrderWalks = {&HPYLM::AddWordAnyOrder, &HPYLM::RemoveWordAnyOrder, &HPYLM::WordProbabilityAnyOrder,
+                                     &HPYLM::WordVectorProbabilityAnyOrder, &HPYLM::GetContextIdAnyOrder};
+      return AnyOrderWalks;
+    }
+  }
+}
+
+template<unsigned int FixedOrder>
+HPYLM::WalkFunctions HPYLM::GetFixedOrderWalkFunctions()
+{
+  WalkFunctions FixedOrderWalks = {&HPYLM::AddWordFixedOrder<FixedOrder>, &HPYLM::RemoveWordFixedOrder<FixedOrder>, &HPYLM::WordProbabilityFixedOrder<FixedOrder>,
+                                   &HPYLM::WordVectorProbabilityFixedOrder<FixedOrder>, &HPYLM::GetContextIdFixedOrder<FixedOrder>};
+  return FixedOrderWalks;
+}
+
+bool HPYLM::AddWordAnyOrder(const const_witerator &Word, double BaseProbability)
+{
   return AddWordRecursively(Word, 1, &RestaurantTree, BaseProbability);
 }
 
+template<unsigned int FixedOrder>
+bool HPYLM::AddWordFixedOrder(const const_witerator &Word, double BaseProbability)
+{
+  /* walk down to the longest context, creating missing restaurants, and keep the
+   * restaurants and the base probabilities of the word for all levels */
+  std::array<ContextRestaurant *, FixedOrder> Restaurants;
+  std::array<double, FixedOrder> BaseProbabilities;
+  Restaurants[0] = &RestaurantTree;
+  BaseProbabilities[0] = BaseProbability;
+  for (unsigned int level = 1; level < FixedOrder; level++) {
+    BaseProbabilities[level] = Restaurants[level - 1]->ThisRestaurant.WordProbability(*Word, BaseProbabilities[level - 1]);
+    Restaurants[level] = GetNextContext(Word, level, Restaurants[level - 1]);
+  }
+
+  /* add word from the longest context on as long as new tables are created */
+  for (unsigned int level = FixedOrder; level > 0; level--) {
+    if (!AddWordToRestaurant(Word, level, Restaurants[level - 1], BaseProbabilities[level - 1])) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool HPYLM::AddWordRecursively(const const_witerator &Word, unsigned int level, ContextRestaurant *CurrentRestaurant, double BaseProbability)
 {
   /* check if end of tree is reached */
@@ -88,28 +147,8 @@ bool HPYLM::AddWordRecursively(const const_witerator &Word, unsigned int level,
     /* adjust base probability for word acording to current context */
     double NextBaseProbability = CurrentRestaurant->ThisRestaurant.WordProbability(*Word, BaseProbability);
 
-    /* find or create restaurant for given context */
-    ContextsHashmap::iterator it = CurrentRestaurant->NextContext.find(*(Word - level));
-    if (it == CurrentRestaurant->NextContext.end()) {
-      /* get new contextid for resataurant */
-      int ContextId = GetNextAvailableContextId();
-
-//       /* debug */
-//       PrintDebugHeader << ": Creating new restaurant" << " at level " << level + 1 << " for context id " << *(Word - level) << " with context id " << ContextId
-//                        << " and context sequence |";
-//       for(const_witerator it = Word - level; it != Word; ++it) {
-//         std::cout << *it << "|";
-//       }
-//       std::cout << std::endl;
-
-      /* create a new restaurant */
-      ContextRestaurant *NextContext = new ContextRestaurant(Parameters.Discount[level], Parameters.Concentration[level], CurrentRestaurant, ContextId, std::vector<int>(Word - level, Word));
-      ContextIdToContext.insert(std::make_pair(ContextId, NextContext));
-      it = CurrentRestaurant->NextContext.insert(std::make_pair(*(Word - level), NextContext)).first;
-    }
-
     /* recursively add word to tree */
-    if (!AddWordRecursively(Word, level + 1, it->second, NextBaseProbability)) {
+    if (!AddWordRecursively(Word, level + 1, GetNextContext(Word, level, CurrentRestaurant), NextBaseProbability)) {
       /* finish recursive adding */
       return false;
     }
@@ -122,8 +161,52 @@ bool HPYLM::AddWordRecursively(const const_witerator &Word, unsigned int level,
 //   }
 //   std::cout  << std::endl;
 
+  return AddWordToRestaurant(Word, level, CurrentRestaurant, BaseProbability);
+}
+
+HPYLM::ContextRestaurant *HPYLM::GetNextContext(const const_witerator &Word, unsigned int level, ContextRestaurant *CurrentRestaurant)
+{
+  /* find or create restaurant for given context */
+  ContextsHashmap::iterator it = CurrentRestaurant->NextContext.find(*(Word - level));
+  if (it == CurrentRestaurant->NextContext.end()) {
+    /* get new contextid for resataurant */
+    int ContextId = GetNextAvailableContextId();
+
+//     /* debug */
+//     PrintDebugHeader << ": Creating new restaurant" << " at level " << level + 1 << " for context id " << *(Word - level) << " with context id " << ContextId
+//                      << " and context sequence |";
+//     for(const_witerator it = Word - level; it != Word; ++it) {
+//       std::cout << *it << "|";
+//     }
+//     std::cout << std::endl;
+
+    /* create a new restaurant */
+    ContextRestaurant *NextContext = new ContextRestaurant(Parameters.Discount[level], Parameters.Concentration[level], CurrentRestaurant, ContextId, *(Word - level));
+    ContextIdToContext.insert(std::make_pair(ContextId, NextContext));
+    it = CurrentRestaurant->NextContext.insert(std::make_pair(*(Word - level), NextContext)).first;
+
+    /* the last word of the new context now leads to it instead of the
+     * current context, if it follows the rest of the new context */
+    ContextRestaurant *PrecedingContext = FindContext(Word - 1, level - 1);
+    if (PrecedingContext != nullptr) {
+      RedirectNextContextIdsRecursively(PrecedingContext, *(Word - 1), CurrentRestaurant->ContextId, ContextId);
+    }
+  }
+  return it->second;
+}
+
+bool HPYLM::AddWordToRestaurant(const const_witerator &Word, unsigned int level, ContextRestaurant *CurrentRestaurant, double BaseProbability)
+{
   /* add word within the tree if a new table was created */
-  return CurrentRestaurant->ThisRestaurant.IncrementWordCount(*Word, BaseProbability);
+  if (!CurrentRestaurant->ThisRestaurant.IncrementWordCount(*Word, BaseProbability)) {
+    return false;
+  }
+
+  /* set the context following a word which is new in the restaurant */
+  if (CurrentRestaurant->ThisRestaurant.GetNextContextId(*Word) == EMPTY) {
+    CurrentRestaurant->ThisRestaurant.SetNextContextId(*Word, GetContextIdRecursively(Word + 1, 1, std::min(level, Order - 1), RestaurantTree));
+  }
+  return true;
 }
 
 int HPYLM::GetNextAvailableContextId()
@@ -148,9 +231,35 @@ int HPYLM::GetNextAvailableContextId()
 WordRemoveStatus HPYLM::RemoveWord(const const_witerator &Word)
 {
 //   PrintDebugHeader << ": Removing word/character " << *Word << " recursively from LM" << std::endl;
+  return (this->*Walks.RemoveWord)(Word);
+}
+
+WordRemoveStatus HPYLM::RemoveWordAnyOrder(const const_witerator &Word)
+{
   return RemoveWordRecursively(Word, 1, &RestaurantTree);
 }
 
+template<unsigned int FixedOrder>
+WordRemoveStatus HPYLM::RemoveWordFixedOrder(const const_witerator &Word)
+{
+  /* walk down to the longest context and keep the restaurants of all levels */
+  std::array<ContextRestaurant *, FixedOrder> Restaurants;
+  Restaurants[0] = &RestaurantTree;
+  for (unsigned int level = 1; level < FixedOrder; level++) {
+    Restaurants[level] = Restaurants[level - 1]->NextContext.find(*(Word - level))->second;
+  }
+
+  /* remove word from the longest context on as long as tables are removed */
+  WordRemoveStatus Removed = NONEREMOVED;
+  for (unsigned int level = FixedOrder; level > 0; level--) {
+    Removed = RemoveWordFromRestaurant(Word, level, Restaurants[level - 1]);
+    if (Removed == NONEREMOVED) {
+      return NONEREMOVED;
+    }
+  }
+  return Removed;
+}
+
 WordRemoveStatus HPYLM::RemoveWordRecursively(const const_witerator &Word, unsigned int level, ContextRestaurant *CurrentRestaurant)
 {
   /* check if end of tree is reached */
@@ -170,6 +279,11 @@ WordRemoveStatus HPYLM::RemoveWordRecursively(const const_witerator &Word, unsig
 //     std::cout << " without context" << std::endl;
 //   }
 
+  return RemoveWordFromRestaurant(Word, level, CurrentRestaurant);
+}
+
+WordRemoveStatus HPYLM::RemoveWordFromRestaurant(const const_witerator &Word, unsigned int level, ContextRestaurant *CurrentRestaurant)
+{
   /* remove word within the tree if the table for the word was removed */
 //   PrintDebugHeader << ": Decrementing WordCount for Word " << *Word << " in ContextId " << CurrentRestaurant->ContextId << std::endl;
   WordRemoveStatus Removed = CurrentRestaurant->ThisRestaurant.DecrementWordCount(*Word);
@@ -181,16 +295,99 @@ WordRemoveStatus HPYLM::RemoveWordRecursively(const const_witerator &Word, unsig
     ContextIdToContext.erase(CurrentRestaurant->ContextId);
     FreedIds.push_back(CurrentRestaurant->ContextId);
     SortFreedIds = true;
+
+    /* the last word of the removed context leads to the previous context again */
+    ContextRestaurant *PrecedingContext = FindContext(Word - 1, level - 2);
+    if (PrecedingContext != nullptr) {
+      RedirectNextContextIdsRecursively(PrecedingContext, *(Word - 1), CurrentRestaurant->ContextId, CurrentRestaurant->PreviousContext->ContextId);
+    }
     delete CurrentRestaurant;
   }
   return Removed;
 }
 
+HPYLM::ContextRestaurant *HPYLM::FindContext(const const_witerator &Word, unsigned int ContextLength)
+{
+  ContextRestaurant *CurrentRestaurant = &RestaurantTree;
+  for (unsigned int level = 1; level <= ContextLength; level++) {
+    ContextsHashmap::iterator it = CurrentRestaurant->NextContext.find(*(Word - level));
+    if (it == CurrentRestaurant->NextContext.end()) {
+      return nullptr;
+    }
+    CurrentRestaurant = it->second;
+  }
+  return CurrentRestaurant;
+}
+
+void HPYLM::RedirectNextContextIdsRecursively(ContextRestaurant *CurrentRestaurant, int Word, int OldContextId, int NewContextId)
+{
+  /* a word in a restaurant is also in the restaurants of all shorter contexts,
+   * so the longer contexts only have to be searched if this one contains it */
+  int NextContextId = CurrentRestaurant->ThisRestaurant.GetNextContextId(Word);
+  if (NextContextId == EMPTY) {
+    return;
+  }
+  if (NextContextId == OldContextId) {
+    CurrentRestaurant->ThisRestaurant.SetNextContextId(Word, NewContextId);
+  }
+  for (ContextsHashmap::iterator it = CurrentRestaurant->NextContext.begin(); it != CurrentRestaurant->NextContext.end(); ++it) {
+    RedirectNextContextIdsRecursively(it->second, Word, OldContextId, NewContextId);
+  }
+}
+
+void HPYLM::SetNextContextIdsRecursively(ContextRestaurant *CurrentRestaurant)
+{
+  /* next context sequence: current context sequence without the first word, if
+   * it has the maximum length, followed by the word */
+  std::vector<int> ContextSequence;
+  if (Order > 1) {
+    GetContextSequence(CurrentRestaurant->ContextId, &ContextSequence);
+    if (ContextSequence.size() == (Order - 1)) {
+      ContextSequence.erase(ContextSequence.begin());
+    }
+  }
+  ContextSequence.resize(ContextSequence.size() + 1);
+
+  std::vector<int> Words;
+  std::vector<int> NextContextIds;
+  CurrentRestaurant->ThisRestaurant.GetWordsAndNextContextIds(std::vector<bool>(), &Words, &NextContextIds);
+  for (std::vector<int>::const_iterator Word = Words.begin(); Word != Words.end(); ++Word) {
+    ContextSequence.back() = *Word;
+    CurrentRestaurant->ThisRestaurant.SetNextContextId(*Word, GetContextId(ContextSequence));
+  }
+
+  for (ContextsHashmap::iterator it = CurrentRestaurant->NextContext.begin(); it != CurrentRestaurant->NextContext.end(); ++it) {
+    SetNextContextIdsRecursively(it->second);
+  }
+}
+
 double HPYLM::WordProbability(const const_witerator &Word, double BaseProbability) const
+{
+  return (this->*Walks.WordProbability)(Word, BaseProbability);
+}
+
+double HPYLM::WordProbabilityAnyOrder(const const_witerator &Word, double BaseProbability) const
 {
   return WordProbabilityRecursively(Word, 1, RestaurantTree, BaseProbability);
 }
 
+template<unsigned int FixedOrder>
+double HPYLM::WordProbabilityFixedOrder(const const_witerator &Word, double BaseProbability) const
+{
+  /* adjust base probability for word according to the contexts from the root on */
+  const ContextRestaurant *CurrentRestaurant = &RestaurantTree;
+  BaseProbability = CurrentRestaurant->ThisRestaurant.WordProbability(*Word, BaseProbability);
+  for (unsigned int level = 1; level < FixedOrder; level++) {
+    ContextsHashmap::const_iterator it = CurrentRestaurant->NextContext.find(*(Word - level));
+    if (it == CurrentRestaurant->NextContext.end()) {
+      break;
+    }
+    CurrentRestaurant = it->second;
+    BaseProbability = CurrentRestaurant->ThisRestaurant.WordProbability(*Word, BaseProbability);
+  }
+  return BaseProbability;
+}
+
 double HPYLM::WordProbabilityRecursively(const const_witerator &Word, unsigned int level, const HPYLM::ContextRestaurant &CurrentRestaurant, double BaseProbability) const
 {
   /* adjust base probability for word acording to current context */
@@ -209,10 +406,33 @@ double HPYLM::WordProbabilityRecursively(const const_witerator &Word, unsigned i
 }
 
 void HPYLM::WordVectorProbability(const std::vector< int > &ContextSequence, const std::vector< int > &Words, std::vector< double > *BaseProbabilities) const
+{
+  (this->*Walks.WordVectorProbability)(ContextSequence, Words, BaseProbabilities);
+}
+
+void HPYLM::WordVectorProbabilityAnyOrder(const std::vector< int > &ContextSequence, const std::vector< int > &Words, std::vector< double > *BaseProbabilities) const
 {
   WordVectorProbabilityRecursively(ContextSequence.end(), Words, 1, ContextSequence.size(), RestaurantTree, BaseProbabilities);
 }
 
+template<unsigned int FixedOrder>
+void HPYLM::WordVectorProbabilityFixedOrder(const std::vector< int > &ContextSequence, const std::vector< int > &Words, std::vector< double > *BaseProbabilities) const
+{
+  /* adjust base probabilities for the words according to the contexts from the root on,
+   * the tree has no contexts longer than FixedOrder - 1 */
+  const ContextRestaurant *CurrentRestaurant = &RestaurantTree;
+  CurrentRestaurant->ThisRestaurant.WordVectorProbability(Words, BaseProbabilities);
+  const unsigned int ContextLength = std::min<std::size_t>(ContextSequence.size(), FixedOrder - 1);
+  for (unsigned int level = 1; level <= ContextLength; level++) {
+    ContextsHashmap::const_iterator it = CurrentRestaurant->NextContext.find(*(ContextSequence.end() - level));
+    if (it == CurrentRestaurant->NextContext.end()) {
+      break;
+    }
+    CurrentRestaurant = it->second;
+    CurrentRestaurant->ThisRestaurant.WordVectorProbability(Words, BaseProbabilities);
+  }
+}
+
 void HPYLM::WordVectorProbabilityRecursively(const const_witerator &Word, const std::vector< int > &Words, unsigned int level, unsigned int ContextLenght, const HPYLM::ContextRestaurant &CurrentRestaurant, std::vector< double > *BaseProbabilities) const
 {
   /* adjust base probabilities for the words acording to current context */
@@ -235,10 +455,42 @@ double HPYLM::WordSequenceLoglikelihood(const std::vector< int > &WordSequence,
   for (const_witerator Word = WordSequence.begin() + Order - 1; Word != WordSequence.end(); ++Word) {
     Loglikelihood += log(WordProbability(Word, BaseProbabilities.find(*Word)->second));
   }
+  return Loglikelihood + BaseProbabilitiesScaleLoglikelihood(WordSequence.size() - Order + 1);
+}
+
+void HPYLM::SortedWordSequencesLoglikelihood(const std::vector< const std::vector< int > * > &SortedWordSequences, const google::dense_hash_map< int, double > &BaseProbabilities, std::vector< double > *Loglikelihoods) const
+{
+  /* PrefixLoglikelihoods[i]: log likelihood of the first i words after the context of the previous sequence */
+  std::vector<double> PrefixLoglikelihoods;
+  const std::vector<int> *PreviousSequence = nullptr;
+  for (std::size_t IdxSequence = 0; IdxSequence < SortedWordSequences.size(); IdxSequence++) {
+    const std::vector<int> &WordSequence = *SortedWordSequences[IdxSequence];
+
+    /* the probability of a word only depends on the preceding words, so the
+     * likelihood of the common prefix with the previous sequence is reused */
+    std::size_t CommonLength = 0;
+    if (PreviousSequence != nullptr) {
+      while ((CommonLength < WordSequence.size()) && (CommonLength < PreviousSequence->size()) &&
+             (WordSequence[CommonLength] == (*PreviousSequence)[CommonLength])) {
+        CommonLength++;
+      }
+    }
+    std::size_t NumReusedWords = (CommonLength > (Order - 1)) ? CommonLength - (Order - 1) : 0;
+    PrefixLoglikelihoods.resize(NumReusedWords + 1);
+    for (const_witerator Word = WordSequence.begin() + Order - 1 + NumReusedWords; Word != WordSequence.end(); ++Word) {
+      PrefixLoglikelihoods.push_back(PrefixLoglikelihoods.back() + log(WordProbability(Word, BaseProbabilities.find(*Word)->second)));
+    }
+    (*Loglikelihoods)[IdxSequence] = PrefixLoglikelihoods.back() + BaseProbabilitiesScaleLoglikelihood(WordSequence.size() - Order + 1);
+    PreviousSequence = &WordSequence;
+  }
+}
+
+double HPYLM::BaseProbabilitiesScaleLoglikelihood(std::size_t NumWords) const
+{
   if (BaseProbabilitiesScale.empty()) {
-    return Loglikelihood;
-  } else if (BaseProbabilitiesScale.size() > (WordSequence.size() - Order + 1)) {
-    return Loglikelihood + log(BaseProbabilitiesScale[WordSequence.size() - Order + 1]);
+    return 0;
+  } else if (BaseProbabilitiesScale.size() > NumWords) {
+    return log(BaseProbabilitiesScale[NumWords]);
   } else {
     return log(0);
   }
@@ -252,9 +504,30 @@ int HPYLM::GetContextId(const std::vector< int > &ContextSequence) const
 //   }
 //   std::cout << std::endl;
 //   PrintDebugHeader << ": Recursively getting contextid for context sequence [ ";
+  return (this->*Walks.GetContextId)(ContextSequence);
+}
+
+int HPYLM::GetContextIdAnyOrder(const std::vector< int > &ContextSequence) const
+{
   return GetContextIdRecursively(ContextSequence.end(), 1, ContextSequence.size(), RestaurantTree);
 }
 
+template<unsigned int FixedOrder>
+int HPYLM::GetContextIdFixedOrder(const std::vector< int > &ContextSequence) const
+{
+  /* follow the context from its last word on as far as the tree goes */
+  const ContextRestaurant *CurrentRestaurant = &RestaurantTree;
+  const unsigned int ContextLength = std::min<std::size_t>(ContextSequence.size(), FixedOrder - 1);
+  for (unsigned int level = 1; level <= ContextLength; level++) {
+    ContextsHashmap::const_iterator it = CurrentRestaurant->NextContext.find(*(ContextSequence.end() - level));
+    if (it == CurrentRestaurant->NextContext.end()) {
+      break;
+    }
+    CurrentRestaurant = it->second;
+  }
+  return CurrentRestaurant->ContextId;
+}
+
 int HPYLM::GetContextIdRecursively(const const_witerator &Word, unsigned int level, unsigned int ContextLength, const HPYLM::ContextRestaurant &CurrentRestaurant) const
 {
   /* check if end of tree is reached */
@@ -343,6 +616,40 @@ void HPYLM::GetTotalContextcountPerLevelRecursively(unsigned int level, const HP
 //   PrintDebugHeader << "Visited context id : " << CurrentRestaurant.ContextId << " at level " << level << " count " << (*TotalContextcountPerLevel)[level - 1] << std::endl;
 }
 
+std::vector< std::size_t > HPYLM::GetMemoryUsagePerLevel(const std::string &Part) const
+{
+  std::vector<std::size_t> NodeMemoryUsagePerLevel(Order, 0);
+  std::vector<std::size_t> HashMapMemoryUsagePerLevel(Order, 0);
+  std::vector<std::size_t> TableMemoryUsagePerLevel(Order, 0);
+  GetMemoryUsagePerLevelRecursively(1, RestaurantTree, &NodeMemoryUsagePerLevel, &HashMapMemoryUsagePerLevel, &TableMemoryUsagePerLevel);
+  if (Part == "Node") {
+    return NodeMemoryUsagePerLevel;
+  } else if (Part == "HashMap") {
+    return HashMapMemoryUsagePerLevel;
+  } else if (Part == "Table") {
+    return TableMemoryUsagePerLevel;
+  } else {
+    return std::vector<std::size_t>();
+  }
+}
+
+void HPYLM::GetMemoryUsagePerLevelRecursively(unsigned int level, const HPYLM::ContextRestaurant &CurrentRestaurant, std::vector< std::size_t > *NodeMemoryUsagePerLevel, std::vector< std::size_t > *HashMapMemoryUsagePerLevel, std::vector< std::size_t > *TableMemoryUsagePerLevel) const
+{
+  for (ContextsHashmap::const_iterator NextContextIterator = CurrentRestaurant.NextContext.begin(); NextContextIterator != CurrentRestaurant.NextContext.end(); ++NextContextIterator) {
+    GetMemoryUsagePerLevelRecursively(level + 1, *(NextContextIterator->second), NodeMemoryUsagePerLevel, HashMapMemoryUsagePerLevel, TableMemoryUsagePerLevel);
+  }
+  (*NodeMemoryUsagePerLevel)[level - 1] += sizeof(ContextRestaurant);
+  (*HashMapMemoryUsagePerLevel)[level - 1] += CurrentRestaurant.NextContext.bucket_count() * sizeof(ContextsHashmap::value_type) + CurrentRestaurant.ThisRestaurant.GetHashMapMemoryUsage();
+  (*TableMemoryUsagePerLevel)[level - 1] += CurrentRestaurant.ThisRestaurant.GetTableMemoryUsage();
+}
+
+std::size_t HPYLM::GetContextIndexMemoryUsage() const
+{
+  // list nodes hold the id and two pointers
+  return ContextIdToContext.bucket_count() * sizeof(ContextsHashmap::value_type) +
+         FreedIds.size() * (sizeof(int) + 2 * sizeof(void *));
+}
+
 const HPYLM::HPYLMParameters &HPYLM::GetHPYLMParameters() const
 {
   return Parameters;
@@ -358,27 +665,11 @@ ContextToContextTransitions HPYLM::GetTransitions(int ContextId, int SentEndSymb
     return Transitions;
   }
 
-  /* get words in given context */
-  Transitions.Words = it->second->ThisRestaurant.GetWords(ActiveWords);
-
-  /* extract context sequence and remove last word, if we have the longest context */
-  std::vector<int> ContextSequence;
-  if (Order > 1) {
-    ContextSequence = it->second->ContextSequence;
-    if (ContextSequence.size() == (Order - 1)) {
-      ContextSequence.erase(ContextSequence.begin());
-    }
-  }
-
-  /* generate next context and get context id */
-  ContextSequence.resize(ContextSequence.size() + 1);
-  Transitions.NextContextIds.reserve(Transitions.Words.size() + 1);
-  for (std::vector<int>::const_iterator Word = Transitions.Words.begin(); Word != Transitions.Words.end(); ++Word) {
-    if (*Word != SentEndSymbolId) {
-      ContextSequence[ContextSequence.size() - 1] = *Word;
-      Transitions.NextContextIds.push_back(GetContextId(ContextSequence));
-    } else {
-      Transitions.NextContextIds.push_back(NextUnusedContextId);
+  /* get words in given context and the contexts following them */
+  it->second->ThisRestaurant.GetWordsAndNextContextIds(ActiveWords, &Transitions.Words, &Transitions.NextContextIds);
+  for (std::size_t IdxWord = 0; IdxWord < Transitions.Words.size(); ++IdxWord) {
+    if (Transitions.Words[IdxWord] == SentEndSymbolId) {
+      Transitions.NextContextIds[IdxWord] = NextUnusedContextId;
       Transitions.HasTransitionToSentEnd = true;
     }
   }
@@ -397,13 +688,17 @@ int HPYLM::GetNextUnusedContextId() const
   return NextUnusedContextId;
 }
 
-const std::vector<int> &HPYLM::GetContextSequence(int ContextId) const
+void HPYLM::GetContextSequence(int ContextId, std::vector<int> *ContextSequence) const
 {
+  ContextSequence->clear();
   ContextsHashmap::const_iterator it = ContextIdToContext.find(ContextId);
-  if (it != ContextIdToContext.end()) {
-    return it->second->ContextSequence;
-  } else {
-    return RestaurantTree.ContextSequence;
+  if (it == ContextIdToContext.end()) {
+    return;
+  }
+
+  /* the keys from the restaurant up to the root are the words of the context sequence in order */
+  for (const ContextRestaurant *CurrentRestaurant = it->second; CurrentRestaurant->PreviousContext != NULL; CurrentRestaurant = CurrentRestaurant->PreviousContext) {
+    ContextSequence->push_back(CurrentRestaurant->Key);
   }
 }
 
@@ -445,6 +740,50 @@ int HPYLM::GenerateWordRecursively(const const_witerator &Word, const std::vecto
   }
 }
 
+void HPYLM::GenerateWordProbabilities(const std::vector< int > &ContextSequence, const std::vector< int > &Words, const std::vector< double > &BaseProbabilities, std::vector< double > *WordProbabilities) const
+{
+  /* falling back from the root restaurant draws from the base probabilities */
+  double BaseNorm = std::accumulate(BaseProbabilities.begin(), BaseProbabilities.end(), 0.0);
+  WordProbabilities->resize(Words.size());
+  for (unsigned int IdxWord = 0; IdxWord < Words.size(); IdxWord++) {
+    (*WordProbabilities)[IdxWord] = BaseProbabilities[IdxWord] / BaseNorm;
+  }
+  GenerateWordProbabilitiesRecursively(ContextSequence.end(), Words, 1, ContextSequence.size(), RestaurantTree, BaseProbabilities, WordProbabilities);
+}
+
+void HPYLM::GenerateWordProbabilitiesRecursively(const const_witerator &Word, const std::vector< int > &Words, unsigned int level, unsigned int ContextLenght, const HPYLM::ContextRestaurant &CurrentRestaurant, const std::vector< double > &BaseProbabilities, std::vector< double > *WordProbabilities) const
+{
+  /* adjust base probabilities for the words acording to current context */
+  std::vector<double> ContextProbabilities(BaseProbabilities);
+  CurrentRestaurant.ThisRestaurant.WordVectorProbability(Words, &ContextProbabilities);
+
+  /* draw in this context, PHI is replaced by the draw in the shorter context */
+  double Norm = std::accumulate(ContextProbabilities.begin(), ContextProbabilities.end(), 0.0);
+  double FallbackProbability = 0;
+  for (unsigned int IdxWord = 0; IdxWord < Words.size(); IdxWord++) {
+    if (Words[IdxWord] == PHI) {
+      FallbackProbability += ContextProbabilities[IdxWord] / Norm;
+    }
+  }
+  for (unsigned int IdxWord = 0; IdxWord < Words.size(); IdxWord++) {
+    if (Words[IdxWord] == PHI) {
+      (*WordProbabilities)[IdxWord] = 0;
+    } else {
+      (*WordProbabilities)[IdxWord] = ContextProbabilities[IdxWord] / Norm + FallbackProbability * (*WordProbabilities)[IdxWord];
+    }
+  }
+
+  /* check if end of tree is reached */
+  if (level <= ContextLenght) {
+    /* find restaurant for given context */
+    ContextsHashmap::const_iterator it = CurrentRestaurant.NextContext.find(*(Word - level));
+    if (it != CurrentRestaurant.NextContext.end()) {
+      /* the draw in the longer context falls back to this one */
+      GenerateWordProbabilitiesRecursively(Word, Words, level + 1, ContextLenght, *(it->second), ContextProbabilities, WordProbabilities);
+    }
+  }
+}
+
 int HPYLM::GetBaseTablesPerWord(int WordId) const
 {
   return RestaurantTree.ThisRestaurant.GetTablesPerWord(WordId);
@@ -470,9 +809,9 @@ void HPYLM::SetDiscount(int Level, double Value)
   Parameters.Discount[Level] = Value;
 }
 
-HPYLM::ContextRestaurant::ContextRestaurant(const double &Discount_, const double &Concentration_, ContextRestaurant *PreviousContext_, int ContextId_, const std::vector< int > &ContextSequence_) :
+HPYLM::ContextRestaurant::ContextRestaurant(const double &Discount_, const double &Concentration_, ContextRestaurant *PreviousContext_, int ContextId_, int Key_) :
   ContextId(ContextId_),
-  ContextSequence(ContextSequence_),
+  Key(Key_),
   NextContext(),
   PreviousContext(PreviousContext_),
   ThisRestaurant(Discount_, Concentration_)
@@ -502,3 +841,92 @@ ContextToContextTransitions::ContextToContextTransitions() :
   HasTransitionToSentEnd(false)
 {
 }
+
+void HPYLM::SeedRandomGenerators(unsigned int Seed)
+{
+  RandomGenerator.seed(Seed);
+  Restaurant::SeedRandomGenerator(Seed + 1);
+}
+
+void HPYLM::WriteHyperParameters(CheckpointWriter *Writer) const
+{
+  Writer->WriteVector(Parameters.Discount);
+  Writer->WriteVector(Parameters.Concentration);
+  Writer->WriteVector(BaseProbabilitiesScale);
+}
+
+void HPYLM::ReadHyperParameters(CheckpointReader *Reader)
+{
+  /* restaurants hold references to the parameters, so copy the values */
+  std::vector<double> Discount;
+  std::vector<double> Concentration;
+  Reader->ReadVector(&Discount);
+  Reader->ReadVector(&Concentration);
+  if ((Discount.size() != Parameters.Discount.size()) || (Concentration.size() != Parameters.Concentration.size())) {
+    throw std::runtime_error("Checkpoint does not match order of HPYLM");
+  }
+  std::copy(Discount.begin(), Discount.end(), Parameters.Discount.begin());
+  std::copy(Concentration.begin(), Concentration.end(), Parameters.Concentration.begin());
+  Reader->ReadVector(&BaseProbabilitiesScale);
+}
+
+void HPYLM::WriteCheckpoint(CheckpointWriter *Writer) const
+{
+  Writer->Write<uint32_t>(Order);
+  WriteHyperParameters(Writer);
+  Writer->Write<int32_t>(NextUnusedContextId);
+  Writer->WriteVector(std::vector<int>(FreedIds.begin(), FreedIds.end()));
+  Writer->Write<uint8_t>(SortFreedIds);
+  WriteContextRecursively(RestaurantTree, Writer);
+}
+
+void HPYLM::WriteContextRecursively(const ContextRestaurant &CurrentRestaurant, CheckpointWriter *Writer) const
+{
+  CurrentRestaurant.ThisRestaurant.WriteCheckpoint(Writer);
+  Writer->Write<uint64_t>(CurrentRestaurant.NextContext.size());
+  for (ContextsHashmap::const_iterator NextContextIterator = CurrentRestaurant.NextContext.begin(); NextContextIterator != CurrentRestaurant.NextContext.end(); ++NextContextIterator) {
+    Writer->Write<int32_t>(NextContextIterator->first);
+    Writer->Write<int32_t>(NextContextIterator->second->ContextId);
+    WriteContextRecursively(*NextContextIterator->second, Writer);
+  }
+}
+
+void HPYLM::ReadCheckpoint(CheckpointReader *Reader)
+{
+  if (Reader->Read<uint32_t>() != Order) {
+    throw std::runtime_error("Checkpoint does not match order of HPYLM");
+  }
+
+  ReadHyperParameters(Reader);
+  NextUnusedContextId = Reader->Read<int32_t>();
+  std::vector<int> FreedIdsVector;
+  Reader->ReadVector(&FreedIdsVector);
+  FreedIds.assign(FreedIdsVector.begin(), FreedIdsVector.end());
+  SortFreedIds = Reader->Read<uint8_t>();
+
+  /* replace restaurant tree */
+  DestructRestaurantTreeRecursively(&RestaurantTree);
+  RestaurantTree.NextContext.clear();
+  ContextIdToContext.clear();
+  ContextIdToContext.insert(std::make_pair(RestaurantTree.ContextId, &RestaurantTree));
+  ReadContextRecursively(1, &RestaurantTree, Reader);
+  SetNextContextIdsRecursively(&RestaurantTree);
+}
+
+void HPYLM::ReadContextRecursively(unsigned int level, ContextRestaurant *CurrentRestaurant, CheckpointReader *Reader)
+{
+  CurrentRestaurant->ThisRestaurant.ReadCheckpoint(Reader);
+  uint64_t NumNextContexts = Reader->Read<uint64_t>();
+  if ((NumNextContexts > 0) && (level >= Order)) {
+    throw std::runtime_error("Checkpoint does not match order of HPYLM");
+  }
+  for (uint64_t IdxNextContext = 0; IdxNextContext < NumNextContexts; ++IdxNextContext) {
+    int Key = Reader->Read<int32_t>();
+    int ContextId = Reader->Read<int32_t>();
+
+    ContextRestaurant *NextContext = new ContextRestaurant(Parameters.Discount[level], Parameters.Concentration[level], CurrentRestaurant, ContextId, Key);
+    ContextIdToContext.insert(std::make_pair(ContextId, NextContext));
+    CurrentRestaurant->NextContext.insert(std::make_pair(Key, NextContext));
+    ReadContextRecursively(level + 1, NextContext, Reader);
+  }
+}
@@ -60,6 +60,7 @@
 #ifndef _HPYLM_HPP_
 #define _HPYLM_HPP_
 
+#include <array>
 #include "Restaurant.hpp"
 
 /*
@@ -78,8 +79,10 @@ class HPYLM {
   struct ContextRestaurant {
     // Unique id of context
     const int ContextId;
-    // Context sequence of current restaurant
-    const std::vector<int> ContextSequence;
+    // first word of the context sequence (key of this restaurant in the
+    // previous restaurant), the context sequence is the key followed by the
+    // context sequence of the previous restaurant
+    const int Key;
     // hashmap containing next restraurant in restaurant tree
     ContextsHashmap NextContext;
     // reference to the previous restaurant
@@ -93,7 +96,7 @@ class HPYLM {
       const double &Concentration_,
       ContextRestaurant *PreviousContext_,
       int ContextId_,
-      const std::vector<int> &ContextSequence_
+      int Key_
     );
   };
 
@@ -113,6 +116,16 @@ class HPYLM {
     PosteriorParameters(int Order);
   };
 
+  /* walks through the restaurant tree, specialized for the order of the
+   * hpylm (see GetWalkFunctions) */
+  struct WalkFunctions {
+    bool (HPYLM::*AddWord)(const const_witerator &Word, double BaseProbability);
+    WordRemoveStatus (HPYLM::*RemoveWord)(const const_witerator &Word);
+    double (HPYLM::*WordProbability)(const const_witerator &Word, double BaseProbability) const;
+    void (HPYLM::*WordVectorProbability)(const std::vector< int > &ContextSequence, const std::vector< int > &Words, std::vector< double > *BaseProbabilities) const;
+    int (HPYLM::*GetContextId)(const std::vector< int > &ContextSequence) const;
+  };
+
   /* struct holding the hyper parameters */
   struct HPYLMParameters {
     // vector of discount paramters for different levels
@@ -153,6 +166,8 @@ class HPYLM {
   ContextsHashmap ContextIdToContext;
   // scaling factor for base probabilities for words
   std::vector<double> BaseProbabilitiesScale;
+  // walks through the restaurant tree for the order of the hpylm
+  const WalkFunctions Walks;
 
 
   /* some internal functions */
@@ -161,6 +176,94 @@ class HPYLM {
     ContextRestaurant *CurrentRestaurant
   );
 
+  // return the walks through the restaurant tree for the given order:
+  // orders 1 to 8 use the FixedOrder functions, where the number of levels
+  // is known at compile time, so the walks are unrolled loops keeping the
+  // restaurants of all levels in arrays, higher orders use the recursive
+  // functions
+  static WalkFunctions GetWalkFunctions(
+    unsigned int Order_
+  );
+
+  // return the walks through the restaurant tree with the order as
+  // compile time constant
+  template<unsigned int FixedOrder>
+  static WalkFunctions GetFixedOrderWalkFunctions();
+
+  // internal function to find the restaurant for the next context of the
+  // word at given level, the restaurant is created if it does not exist
+  HPYLM::ContextRestaurant *GetNextContext(
+    const const_witerator &Word,
+    unsigned int level,
+    HPYLM::ContextRestaurant *CurrentRestaurant
+  );
+
+  // internal function to add a word to the restaurant at given level,
+  // returns true if a new table was created
+  bool AddWordToRestaurant(
+    const const_witerator &Word,
+    unsigned int level,
+    HPYLM::ContextRestaurant *CurrentRestaurant,
+    double BaseProbability
+  );
+
+  // internal function to remove a word from the restaurant at given level,
+  // the restaurant is deleted if it became empty
+  WordRemoveStatus RemoveWordFromRestaurant(
+    const const_witerator &Word,
+    unsigned int level,
+    HPYLM::ContextRestaurant *CurrentRestaurant
+  );
+
+  // internal functions to walk through the restaurant tree for any order,
+  // they start the recursive functions at the root
+  bool AddWordAnyOrder(
+    const const_witerator &Word,
+    double BaseProbability
+  );
+  WordRemoveStatus RemoveWordAnyOrder(
+    const const_witerator &Word
+  );
+  double WordProbabilityAnyOrder(
+    const const_witerator &Word,
+    double BaseProbability
+  ) const;
+  void WordVectorProbabilityAnyOrder(
+    const std::vector< int > &ContextSequence,
+    const std::vector< int > &Words,
+    std::vector< double > *BaseProbabilities
+  ) const;
+  int GetContextIdAnyOrder(
+    const std::vector< int > &ContextSequence
+  ) const;
+
+  // internal functions to walk through the restaurant tree for the fixed
+  // order of the hpylm
+  template<unsigned int FixedOrder>
+  bool AddWordFixedOrder(
+    const const_witerator &Word,
+    double BaseProbability
+  );
+  template<unsigned int FixedOrder>
+  WordRemoveStatus RemoveWordFixedOrder(
+    const const_witerator &Word
+  );
+  template<unsigned int FixedOrder>
+  double WordProbabilityFixedOrder(
+    const const_witerator &Word,
+    double BaseProbability
+  ) const;
+  template<unsigned int FixedOrder>
+  void WordVectorProbabilityFixedOrder(
+    const std::vector< int > &ContextSequence,
+    const std::vector< int > &Words,
+    std::vector< double > *BaseProbabilities
+  ) const;
+  template<unsigned int FixedOrder>
+  int GetContextIdFixedOrder(
+    const std::vector< int > &ContextSequence
+  ) const;
+
   // internal function to recursively add a word to the resaurant tree,
   // considdering its context  
   bool AddWordRecursively(
@@ -201,6 +304,36 @@ class HPYLM {
     std::vector< double > *BaseProbabilities
   ) const;
 
+  // internal function to get the log of the base probabilities scale for
+  // a word sequence with the given number of words
+  double BaseProbabilitiesScaleLoglikelihood(
+    std::size_t NumWords
+  ) const;
+
+  // internal function to find the restaurant for the context sequence of
+  // given length ending before Word, nullptr if it does not exist
+  HPYLM::ContextRestaurant *FindContext(
+    const const_witerator &Word,
+    unsigned int ContextLength
+  );
+
+  // internal function to recursively redirect the next context id of a word
+  // from OldContextId to NewContextId in the given restaurant and in all
+  // longer contexts containing the word (called if a context was created
+  // or removed, the given restaurant is the context preceding it)
+  void RedirectNextContextIdsRecursively(
+    HPYLM::ContextRestaurant *CurrentRestaurant,
+    int Word,
+    int OldContextId,
+    int NewContextId
+  );
+
+  // internal function to recursively set the next context ids of all words
+  // in the restaurant tree
+  void SetNextContextIdsRecursively(
+    HPYLM::ContextRestaurant *CurrentRestaurant
+  );
+
   // internal function to recursively search for the context id
   // of a given context sequence
   int GetContextIdRecursively(
@@ -238,6 +371,16 @@ class HPYLM {
     std::vector< int > *TotalContextcountPerLevel
   ) const;
 
+  // internal function to recursively get the bytes of the context
+  // restaurants, their hashmaps and their table vectors per level
+  void GetMemoryUsagePerLevelRecursively(
+    unsigned int level,
+    const HPYLM::ContextRestaurant &CurrentRestaurant,
+    std::vector< std::size_t > *NodeMemoryUsagePerLevel,
+    std::vector< std::size_t > *HashMapMemoryUsagePerLevel,
+    std::vector< std::size_t > *TableMemoryUsagePerLevel
+  ) const;
+
   // internal function to recursively claculate the word probabilities of
   // a word vector in the restaurant tree, considdering its context
   // and draw a word from those probabilities
@@ -250,6 +393,33 @@ class HPYLM {
     const std::vector< double > &BaseProbabilities
   ) const;
 
+  // internal function to recursively calculate the probabilities with which
+  // GenerateWordRecursively draws the words, a drawn PHI falls back to the
+  // draw in the shorter context
+  void GenerateWordProbabilitiesRecursively(
+    const const_witerator &Word,
+    const std::vector< int > &Words,
+    unsigned int level,
+    unsigned int ContextLenght,
+    const HPYLM::ContextRestaurant &CurrentRestaurant,
+    const std::vector< double > &BaseProbabilities,
+    std::vector< double > *WordProbabilities
+  ) const;
+
+  // internal function to recursively write the restaurant tree to a checkpoint
+  void WriteContextRecursively(
+    const HPYLM::ContextRestaurant &CurrentRestaurant,
+    CheckpointWriter *Writer
+  ) const;
+
+  // internal function to recursively rebuild the restaurant tree
+  // from a checkpoint
+  void ReadContextRecursively(
+    unsigned int level,
+    HPYLM::ContextRestaurant *CurrentRestaurant,
+    CheckpointReader *Reader
+  );
+
 public:
   /* constructors/destructors */
   // construct hpylm of given order
@@ -288,6 +458,15 @@ public:
     const google::dense_hash_map< int, double > &BaseProbabilities
   ) const;
 
+  // calculate the log likelihoods of the lexicographically sorted word
+  // sequences, the likelihood of the common prefix with the previous
+  // sequence is reused (like a depth first walk of a trie)
+  void SortedWordSequencesLoglikelihood(
+    const std::vector< const std::vector< int > * > &SortedWordSequences,
+    const google::dense_hash_map< int, double > &BaseProbabilities,
+    std::vector< double > *Loglikelihoods
+  ) const;
+
   // calculate the probability of a word in the hpylm
   int GetContextId(
     const std::vector<int> &ContextSequence
@@ -309,9 +488,11 @@ public:
   // Returns next free context id
   int GetNextUnusedContextId() const;
 
-  // return context sequence
-  const std::vector< int > &GetContextSequence(
-    int ContextId
+  // return context sequence (reconstructed from the keys of the restaurants
+  // on the path to the root)
+  void GetContextSequence(
+    int ContextId,
+    std::vector< int > *ContextSequence
   ) const;
 
   // return total word count per level
@@ -321,6 +502,16 @@ public:
   // get total number of contexts
   std::vector< int > GetTotalContextCountPerLevel() const;
 
+  // return bytes per level of the context restaurants ("Node"), their
+  // context and word hashmaps ("HashMap") or their table word count vectors
+  // ("Table")
+  std::vector< std::size_t > GetMemoryUsagePerLevel(
+    const std::string &Part
+  ) const;
+
+  // return bytes of the context id to context map and the freed ids
+  std::size_t GetContextIndexMemoryUsage() const;
+
   // draw one of the secified words according to their probabilites
   int GenerateWord(
     const std::vector< int > &ContextSequence,
@@ -329,6 +520,15 @@ public:
     bool SampleFromBase
   ) const;
 
+  // calculate the probabilities with which GenerateWord draws the specified
+  // words (with SampleFromBase, PHI gets probability zero)
+  void GenerateWordProbabilities(
+    const std::vector< int > &ContextSequence,
+    const std::vector< int > &Words,
+    const std::vector< double > &BaseProbabilities,
+    std::vector< double > *WordProbabilities
+  ) const;
+
   int GetBaseTablesPerWord(
     int WordId
   ) const;
@@ -348,6 +548,31 @@ public:
     int Level,
     double Value
   );
+
+  // seed the random generators of all hpylms and their restaurants
+  static void SeedRandomGenerators(
+    unsigned int Seed
+  );
+
+  // write discount, concentration and base probabilities scale
+  void WriteHyperParameters(
+    CheckpointWriter *Writer
+  ) const;
+
+  // replace discount, concentration and base probabilities scale
+  void ReadHyperParameters(
+    CheckpointReader *Reader
+  );
+
+  // write parameters and restaurant tree with table seating to checkpoint
+  void WriteCheckpoint(
+    CheckpointWriter *Writer
+  ) const;
+
+  // replace parameters and restaurant tree by the ones from the checkpoint
+  void ReadCheckpoint(
+    CheckpointReader *Reader
+  );
 };
 
 #endif
\ No newline at end of file
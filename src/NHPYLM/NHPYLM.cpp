@@ -41,6 +41,7 @@
    Author: Oliver Walter
 */
 // ----------------------------------------------------------------------------
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include "NHPYLM.hpp"
@@ -67,7 +68,8 @@ NHPYLM::NHPYLM(
   WordBaseProbability(WordBaseProbability_),
   CHPYLMBaseProbabilities(),
   WHPYLMBaseProbabilities(),
-  mtx()
+  mtx(),
+  Frozen(false)
 {
   CHPYLMBaseProbabilities.set_deleted_key(DELETED);
   CHPYLMBaseProbabilities.set_empty_key(EMPTY);
@@ -90,6 +92,8 @@ void NHPYLM::SetCharBaseProb(const int CharId, const double prob)
 
 void NHPYLM::AddWordToLm(const const_witerator &Word)
 {
+  CheckNotFrozen();
+
   /* debug */
 //   PrintDebugHeader << ": Adding word id " << *Word << " with context "<< "|";
 //   for(std::vector<int>::const_iterator it = Word - WHPYLMOrder + 1; it != Word; it++) {
@@ -171,6 +175,8 @@ void NHPYLM::AddCharacterSequenceToCHPYLM(const std::vector<int> &CharacterSeque
 
 bool NHPYLM::RemoveWordFromLm(const const_witerator &Word)
 {
+  CheckNotFrozen();
+
 //   /* debug */
 //   PrintDebugHeader << ": Removing Word with context from LM " << *Word << ":|";
 //   for(std::vector<int>::iterator it = Word - WHPYLMOrder + 1; it != Word; it++) {
@@ -210,20 +216,68 @@ void NHPYLM::RemoveCharacterSequenceFromCHPYLM(const std::vector<int> &Character
   WHPYLMBaseProbabilities.clear();
 }
 
+double NHPYLM::GetWHPYLMBaseProbability(int Word) const
+{
+  google::dense_hash_map<int, double>::const_iterator it = WHPYLMBaseProbabilities.find(Word);
+  if (it != WHPYLMBaseProbabilities.end()) {
+    return it->second;
+  }
+
+  double BaseProbability = exp(CHPYLM.WordSequenceLoglikelihood(GetWordVector(Word), CHPYLMBaseProbabilities));
+  if (!Frozen) {
+    WHPYLMBaseProbabilities.insert(std::make_pair(Word, BaseProbability));
+  }
+  return BaseProbability;
+}
+
+void NHPYLM::CalculateAllWHPYLMBaseProbabilities()
+{
+  if ((WordBaseProbability != 0.0) || (NumCharacters == 0) || (CHPYLMOrder == 0)) {
+    return;
+  }
+
+  /* sort the character sequences of the words which are not cached */
+  std::vector<std::pair<const std::vector<int> *, int> > Words;
+  for (Id2WordHashmap::const_iterator Word = GetId2Word().begin(); Word != GetId2Word().end(); ++Word) {
+    if (WHPYLMBaseProbabilities.find(Word->first) == WHPYLMBaseProbabilities.end()) {
+      Words.push_back(std::make_pair(&Word->second, Word->first));
+    }
+  }
+  std::sort(Words.begin(), Words.end(),
+            [](const std::pair<const std::vector<int> *, int> &a, const std::pair<const std::vector<int> *, int> &b) {
+              return *a.first < *b.first;
+            });
+  std::vector<const std::vector<int> *> SortedCharacterSequences;
+  SortedCharacterSequences.reserve(Words.size());
+  for (const std::pair<const std::vector<int> *, int> &Word : Words) {
+    SortedCharacterSequences.push_back(Word.first);
+  }
+
+  std::vector<double> Loglikelihoods(Words.size());
+  CHPYLM.SortedWordSequencesLoglikelihood(SortedCharacterSequences, CHPYLMBaseProbabilities, &Loglikelihoods);
+  for (std::size_t IdxWord = 0; IdxWord < Words.size(); ++IdxWord) {
+    WHPYLMBaseProbabilities.insert(std::make_pair(Words[IdxWord].second, exp(Loglikelihoods[IdxWord])));
+  }
+}
+
+void NHPYLM::CheckNotFrozen() const
+{
+  if (Frozen) {
+    throw std::runtime_error("Language model is frozen and cannot be modified");
+  }
+}
+
 double NHPYLM::WordProbability(const const_witerator &Word) const
 {
   /* get base probability for character sequence represting word and calculate word probability */
   double BaseProbability;
   if ((WordBaseProbability == 0.0) && (NumCharacters > 0) && (CHPYLMOrder > 0)) {
-    mtx.lock();
-    google::dense_hash_map<int, double>::const_iterator it = WHPYLMBaseProbabilities.find(*Word);
-    if (it == WHPYLMBaseProbabilities.end()) {
-      BaseProbability = exp(CHPYLM.WordSequenceLoglikelihood(GetWordVector(*Word), CHPYLMBaseProbabilities));
-      WHPYLMBaseProbabilities.insert(std::make_pair(*Word, BaseProbability));
+    if (Frozen) {
+      BaseProbability = GetWHPYLMBaseProbability(*Word);
     } else {
-      BaseProbability = it->second;
+      std::lock_guard<std::mutex> lck(mtx);
+      BaseProbability = GetWHPYLMBaseProbability(*Word);
     }
-    mtx.unlock();
   } else {
     BaseProbability = WordBaseProbability;
   }
@@ -240,7 +294,8 @@ std::vector<double> NHPYLM::WordVectorProbability(const std::vector< int > &Cont
   bool CalculateWHPYLMBaseProbabilities(
     (WordBaseProbability == 0.0) && (NumCharacters > 0) && (CHPYLMOrder > 0)
   );
-  if (CalculateWHPYLMBaseProbabilities) {
+  bool LockWHPYLMBaseProbabilities(CalculateWHPYLMBaseProbabilities && !Frozen);
+  if (LockWHPYLMBaseProbabilities) {
     mtx.lock();
   }
   
@@ -248,14 +303,7 @@ std::vector<double> NHPYLM::WordVectorProbability(const std::vector< int > &Cont
     double BaseProbability;
     if (*Word != PHI) {
       if (CalculateWHPYLMBaseProbabilities) {
-        google::dense_hash_map<int, double>::const_iterator it = WHPYLMBaseProbabilities.find(*Word);
-        if (it == WHPYLMBaseProbabilities.end()) {
-  //    std::cout << *Word << ":" << dict.get_word_vector(*Word).size() << std::endl;
-          BaseProbability = exp(CHPYLM.WordSequenceLoglikelihood(GetWordVector(*Word), CHPYLMBaseProbabilities));
-          WHPYLMBaseProbabilities.insert(std::make_pair(*Word, BaseProbability));
-        } else {
-          BaseProbability = it->second;
-        }
+        BaseProbability = GetWHPYLMBaseProbability(*Word);
       } else {
         BaseProbability = WordBaseProbability;
       }
@@ -264,7 +312,7 @@ std::vector<double> NHPYLM::WordVectorProbability(const std::vector< int > &Cont
       BaseProbabilites.push_back(0);
     }
   }
-  if (CalculateWHPYLMBaseProbabilities) {
+  if (LockWHPYLMBaseProbabilities) {
     mtx.unlock();
   }
   WHPYLM.WordVectorProbability(ContextSequence, Words, &BaseProbabilites);
@@ -291,8 +339,36 @@ double NHPYLM::WordSequenceLoglikelihood(const std::vector< int > &WordSequence)
   return WHPYLM.WordSequenceLoglikelihood(WordSequence, WHPYLMBaseProbabilities);
 }
 
+double NHPYLM::WordSequenceLoglikelihood(const std::vector< int > &WordSequence, google::dense_hash_map< int, double > *BaseProbabilities) const
+{
+  /* collect base probabilities, the cache of the model is only read */
+  bool CalculateWHPYLMBaseProbabilities(
+    (WordBaseProbability == 0.0) && (NumCharacters > 0) && (CHPYLMOrder > 0)
+  );
+  for (const_witerator Word = WordSequence.begin() + WHPYLMOrder - 1; Word != WordSequence.end(); ++Word) {
+    if (BaseProbabilities->find(*Word) != BaseProbabilities->end()) {
+      continue;
+    }
+    double BaseProbability = WordBaseProbability;
+    if (CalculateWHPYLMBaseProbabilities) {
+      google::dense_hash_map<int, double>::const_iterator it = WHPYLMBaseProbabilities.find(*Word);
+      if (it != WHPYLMBaseProbabilities.end()) {
+        BaseProbability = it->second;
+      } else {
+        BaseProbability = exp(CHPYLM.WordSequenceLoglikelihood(GetWordVector(*Word), CHPYLMBaseProbabilities));
+      }
+    }
+    BaseProbabilities->insert(std::make_pair(*Word, BaseProbability));
+  }
+
+  /* calculate word sequence likelihood */
+  return WHPYLM.WordSequenceLoglikelihood(WordSequence, *BaseProbabilities);
+}
+
 void NHPYLM::ResampleHyperParameters()
 {
+  CheckNotFrozen();
+
   if ((WordBaseProbability == 0.0) && (NumCharacters > 0) && (CHPYLMOrder > 0)) {
     CHPYLM.ResampleHyperParameters();
     WHPYLMBaseProbabilities.clear();
@@ -375,7 +451,9 @@ ContextToContextTransitions NHPYLM::GetTransitions(
         Transitions.Probabilities.push_back(0);
       }
     }
-    CHPYLM.WordVectorProbability(CHPYLM.GetContextSequence(ContextId), Transitions.Words, &Transitions.Probabilities);
+    std::vector<int> ContextSequence;
+    CHPYLM.GetContextSequence(ContextId, &ContextSequence);
+    CHPYLM.WordVectorProbability(ContextSequence, Transitions.Words, &Transitions.Probabilities);
   } else if (ContextId < FinalContextId) {
 //     std::cout << " (word id)" << std::endl;
     Transitions = WHPYLM.GetTransitions(ContextId - WordContextIdOffset, SentEndWordId, ActiveWords);
@@ -423,7 +501,9 @@ ContextToContextTransitions NHPYLM::GetTransitions(
       }
     }
 //     std::cout << "WHPYLMContextId: " << ContextId - WordContextIdOffset << std::endl;
-    Transitions.Probabilities = WordVectorProbability(WHPYLM.GetContextSequence(ContextId - WordContextIdOffset), Transitions.Words);
+    std::vector<int> ContextSequence;
+    WHPYLM.GetContextSequence(ContextId - WordContextIdOffset, &ContextSequence);
+    Transitions.Probabilities = WordVectorProbability(ContextSequence, Transitions.Words);
   } else {
 //     std::cout << " (sent end id)" << std::endl;
   }
@@ -467,6 +547,32 @@ std::vector< int > NHPYLM::GetTotalCountPerLevelFor(const std::string &LM, const
   }
 }
 
+std::vector< std::size_t > NHPYLM::GetMemoryUsagePerLevelFor(const std::string &LM, const std::string &Part) const
+{
+  if (LM == "CHPYLM") {
+    return CHPYLM.GetMemoryUsagePerLevel(Part);
+  } else if (LM == "WHPYLM") {
+    return WHPYLM.GetMemoryUsagePerLevel(Part);
+  } else {
+    return std::vector<std::size_t>();
+  }
+}
+
+std::size_t NHPYLM::GetMemoryUsageFor(const std::string &Part) const
+{
+  if (Part == "CHPYLMIndex") {
+    return CHPYLM.GetContextIndexMemoryUsage();
+  } else if (Part == "WHPYLMIndex") {
+    return WHPYLM.GetContextIndexMemoryUsage();
+  } else if (Part == "BaseProbabilities") {
+    std::lock_guard<std::mutex> lck(mtx);
+    return (CHPYLMBaseProbabilities.bucket_count() + WHPYLMBaseProbabilities.bucket_count()) *
+           sizeof(google::dense_hash_map<int, double>::value_type);
+  } else {
+    return Dictionary::GetMemoryUsageFor(Part);
+  }
+}
+
 std::vector< std::vector< int > > NHPYLM::Generate(std::string Mode, int NumWordsOrCharacters, int SentEndWordId, std::vector<double> *GeneratedWordLengthDistribution_) const
 {
   if (Mode == "CHPYLM") {
@@ -577,6 +683,98 @@ std::vector< std::vector< int > > NHPYLM::Generate(std::string Mode, int NumWord
   }
 }
 
+std::vector<double> NHPYLM::GetCHPYLMWordLengthDistribution(unsigned int MaxWordLength, double MinStateProbability) const
+{
+  /* build vector of character ids and base probabilities like for generation */
+  std::vector<int> CharacterIds(CharactersEnd - CharactersBegin, 0);
+  std::iota(CharacterIds.begin(), CharacterIds.end(), CharactersBegin);
+  CharacterIds.push_back(EOW);
+  CharacterIds.push_back(EOS);
+  CharacterIds.push_back(PHI);
+  std::vector<double> BaseProbabilites;
+  BaseProbabilites.reserve(CharacterIds.size());
+  for (std::vector<int>::iterator Character = CharacterIds.begin(); Character != CharacterIds.end(); ++Character) {
+    if (*Character != PHI) {
+      BaseProbabilites.push_back(CHPYLMBaseProbabilities.find(*Character)->second);
+    } else {
+      BaseProbabilites.push_back(0);
+    }
+  }
+
+  /* the draw only depends on the longest context found in the restaurant tree,
+   * so the probability mass is kept per context id, for every reached context
+   * the character probabilities and the following contexts are cached */
+  struct ContextTransitions {
+    std::vector<double> CharacterProbabilities;
+    std::vector<int> NextContextIds;
+  };
+  google::dense_hash_map<int, ContextTransitions> Transitions;
+  Transitions.set_empty_key(EMPTY);
+  google::dense_hash_map<int, double> ContextProbabilities;
+  ContextProbabilities.set_empty_key(EMPTY);
+  google::dense_hash_map<int, double> NextContextProbabilities;
+  NextContextProbabilities.set_empty_key(EMPTY);
+
+  /* every word (and every word after a sentence end) starts in the word end context */
+  const int WordBeginContextId = CHPYLM.GetContextId(std::vector<int>(CHPYLMOrder - 1, EOW));
+  ContextProbabilities[WordBeginContextId] = 1;
+  std::vector<int> ContextSequence;
+  std::vector<double> WordLengthDistribution(1, 0);
+  for (unsigned int WordLength = 1; (WordLength <= MaxWordLength) && !ContextProbabilities.empty(); WordLength++) {
+    WordLengthDistribution.push_back(0);
+    NextContextProbabilities.clear();
+    for (google::dense_hash_map<int, double>::const_iterator Context = ContextProbabilities.begin(); Context != ContextProbabilities.end(); ++Context) {
+      google::dense_hash_map<int, ContextTransitions>::iterator it = Transitions.find(Context->first);
+      if (it == Transitions.end()) {
+        it = Transitions.insert(std::make_pair(Context->first, ContextTransitions())).first;
+        CHPYLM.GetContextSequence(Context->first, &ContextSequence);
+        CHPYLM.GenerateWordProbabilities(ContextSequence, CharacterIds, BaseProbabilites, &it->second.CharacterProbabilities);
+
+        /* shift the character into the context, like in GetTransitions */
+        std::vector<int> NextContextSequence(ContextSequence);
+        if (NextContextSequence.size() == (CHPYLMOrder - 1)) {
+          NextContextSequence.erase(NextContextSequence.begin());
+        }
+        NextContextSequence.resize(NextContextSequence.size() + 1);
+        it->second.NextContextIds.reserve(CharacterIds.size());
+        for (std::vector<int>::iterator Character = CharacterIds.begin(); Character != CharacterIds.end(); ++Character) {
+          if ((CHPYLMOrder > 1) && (*Character != EOW) && (*Character != EOS) && (*Character != PHI)) {
+            NextContextSequence.back() = *Character;
+            it->second.NextContextIds.push_back(CHPYLM.GetContextId(NextContextSequence));
+          } else {
+            it->second.NextContextIds.push_back(WordBeginContextId);
+          }
+        }
+      }
+
+      /* a word end finishes the word, a sentence end restarts the context
+       * without finishing the word */
+      for (unsigned int IdxCharacter = 0; IdxCharacter < CharacterIds.size(); IdxCharacter++) {
+        double Probability = Context->second * it->second.CharacterProbabilities[IdxCharacter];
+        if (CharacterIds[IdxCharacter] == EOW) {
+          WordLengthDistribution.back() += Probability;
+        } else if (Probability > 0) {
+          NextContextProbabilities[it->second.NextContextIds[IdxCharacter]] += Probability;
+        }
+      }
+    }
+
+    /* drop contexts with negligible probability mass */
+    ContextProbabilities.clear();
+    for (google::dense_hash_map<int, double>::const_iterator Context = NextContextProbabilities.begin(); Context != NextContextProbabilities.end(); ++Context) {
+      if (Context->second >= MinStateProbability) {
+        ContextProbabilities.insert(*Context);
+      }
+    }
+  }
+
+  double Norm = std::accumulate(WordLengthDistribution.begin(), WordLengthDistribution.end(), 0.0);
+  for (double &WordLengthProbability : WordLengthDistribution) {
+    WordLengthProbability /= Norm;
+  }
+  return WordLengthDistribution;
+}
+
 void NHPYLM::SetWHPYLMBaseProbabilitiesScale(const std::vector< double > &WHPYLMBaseProbabilitiesScale)
 {
   CHPYLM.SetBaseProbabilitiesScale(WHPYLMBaseProbabilitiesScale);
@@ -618,4 +816,76 @@ NHPYLMParameters::NHPYLMParameters(const std::vector< double > &CHPYLMDiscount_,
   WHPYLMDiscount(WHPYLMDiscount_),
   WHPYLMConcentration(WHPYLMConcentration_)
 {
-}
\ No newline at end of file
+}
+
+void NHPYLM::WriteCheckpoint(CheckpointWriter *Writer) const
+{
+  Writer->Write<uint32_t>(CHPYLMOrder);
+  Writer->Write<uint32_t>(WHPYLMOrder);
+  Writer->Write<int32_t>(CharactersBegin);
+  Writer->Write<int32_t>(CharactersEnd);
+  Writer->Write<double>(WordBaseProbability);
+  Dictionary::WriteCheckpoint(Writer);
+  CHPYLM.WriteCheckpoint(Writer);
+  WHPYLM.WriteCheckpoint(Writer);
+  Writer->Write<uint64_t>(CHPYLMBaseProbabilities.size());
+  for (const auto &BaseProbability : CHPYLMBaseProbabilities) {
+    Writer->Write<int32_t>(BaseProbability.first);
+    Writer->Write<double>(BaseProbability.second);
+  }
+}
+
+void NHPYLM::ReadCheckpoint(CheckpointReader *Reader)
+{
+  CheckNotFrozen();
+
+  if ((Reader->Read<uint32_t>() != CHPYLMOrder) ||
+      (Reader->Read<uint32_t>() != WHPYLMOrder) ||
+      (Reader->Read<int32_t>() != CharactersBegin) ||
+      (Reader->Read<int32_t>() != CharactersEnd) ||
+      (Reader->Read<double>() != WordBaseProbability)) {
+    throw std::runtime_error("Checkpoint does not match language model");
+  }
+  Dictionary::ReadCheckpoint(Reader);
+  CHPYLM.ReadCheckpoint(Reader);
+  WHPYLM.ReadCheckpoint(Reader);
+  uint64_t NumBaseProbabilities = Reader->Read<uint64_t>();
+  CHPYLMBaseProbabilities.clear();
+  for (uint64_t IdxBaseProbability = 0; IdxBaseProbability < NumBaseProbabilities; ++IdxBaseProbability) {
+    int CharacterId = Reader->Read<int32_t>();
+    CHPYLMBaseProbabilities[CharacterId] = Reader->Read<double>();
+  }
+
+  /* word base probabilities are a cache of the character model */
+  WHPYLMBaseProbabilities.clear();
+}
+
+void NHPYLM::WriteHyperParameters(CheckpointWriter *Writer) const
+{
+  CHPYLM.WriteHyperParameters(Writer);
+  WHPYLM.WriteHyperParameters(Writer);
+}
+
+void NHPYLM::ReadHyperParameters(CheckpointReader *Reader)
+{
+  CheckNotFrozen();
+
+  CHPYLM.ReadHyperParameters(Reader);
+  WHPYLM.ReadHyperParameters(Reader);
+
+  /* word base probabilities depend on the character model parameters */
+  WHPYLMBaseProbabilities.clear();
+}
+
+void NHPYLM::Freeze()
+{
+  if (!Frozen) {
+    CalculateAllWHPYLMBaseProbabilities();
+  }
+  Frozen = true;
+}
+
+bool NHPYLM::IsFrozen() const
+{
+  return Frozen;
+}
@@ -90,6 +90,8 @@ class NHPYLM: public Dictionary {
   mutable google::dense_hash_map<int, double> WHPYLMBaseProbabilities;
   // mutex to allow multi threading
   mutable std::mutex mtx;
+  // model is read only, word base probabilities are read without locking
+  bool Frozen;
 
   /* some internal functions */
   // Add the character sequence of a word to the character language model
@@ -102,6 +104,20 @@ class NHPYLM: public Dictionary {
     const std::vector<int> &CharacterSequence
   );
 
+  // get base probability of a word from the cache or the character
+  // language model (the cache is only filled if the model is not frozen)
+  double GetWHPYLMBaseProbability(
+    int Word
+  ) const;
+
+  // calculate the base probabilities of all words in the dictionary which are
+  // not cached before freezing, the character sequences are sorted so that
+  // words with a common prefix share its likelihood
+  void CalculateAllWHPYLMBaseProbabilities();
+
+  // throw if the model is frozen
+  void CheckNotFrozen() const;
+
 public:
   /* constructor */
   // construct nested hierarchical pitman yor language model
@@ -149,6 +165,14 @@ public:
   double WordSequenceLoglikelihood(
     const std::vector< int > &WordSequence
   ) const;
+
+  // calculate log likelihood of a word sequence without modifying the model,
+  // base probabilities missing in the cache of the model are calculated into
+  // BaseProbabilities (thread safe as long as the model is not modified)
+  double WordSequenceLoglikelihood(
+    const std::vector< int > &WordSequence,
+    google::dense_hash_map<int, double> *BaseProbabilities
+  ) const;
   
   // Resample hyper parameters of the hierarchical models
   void ResampleHyperParameters();
@@ -189,6 +213,19 @@ public:
     const std::string &CountName
   ) const;
 
+  // get bytes per level for given LM ("CHPYLM"|"WHPYLM") and part
+  // ("Node"|"HashMap"|"Table")
+  std::vector<std::size_t> GetMemoryUsagePerLevelFor(
+    const std::string &LM,
+    const std::string &Part
+  ) const;
+
+  // get bytes of the context indices ("CHPYLMIndex"|"WHPYLMIndex"), the
+  // cached base probabilities ("BaseProbabilities") or the dictionary parts
+  std::size_t GetMemoryUsageFor(
+    const std::string &Part
+  ) const;
+
   // generate character or word sequences from the language models
   std::vector<std::vector<int> > Generate(
     std::string Mode,
@@ -197,6 +234,15 @@ public:
     std::vector<double> *GeneratedWordLengthDistribution_
   ) const;
   
+  // calculate the length distribution of the words generated by the CHPYLM
+  // (lengths include the word end) by propagating the probability mass over
+  // the context states, lengths above MaxWordLength and states with less
+  // than MinStateProbability are truncated, the distribution is normalized
+  std::vector<double> GetCHPYLMWordLengthDistribution(
+    unsigned int MaxWordLength,
+    double MinStateProbability
+  ) const;
+
   void SetWHPYLMBaseProbabilitiesScale(
     const std::vector<double> &WHPYLMBaseProbabilitiesScale_
   );
@@ -218,6 +264,37 @@ public:
     int Level,
     double Value
   );
+
+  // write dictionary, both hierarchical models and base probabilities
+  // to checkpoint
+  void WriteCheckpoint(
+    CheckpointWriter *Writer
+  ) const;
+
+  // write the hyper parameters of both hierarchical models, e.g. to
+  // transfer them to the model of another process
+  void WriteHyperParameters(
+    CheckpointWriter *Writer
+  ) const;
+
+  // replace the hyper parameters of both hierarchical models
+  void ReadHyperParameters(
+    CheckpointReader *Reader
+  );
+
+  // make the model read only: the base probabilities of all words are
+  // calculated once and the probability calculations no longer lock,
+  // adding or removing words or resampling hyper parameters throws
+  void Freeze();
+
+  // return true if the model is read only
+  bool IsFrozen() const;
+
+  // replace the complete model state by the one from the checkpoint
+  // (the model has to be constructed with the same orders and symbols)
+  void ReadCheckpoint(
+    CheckpointReader *Reader
+  );
 };
 
 #endif
\ No newline at end of file
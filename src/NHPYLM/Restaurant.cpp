@@ -244,6 +244,32 @@ std::vector<int> Restaurant::GetWords(const std::vector<bool> &ActiveWords) cons
   return WordsInContext;
 }
 
+void Restaurant::GetWordsAndNextContextIds(const std::vector<bool> &ActiveWords, std::vector<int> *WordsInContext, std::vector<int> *NextContextIds) const
+{
+  WordsInContext->reserve(Words.size() + 1);
+  NextContextIds->reserve(Words.size() + 1);
+  for (WordsHashmap::const_iterator Word = Words.begin(); Word != Words.end(); ++Word) {
+    if (ActiveWords.empty() || ActiveWords[Word->first]) {
+      WordsInContext->push_back(Word->first);
+      NextContextIds->push_back(Word->second.NextContextId);
+    }
+  }
+}
+
+int Restaurant::GetNextContextId(int Word) const
+{
+  WordsHashmap::const_iterator it = Words.find(Word);
+  if (it == Words.end()) {
+    return EMPTY;
+  }
+  return it->second.NextContextId;
+}
+
+void Restaurant::SetNextContextId(int Word, int NextContextId)
+{
+  Words.find(Word)->second.NextContextId = NextContextId;
+}
+
 double Restaurant::GetTotalWordCount() const
 {
   return TotalWordCount;
@@ -254,6 +280,20 @@ double Restaurant::GetTotalTableCount() const
   return TotalTableCount;
 }
 
+std::size_t Restaurant::GetHashMapMemoryUsage() const
+{
+  return Words.bucket_count() * sizeof(WordsHashmap::value_type);
+}
+
+std::size_t Restaurant::GetTableMemoryUsage() const
+{
+  std::size_t MemoryUsage = 0;
+  for (WordsHashmap::const_iterator it = Words.begin(); it != Words.end(); ++it) {
+    MemoryUsage += it->second.TableWordcount.capacity() * sizeof(unsigned int);
+  }
+  return MemoryUsage;
+}
+
 int Restaurant::GetTablesPerWord(int WordId) const
 {
 //   std::cout << "GetTablesPerWord(" << WordId << ") = ";
@@ -270,6 +310,40 @@ int Restaurant::GetTablesPerWord(int WordId) const
 Restaurant::WordTableGroup::WordTableGroup() :
   Wordcount(0),
   TableWordcount(),
-  GroupTableCount(0)
+  GroupTableCount(0),
+  NextContextId(EMPTY)
+{
+}
+
+void Restaurant::WriteCheckpoint(CheckpointWriter *Writer) const
+{
+  Writer->Write<uint32_t>(TotalWordCount);
+  Writer->Write<uint32_t>(TotalTableCount);
+  Writer->Write<uint64_t>(Words.size());
+  for (WordsHashmap::const_iterator it = Words.begin(); it != Words.end(); ++it) {
+    Writer->Write<int32_t>(it->first);
+    Writer->Write<uint32_t>(it->second.Wordcount);
+    Writer->Write<uint32_t>(it->second.GroupTableCount);
+    Writer->WriteVector(it->second.TableWordcount);
+  }
+}
+
+void Restaurant::ReadCheckpoint(CheckpointReader *Reader)
 {
-}
\ No newline at end of file
+  TotalWordCount = Reader->Read<uint32_t>();
+  TotalTableCount = Reader->Read<uint32_t>();
+  uint64_t NumWords = Reader->Read<uint64_t>();
+  Words.clear();
+  Words.resize(NumWords);
+  for (uint64_t IdxWord = 0; IdxWord < NumWords; ++IdxWord) {
+    WordTableGroup &TableGroup = Words[Reader->Read<int32_t>()];
+    TableGroup.Wordcount = Reader->Read<uint32_t>();
+    TableGroup.GroupTableCount = Reader->Read<uint32_t>();
+    Reader->ReadVector(&TableGroup.TableWordcount);
+  }
+}
+
+void Restaurant::SeedRandomGenerator(unsigned int Seed)
+{
+  RandomGenerator.seed(Seed);
+}
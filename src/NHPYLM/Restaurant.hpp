@@ -62,6 +62,7 @@
 
 #include <random>
 #include "definitions.hpp"
+#include "Checkpoint.hpp"
 
 /*
  * class for one restaurant containing the different words
@@ -74,6 +75,7 @@ class Restaurant {
     unsigned int Wordcount;                   // Number of times the Word exists in the WordTableGroup
     std::vector<unsigned int> TableWordcount; // Wordcount for the Word in each table in the WordTableGroup
     unsigned int GroupTableCount;             // Number of ocupied tables in WordTableGroup
+    int NextContextId;                        // Id of the context following the Word (maintained by the HPYLM)
     WordTableGroup();                         // Constructor: initialite wordtablegroup to default values
   };
   typedef google::dense_hash_map <int, WordTableGroup> WordsHashmap; // hashmap mapping from int to WordTableGroup
@@ -104,9 +106,17 @@ public:
   double GetYuiSum() const;                                              // Sum over auxiliary variables Yui
   double GetLogXu() const;                                               // Sum over auxiliary variables log(Xu)
   std::vector<int> GetWords(const std::vector<bool> &ActiveWords) const; // Return all words in this restaurant
+  void GetWordsAndNextContextIds(const std::vector<bool> &ActiveWords, std::vector<int> *WordsInContext, std::vector<int> *NextContextIds) const; // Return all words in this restaurant and the ids of the contexts following them
+  int GetNextContextId(int Word) const;                                  // return id of the context following the word, EMPTY if the word is not in the restaurant
+  void SetNextContextId(int Word, int NextContextId);                    // set id of the context following the word (the word has to be in the restaurant)
   double GetTotalWordCount() const;                                      // return total number of words in restaurant
   double GetTotalTableCount() const;                                     // return total number of tables in restaurant
   int GetTablesPerWord(int WordId) const;                                // return totoal number of tables per word
+  std::size_t GetHashMapMemoryUsage() const;                             // return bytes of the word hashmap buckets
+  std::size_t GetTableMemoryUsage() const;                               // return bytes of the table word count vectors
+  void WriteCheckpoint(CheckpointWriter *Writer) const;                  // write table seating to checkpoint
+  void ReadCheckpoint(CheckpointReader *Reader);                         // restore table seating from checkpoint
+  static void SeedRandomGenerator(unsigned int Seed);                    // seed the random generator shared by all restaurants
 };
 
 #endif
@@ -101,6 +101,9 @@ NHPYLMFst::Weight NHPYLMFst::Final(StateId s) const
 size_t NHPYLMFst::NumArcs(StateId s) const
 {
 //   PrintDebugHeader << " - State: " << s << " NumArcs: " << Arcs.at(s).size() << std::endl;
+  if (Arcs->IsExpanded(s)) {
+    return Arcs->at(s).size();
+  }
   std::lock_guard<std::mutex> lck(Arcs->GetMutex(s));
   return Arcs->at(s).size();
 }
@@ -183,11 +186,31 @@ void NHPYLMFst::InitArcIterator(NHPYLMFst::StateId s, fst::ArcIteratorData< fst:
 //   PrintDebugHeader << " - State: " << s << " narcs: " << data->narcs << std::endl;
 }
 
+std::size_t NHPYLMFst::GetNumExpandedStates() const
+{
+  return Arcs->GetNumExpandedStates();
+}
+
+std::size_t NHPYLMFst::GetNumExpandedArcs() const
+{
+  return Arcs->GetNumExpandedArcs();
+}
+
+std::size_t NHPYLMFst::GetMemoryUsage() const
+{
+  return Arcs->GetMemoryUsage();
+}
+
 const fst::LogArc *NHPYLMFst::GetArcs(StateId s) const
 {
 //   PrintDebugHeader << " - State: " << s << std::endl;
+  /* arcs of expanded states are never modified again, so they are shared
+   * between all threads without locking */
+  if (Arcs->IsExpanded(s)) {
+    return Arcs->at(s).data();
+  }
   Arcs->lock(s);
-  if (Arcs->at(s).size() == 0) {
+  if (!Arcs->IsExpanded(s)) {
     std::vector<fst::LogArc> &State = Arcs->at(s);
     ContextToContextTransitions Transitions = LanguageModel.GetTransitions(s, SentEndWordId, ActiveWords, ReturnToContextId, AvailableWords);
     int NumTransitions = Transitions.NextContextIds.size();
@@ -200,6 +223,7 @@ const fst::LogArc *NHPYLMFst::GetArcs(StateId s) const
       }
     }
     std::sort(State.begin(), State.end(), NHPYLMFst::iLabelSort);
+    Arcs->SetExpanded(s);
   }
   Arcs->unlock(s);
   return Arcs->at(s).data();
@@ -214,7 +238,10 @@ NHPYLMFst::ArcsContainer::ArcsContainer(
   int NumElements
 ) : 
   Arcs(NumElements),
-  mtxs(NumElements)
+  mtxs(NumElements),
+  Expanded(NumElements),
+  NumExpandedStates(0),
+  NumExpandedArcs(0)
 {
 
 }
@@ -238,3 +265,38 @@ std::mutex& NHPYLMFst::ArcsContainer::GetMutex(int Idx)
 {
   return mtxs.at(Idx);
 }
+
+bool NHPYLMFst::ArcsContainer::IsExpanded(int Idx) const
+{
+  return Expanded[Idx].load(std::memory_order_acquire);
+}
+
+void NHPYLMFst::ArcsContainer::SetExpanded(int Idx)
+{
+  NumExpandedStates.fetch_add(1, std::memory_order_relaxed);
+  NumExpandedArcs.fetch_add(Arcs[Idx].size(), std::memory_order_relaxed);
+  Expanded[Idx].store(true, std::memory_order_release);
+}
+
+std::size_t NHPYLMFst::ArcsContainer::GetNumExpandedStates() const
+{
+  return NumExpandedStates.load(std::memory_order_relaxed);
+}
+
+std::size_t NHPYLMFst::ArcsContainer::GetNumExpandedArcs() const
+{
+  return NumExpandedArcs.load(std::memory_order_relaxed);
+}
+
+std::size_t NHPYLMFst::ArcsContainer::GetMemoryUsage() const
+{
+  // the arcs of expanded states are read only
+  std::size_t MemoryUsage = Arcs.size() * (sizeof(std::vector<fst::LogArc>) +
+    sizeof(std::mutex) + sizeof(std::atomic<bool>));
+  for (std::size_t Idx = 0; Idx < Arcs.size(); ++Idx) {
+    if (IsExpanded(Idx)) {
+      MemoryUsage += Arcs[Idx].capacity() * sizeof(fst::LogArc);
+    }
+  }
+  return MemoryUsage;
+}
@@ -63,6 +63,7 @@
 #include <fst/fst.h>
 #include "NHPYLM/NHPYLM.hpp"
 #include "definitions.hpp"
+#include <atomic>
 #include <memory>
 #include <mutex>
 
@@ -71,6 +72,9 @@ class NHPYLMFst : public fst::Fst<fst::LogArc> {
   class ArcsContainer {
     std::vector<std::vector<fst::LogArc> > Arcs;
     std::vector<std::mutex> mtxs;
+    std::vector<std::atomic<bool> > Expanded; // arcs of state are complete and read only
+    std::atomic<std::size_t> NumExpandedStates; // number of expanded states (for the cost profile)
+    std::atomic<std::size_t> NumExpandedArcs;   // number of arcs of the expanded states
 
   public:
     ArcsContainer(int NumElements);
@@ -78,6 +82,11 @@ class NHPYLMFst : public fst::Fst<fst::LogArc> {
     void lock(int Idx);
     void unlock(int Idx);
     std::mutex& GetMutex(int Idx);
+    bool IsExpanded(int Idx) const;
+    void SetExpanded(int Idx);
+    std::size_t GetNumExpandedStates() const;
+    std::size_t GetNumExpandedArcs() const;
+    std::size_t GetMemoryUsage() const; // bytes of the per state entries and the arcs of the expanded states
   };
   typedef fst::LogArc::StateId StateId; // state ids
   typedef fst::LogArc::Weight Weight;   // weights
@@ -92,7 +101,7 @@ class NHPYLMFst : public fst::Fst<fst::LogArc> {
   const int FinalContextId;       // id of final context
   const uint64 FSTProperties;     // properties of fst
   const std::string FSTType;      // type of fst
-  const std::vector<bool> ActiveWords; // vector indicating active words
+  const std::vector<bool> &ActiveWords; // vector indicating active words (not owned, has to outlive the fst)
   const int FallbackSymbolId;     // the fallback symbol id used for input symbols (either EPS or PHI)
   const bool ReturnToStart;       // return to start context after SentEndWordId or terminate in final context
   const int ReturnToContextId;    // context id to return to after SentEndWordId
@@ -124,6 +133,16 @@ public:
     std::shared_ptr<ArcsContainer> Arcs_ = nullptr
   );
 
+  // the active words are only referenced, so they must not be a temporary
+  NHPYLMFst(
+    const NHPYLM &LanguageModel_,
+    int SentEndWordId_,
+    std::vector<bool> &&ActiveWords_,
+    bool ReturnToStart_ = false,
+    const std::vector<int> &AvailableWords_ = std::vector<int>(),
+    std::shared_ptr<ArcsContainer> Arcs_ = nullptr
+  ) = delete;
+
 
   /* interface */
   // Initial state
@@ -176,6 +195,16 @@ public:
   void InitArcIterator(
     StateId s, fst::ArcIteratorData<fst::LogArc> *data
   ) const;
+
+  // number of states expanded so far (shared with all copies)
+  std::size_t GetNumExpandedStates() const;
+
+  // number of arcs generated by the expansions so far
+  std::size_t GetNumExpandedArcs() const;
+
+  // bytes of the arcs container (shared with all copies), states which are
+  // still being expanded only count with their per state entry
+  std::size_t GetMemoryUsage() const;
 };
 
 #endif
\ No newline at end of file
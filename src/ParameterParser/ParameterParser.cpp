@@ -162,6 +162,37 @@ ParameterParser::ParameterParser(int argc, const char **argv):
       Parameters.AMScoreShift = atof(argv[++argPos]);
     } else if (!strcmp(argv[argPos], "-ReadNodeTimes")) {
       Parameters.ReadNodeTimes = true;
+    } else if (!strcmp(argv[argPos], "-WriteCorpus")) {
+      Parameters.WriteCorpusFile = argv[++argPos];
+    } else if (!strcmp(argv[argPos], "-ReadCorpus")) {
+      Parameters.ReadCorpusFile = argv[++argPos];
+    } else if (!strcmp(argv[argPos], "-CandidateIndexLength")) {
+      Parameters.CandidateIndexLength = atoi(argv[++argPos]);
+    } else if (!strcmp(argv[argPos], "-Checkpoint")) {
+      Parameters.CheckpointFile = argv[++argPos];
+      Parameters.CheckpointInterval = atoi(argv[++argPos]);
+    } else if (!strcmp(argv[argPos], "-Resume")) {
+      Parameters.ResumeFile = argv[++argPos];
+    } else if (!strcmp(argv[argPos], "-Decode")) {
+      Parameters.DecodeFile = argv[++argPos];
+    } else if (!strcmp(argv[argPos], "-Serve")) {
+      Parameters.ServeSocket = argv[++argPos];
+    } else if (!strcmp(argv[argPos], "-ServeBatchSize")) {
+      Parameters.ServeBatchSize = atoi(argv[++argPos]);
+    } else if (!strcmp(argv[argPos], "-AsyncEvaluation")) {
+      Parameters.AsyncEvaluation = true;
+    } else if (!strcmp(argv[argPos], "-Shards")) {
+      Parameters.NumShards = atoi(argv[++argPos]);
+      Parameters.ShardSyncInterval = atoi(argv[++argPos]);
+    } else if (!strcmp(argv[argPos], "-Trace")) {
+      Parameters.TraceFile = argv[++argPos];
+      Parameters.TraceCapacity = atoi(argv[++argPos]);
+    } else if (!strcmp(argv[argPos], "-CostProfile")) {
+      Parameters.CostProfile = true;
+    } else if (!strcmp(argv[argPos], "-TimingStatistics")) {
+      Parameters.TimingStatisticsFile = argv[++argPos];
+    } else if (!strcmp(argv[argPos], "-PerfCounters")) {
+      Parameters.PerfCounters = true;
     } else if (!strcmp(argv[argPos], "-WordData")) {
       Parameters.InitLM = true;
       Parameters.UseDictFile = true;
@@ -195,6 +226,28 @@ ParameterParser::ParameterParser(int argc, const char **argv):
     DieOnHelp(err.str());
   }
 
+  // Terminate if the server should be started without a model
+  if (!Parameters.ServeSocket.empty() && Parameters.DecodeFile.empty()) {
+    std::ostringstream err;
+    err << "Illegal option: The server requires a model (-Decode)!";
+    DieOnHelp(err.str());
+  }
+
+  // Terminate if sharded sampling should be combined with decoding
+  if ((Parameters.NumShards > 0) && !Parameters.DecodeFile.empty()) {
+    std::ostringstream err;
+    err << "Illegal option: Sharded sampling (-Shards) cannot be combined"
+        << " with decoding (-Decode)!";
+    DieOnHelp(err.str());
+  }
+
+  // Terminate if the shards never exchange their segmentations
+  if ((Parameters.NumShards > 0) && (Parameters.ShardSyncInterval < 1)) {
+    std::ostringstream err;
+    err << "Illegal option: The sync interval of the shards has to be at least 1!";
+    DieOnHelp(err.str());
+  }
+
   // load the input files, either from the list or from the parameters
   if (!Parameters.InputFilesList.empty()) {
     ReadFilesFromFileList(Parameters.InputFilesList);
@@ -265,6 +318,40 @@ void ParameterParser::DieOnHelp(const std::string& err) const
             << "                             0: off, >0 number of iteration (Parameter: -DeactivateCharacterModel NumIter)" << std::endl
             << "  -HTKLMScale:           Language model scaling factor when reading HTK lattices (Parameter: -HTKLMScale K (0))" << std::endl
             << "  -ReadNodeTimes;        Read node timing informations from HTK lattice" << std::endl
+            << "  -WriteCorpus:          Write the preprocessed input lattices, symbols and arc infos to a binary corpus file" << std::endl
+            << "                         (-WriteCorpus CorpusFileName ())" << std::endl
+            << "  -ReadCorpus:           Read the preprocessed input lattices, symbols and arc infos from a binary corpus file" << std::endl
+            << "                         written with -WriteCorpus instead of the input files (-ReadCorpus CorpusFileName ())" << std::endl
+            << "  -CandidateIndexLength: Index character sequences up to this length in the input lattices once and derive the" << std::endl
+            << "                         candidate words of a lattice from the index instead of the lexicon composition." << std::endl
+            << "                         0: off (Parameter: -CandidateIndexLength N (0))" << std::endl
+            << "  -Checkpoint:           Write the complete sampler state to a binary checkpoint file every N iterations." << std::endl
+            << "                         The file is written in the background. (-Checkpoint CheckpointFileName N ())" << std::endl
+            << "  -Resume:               Restore the sampler state from a checkpoint written with -Checkpoint and continue with" << std::endl
+            << "                         the next iteration (-Resume CheckpointFileName ())" << std::endl
+            << "  -Decode:               Segment the input once with the model from a checkpoint written with -Checkpoint." << std::endl
+            << "                         The model is not updated, uses Viterbi decoding if -UseViterby is set. The input" << std::endl
+            << "                         symbols have to match the training symbols (see -SymbolFile) (-Decode CheckpointFileName ())" << std::endl
+            << "  -Serve:                Keep the model of -Decode loaded and segment lattices sent over a unix domain socket" << std::endl
+            << "                         instead of the input files. Requests: 'SEGMENT <slf|fst> <name> <bytes>' followed by the" << std::endl
+            << "                         lattice file, 'STATS' (latency percentiles) and 'SHUTDOWN' (-Serve SocketPath ())" << std::endl
+            << "  -ServeBatchSize:       Maximum number of queued requests of all clients segmented together (-ServeBatchSize N (16))" << std::endl
+            << "  -AsyncEvaluation:      Write the sentences and calculate WER and PER of an iteration on a copy of the results in" << std::endl
+            << "                         the background while the next iteration is sampled (-AsyncEvaluation (false))" << std::endl
+            << "  -Shards:               Sample disjoint parts of the corpus in N processes with their own model. The" << std::endl
+            << "                         processes exchange their segmentations after K sentences each and update their" << std::endl
+            << "                         models with them. 0: off (-Shards N K (0 1))" << std::endl
+            << "  -Trace:                Record the last N intervals of every timer (phases per batch, sentences per thread)" << std::endl
+            << "                         and write them as trace event json for chrome://tracing or Perfetto at the end" << std::endl
+            << "                         (-Trace TraceFileName N ())" << std::endl
+            << "  -CostProfile:          Write the lattice sizes, language model fst expansion, composition size and times of" << std::endl
+            << "                         every sampled sentence to a csv file per iteration and print their percentiles" << std::endl
+            << "                         (-CostProfile (false))" << std::endl
+            << "  -TimingStatistics:     Write the accumulated durations of all timers as csv at the end" << std::endl
+            << "                         (-TimingStatistics FileName ())" << std::endl
+            << "  -PerfCounters:         Count cycles, instructions, last level cache and branch misses of every timed phase" << std::endl
+            << "                         per thread (perf_event_open) and print them with the timing statistics" << std::endl
+            << "                         (-PerfCounters (false))" << std::endl
             << "  -WordData:             Use init transciptions and a pronounciation dictionary for initialization." // TODO: Thoams - Add parameter decription
             << "This needs SentenceFile and PronDictFile as additional inputs." << std::endl;
 
@@ -363,6 +450,23 @@ ParameterStruct::ParameterStruct() :
   DeactivateCharacterModel(0),
   HTKLMScale(0),
   AMScoreShift(0),
-  ReadNodeTimes(false)
+  ReadNodeTimes(false),
+  WriteCorpusFile(),
+  ReadCorpusFile(),
+  CandidateIndexLength(0),
+  CheckpointFile(),
+  CheckpointInterval(0),
+  ResumeFile(),
+  DecodeFile(),
+  ServeSocket(),
+  ServeBatchSize(16),
+  AsyncEvaluation(false),
+  NumShards(0),
+  ShardSyncInterval(1),
+  TraceFile(),
+  TraceCapacity(0),
+  CostProfile(false),
+  TimingStatisticsFile(),
+  PerfCounters(false)
 {
 }
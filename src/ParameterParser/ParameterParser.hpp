@@ -111,6 +111,23 @@ struct ParameterStruct {
   double HTKLMScale;                    // Language model scaling factor when reading HTK lattices (Parameter: -HTKLMScale K (0))
   double AMScoreShift;                  // Normalize AM scores with additive shift constant
   bool ReadNodeTimes;                   // Read node timing informations from HTK lattice
+  std::string WriteCorpusFile;          // write the preprocessed input lattices to a binary corpus file (Parameter: -WriteCorpus CorpusFileName ())
+  std::string ReadCorpusFile;           // read the preprocessed input lattices from a binary corpus file (Parameter: -ReadCorpus CorpusFileName ())
+  unsigned int CandidateIndexLength;    // Maximum word length of the lattice candidate word index. 0: off (Parameter: -CandidateIndexLength N (0))
+  std::string CheckpointFile;           // file for the sampler state checkpoint (Parameter: -Checkpoint CheckpointFileName N ())
+  unsigned int CheckpointInterval;      // write checkpoint every N iterations. 0: off
+  std::string ResumeFile;               // resume sampling from checkpoint file (Parameter: -Resume CheckpointFileName ())
+  std::string DecodeFile;               // segment the input with the frozen model from checkpoint file (Parameter: -Decode CheckpointFileName ())
+  std::string ServeSocket;              // answer segmentation requests on this unix domain socket, needs -Decode (Parameter: -Serve SocketPath ())
+  unsigned int ServeBatchSize;          // maximum number of requests segmented together by the server (Parameter: -ServeBatchSize N (16))
+  bool AsyncEvaluation;                 // evaluate an iteration in the background while the next one is sampled (Parameter: -AsyncEvaluation (false))
+  unsigned int NumShards;               // number of processes sampling disjoint parts of the corpus. 0: off (Parameter: -Shards N K (0 1))
+  unsigned int ShardSyncInterval;       // number of sentences sampled by each process between exchanging the segmentations
+  std::string TraceFile;                // write a timeline of the timed phases as trace event json (Parameter: -Trace TraceFileName N ())
+  unsigned int TraceCapacity;           // number of last intervals kept per timer for the trace
+  bool CostProfile;                     // write the per sentence costs of the sampling of each iteration (Parameter: -CostProfile (false))
+  std::string TimingStatisticsFile;     // write the accumulated timer durations as csv at the end (Parameter: -TimingStatistics FileName ())
+  bool PerfCounters;                    // count cycles, instructions, cache and branch misses per timed phase (Parameter: -PerfCounters (false))
 
   ParameterStruct(); // constructor to set default values
 };
@@ -151,6 +151,25 @@ void ParseLib::ParseSampleAndAddCharacterIdSequenceToDictionaryLexFstAndLM(
   LanguageModel->AddWordSequenceToLm(*Sentence);
 }
 
+void ParseLib::AddCharacterIdSequencesToDictionaryLexFstAndLM(
+  const vector< vector< int > > &Words,
+  int SentEndWordId,
+  NHPYLM *LanguageModel,
+  LexFst *LexiconTransducer,
+  vector< WordId > *Sentence)
+{
+  int WHPYLMContextLenght = LanguageModel->GetWHPYLMOrder() - 1;
+  Sentence->assign(WHPYLMContextLenght, SentEndWordId);
+  for (const vector< int > &Characters : Words) {
+    Sentence->push_back(AddCharacterIdSequenceToDictionaryAndLexFST(
+      Characters,
+      LanguageModel,
+      LexiconTransducer
+    ));
+  }
+  LanguageModel->AddWordSequenceToLm(*Sentence);
+}
+
 // Copyright 2010, Graham Neubig, modified by Jahn Heymann (2013) and Oliver Walter (2014) //
 void ParseLib::ParseSampleAndAddCharacterIdSequenceToDictionaryAndLexFst(
   const fst::Fst< fst::LogArc > &Sample,
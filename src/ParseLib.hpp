@@ -140,6 +140,16 @@ public:
     const std::vector< ArcInfo >& InputArcInfos
   );
 
+  // add words given by their character id sequences to dictionary and
+  // language model, also add new character id sequences to lexicon transducer
+  static void AddCharacterIdSequencesToDictionaryLexFstAndLM(
+    const std::vector< std::vector< int > > &Words,
+    int SentEndWordId,
+    NHPYLM* LanguageModel,
+    LexFst* LexiconTransducer,
+    std::vector< WordId >* Sentence
+  );
+
   // parse character lattice and add word ids to dictionary and return std::vector of
   // word Ids
   static void ParseSampleAndAddCharacterIdSequenceToDictionary(
@@ -0,0 +1,202 @@
+// ----------------------------------------------------------------------------
+/**
+   File: PerfCounters.cpp
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+*/
+#include <atomic>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "PerfCounters.hpp"
+
+namespace {
+
+// counters are only read after Enable succeeded
+std::atomic<bool> Enabled(false);
+
+// hardware events of the counters (in the order of PerfCounterValues)
+const std::uint64_t CounterEvents[PerfCounterValues::NUM_COUNTERS] = {
+  PERF_COUNT_HW_CPU_CYCLES,
+  PERF_COUNT_HW_INSTRUCTIONS,
+  PERF_COUNT_HW_CACHE_MISSES,
+  PERF_COUNT_HW_BRANCH_MISSES
+};
+
+const char *CounterNames[PerfCounterValues::NUM_COUNTERS] = {
+  "cycles", "instructions", "llc_misses", "branch_misses"
+};
+
+/* counters of one thread, the first counter which can be opened is the
+   group leader, all counters of the group are read with one system call */
+class CounterGroup {
+  int Fds[PerfCounterValues::NUM_COUNTERS]; // file descriptors, -1 if not opened
+  int LeaderFd;                             // file descriptor of the group leader
+  unsigned int Valid;                       // bit i is set if counter i is open
+  int NumOpen;                              // number of open counters
+
+public:
+  CounterGroup() :
+    LeaderFd(-1),
+    Valid(0),
+    NumOpen(0)
+  {
+    for (int Counter = 0; Counter < PerfCounterValues::NUM_COUNTERS; ++Counter) {
+      perf_event_attr Attr;
+      std::memset(&Attr, 0, sizeof(Attr));
+      Attr.size = sizeof(Attr);
+      Attr.type = PERF_TYPE_HARDWARE;
+      Attr.config = CounterEvents[Counter];
+      Attr.exclude_kernel = 1;
+      Attr.exclude_hv = 1;
+      Attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                         PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      // calling thread on any cpu
+      Fds[Counter] = syscall(__NR_perf_event_open, &Attr, 0, -1, LeaderFd, 0);
+      if (Fds[Counter] >= 0) {
+        if (LeaderFd < 0) {
+          LeaderFd = Fds[Counter];
+        }
+        Valid |= 1u << Counter;
+        ++NumOpen;
+      }
+    }
+  }
+
+  ~CounterGroup()
+  {
+    for (int Fd : Fds) {
+      if (Fd >= 0) {
+        close(Fd);
+      }
+    }
+  }
+
+  CounterGroup(const CounterGroup &) = delete;
+  CounterGroup &operator=(const CounterGroup &) = delete;
+
+  bool Read(PerfCounterValues *Values) const
+  {
+    if (LeaderFd < 0) {
+      return false;
+    }
+
+    // layout of PERF_FORMAT_GROUP: nr, time_enabled, time_running, values
+    std::uint64_t Buffer[3 + PerfCounterValues::NUM_COUNTERS];
+    ssize_t Size = (3 + NumOpen) * sizeof(std::uint64_t);
+    if (read(LeaderFd, Buffer, Size) != Size) {
+      return false;
+    }
+
+    // scale if the counters were multiplexed with others
+    double Scale = ((Buffer[2] > 0) && (Buffer[2] < Buffer[1])) ?
+      static_cast<double>(Buffer[1]) / Buffer[2] : 1.0;
+    int IdxValue = 3;
+    for (int Counter = 0; Counter < PerfCounterValues::NUM_COUNTERS; ++Counter) {
+      if (Valid & (1u << Counter)) {
+        Values->Values[Counter] = Buffer[IdxValue++] * Scale;
+      } else {
+        Values->Values[Counter] = 0;
+      }
+    }
+    Values->Valid = Valid;
+    return true;
+  }
+};
+
+// counters of the calling thread, opened on first use
+const CounterGroup &GetThreadCounterGroup()
+{
+  thread_local CounterGroup Group;
+  return Group;
+}
+
+}
+
+void PerfCounterValues::AddDifference(
+  const PerfCounterValues &Start,
+  const PerfCounterValues &End
+)
+{
+  unsigned int BothValid = Start.Valid & End.Valid;
+  for (int Counter = 0; Counter < NUM_COUNTERS; ++Counter) {
+    if (BothValid & (1u << Counter)) {
+      Values[Counter] += End.Values[Counter] - Start.Values[Counter];
+    }
+  }
+  Valid |= BothValid;
+}
+
+PerfCounterValues &PerfCounterValues::operator+=(const PerfCounterValues &Other)
+{
+  for (int Counter = 0; Counter < NUM_COUNTERS; ++Counter) {
+    Values[Counter] += Other.Values[Counter];
+  }
+  Valid |= Other.Valid;
+  return *this;
+}
+
+bool PerfCounterValues::IsValid(int Counter) const
+{
+  return Valid & (1u << Counter);
+}
+
+bool PerfCounters::Enable()
+{
+  PerfCounterValues Values;
+  Enabled = GetThreadCounterGroup().Read(&Values);
+  return Enabled;
+}
+
+bool PerfCounters::IsEnabled()
+{
+  return Enabled.load(std::memory_order_relaxed);
+}
+
+bool PerfCounters::Read(PerfCounterValues *Values)
+{
+  return IsEnabled() && GetThreadCounterGroup().Read(Values);
+}
+
+const char *PerfCounters::GetName(int Counter)
+{
+  return CounterNames[Counter];
+}
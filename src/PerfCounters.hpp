@@ -0,0 +1,121 @@
+// ----------------------------------------------------------------------------
+/**
+   File: PerfCounters.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+
+   E-Mail: agent@local
+
+   Description: hardware performance counters (cycles, instructions, last
+                level cache misses, branch misses) of the calling thread via
+                perf_event_open
+
+   Limitations: linux only, counts user space only, the counters of a
+                thread are opened on its first read (one group per thread)
+
+   Change History:
+   Date         Author       Description
+   2026-10-19   agent        Initial
+*/
+// ----------------------------------------------------------------------------
+#ifndef _PERFCOUNTERS_HPP_
+#define _PERFCOUNTERS_HPP_
+
+#include <cstdint>
+
+/* values of the hardware counters, a counter which could not be opened has
+   the value 0 and is not set in Valid */
+struct PerfCounterValues {
+  enum {
+    CYCLES = 0,
+    INSTRUCTIONS,
+    LLC_MISSES,
+    BRANCH_MISSES,
+    NUM_COUNTERS
+  };
+
+  std::uint64_t Values[NUM_COUNTERS] = {0, 0, 0, 0}; // counter values
+  unsigned int Valid = 0;                            // bit i is set if counter i was read
+
+  // add difference End - Start of the counters valid in both
+  void AddDifference(
+    const PerfCounterValues &Start,
+    const PerfCounterValues &End
+  );
+
+  // accumulate counters
+  PerfCounterValues &operator+=(
+    const PerfCounterValues &Other
+  );
+
+  // check if counter is valid
+  bool IsValid(
+    int Counter
+  ) const;
+};
+
+/* counters of the calling thread, all functions are thread safe */
+class PerfCounters {
+public:
+  // enable the counters, returns false if no counter can be opened (the
+  // counters stay disabled then)
+  static bool Enable();
+
+  // counters are enabled
+  static bool IsEnabled();
+
+  // read the counters of the calling thread, opens them on the first call
+  // of each thread, returns false if they are disabled or unavailable
+  static bool Read(
+    PerfCounterValues *Values
+  );
+
+  // name of a counter
+  static const char *GetName(
+    int Counter
+  );
+};
+
+#endif
@@ -83,7 +83,10 @@ void SampleLib::ComposeAndSampleFromInputLexiconAndLM(
   fst::VectorFst< fst::LogArc > *SampledFst,
   std::vector< LatticeWordSegmentationTimer::SimpleTimer > *tInSample,
   int beamWidth,
-  bool UseViterby
+  bool UseViterby,
+  const LatticeWordIndex *CandidateIndex,
+  std::size_t LatticeIdx,
+  SentenceCostProfile *Profile
 )
 {
 //   std::cout << "Composing and Sampling: " << std::endl;
@@ -98,17 +101,22 @@ void SampleLib::ComposeAndSampleFromInputLexiconAndLM(
 
   // instantiate language model fst
   (*tInSample)[1].SetStart();
-  NHPYLMFst LanguageModelFST(*LanguageModel, SentEndWordId, GetActiveWordIdsInFst(Input_Unk_Lex, LanguageModel->GetMaxNumWords()));
+  bool UseCandidateIndex = (CandidateIndex != nullptr) && CandidateIndex->IsIndexed(LatticeIdx);
+  const ActiveWordsBuffer &ActiveWords = UseCandidateIndex ?
+    GetActiveWordIdsFromIndex(*CandidateIndex, LatticeIdx, LanguageModel->GetWordsBegin(), SentEndWordId, LanguageModel->GetMaxNumWords()) :
+    GetActiveWordIdsInFst(Input_Unk_Lex, LanguageModel->GetMaxNumWords());
+  NHPYLMFst LanguageModelFST(*LanguageModel, SentEndWordId, ActiveWords.ActiveWords);
   (*tInSample)[1].AddTimeSinceStartToDuration();
 
-  // compose with language model
-  (*tInSample)[2].SetStart();
-  PM *PM12 = new PM(Input_Unk_Lex, fst::MATCH_NONE);
-  PM *PM22 = new PM(LanguageModelFST, fst::MATCH_INPUT, PHI_SYMBOLID, false);
-  fst::ComposeFstOptions<fst::LogArc, PM> copts2(fst::CacheOptions(), PM12, PM22);
-  fst::ComposeFst<fst::LogArc> Input_Unk_Lex_LM(
-      Input_Unk_Lex, LanguageModelFST, copts2);
-  (*tInSample)[2].AddTimeSinceStartToDuration();
+  // compose with language model and sample segmentation
+  ComposeAndSampleFromInputAndLMFst(Input_Unk_Lex, LanguageModelFST, SampledFst,
+                                    tInSample, beamWidth, UseViterby, Profile);
+
+  if (Profile != nullptr) {
+    Profile->NumActiveWords = ActiveWords.SetWordIds.size();
+    Profile->NumExpandedLMStates = LanguageModelFST.GetNumExpandedStates();
+    Profile->NumLMArcs = LanguageModelFST.GetNumExpandedArcs();
+  }
 
   // print input, lexicon, language model and composition results
 //   FileReader::PrintFST("lattice_debug/in.fst", LanguageModel->GetId2CharacterSequenceVector(), fst::VectorFst<fst::LogArc>(*InputFst), true, NAMESANDIDS);
@@ -117,6 +125,50 @@ void SampleLib::ComposeAndSampleFromInputLexiconAndLM(
 //   FileReader::PrintFST("lattice_debug/in_lex.fst", LanguageModel->GetId2CharacterSequenceVector(), fst::VectorFst<fst::LogArc>(Input_Unk_Lex), true, NAMESANDIDS);
 //   FileReader::PrintFST("lattice_debug/lm.fst", LanguageModel->GetId2CharacterSequenceVector(), fst::VectorFst<fst::LogArc>(LanguageModelFST), true, NAMESANDIDS);
 //   FileReader::PrintFST("lattice_debug/in_lex_lm.fst", LanguageModel->GetId2CharacterSequenceVector(), fst::VectorFst<fst::LogArc>(Input_Unk_Lex_LM), true, NAMESANDIDS);
+}
+
+void SampleLib::ComposeAndSampleFromInputLexiconAndSharedLM(
+  const fst::Fst< fst::LogArc > *InputFst,
+  const fst::Fst< fst::LogArc > *LexiconTransducer,
+  const NHPYLMFst *LanguageModelFST,
+  fst::VectorFst< fst::LogArc > *SampledFst,
+  std::vector< LatticeWordSegmentationTimer::SimpleTimer > *tInSample,
+  int beamWidth,
+  bool UseViterby
+)
+{
+  // compose input with lexicon transducer
+  (*tInSample)[0].SetStart();
+  PM *PM11 = new PM(*InputFst, fst::MATCH_NONE);
+  PM *PM21 = new PM(*LexiconTransducer, fst::MATCH_INPUT, PHI_SYMBOLID, false);
+  fst::ComposeFstOptions<fst::LogArc, PM> copts1(fst::CacheOptions(), PM11, PM21);
+  fst::ComposeFst<fst::LogArc> Input_Unk_Lex(*InputFst, *LexiconTransducer, copts1);
+  (*tInSample)[0].AddTimeSinceStartToDuration();
+
+  // compose with the shared language model (its arcs are only expanded once
+  // for all threads) and sample segmentation
+  ComposeAndSampleFromInputAndLMFst(Input_Unk_Lex, *LanguageModelFST, SampledFst,
+                                    tInSample, beamWidth, UseViterby);
+}
+
+void SampleLib::ComposeAndSampleFromInputAndLMFst(
+  const fst::Fst< fst::LogArc > &Input_Unk_Lex,
+  const fst::Fst< fst::LogArc > &LanguageModelFST,
+  fst::VectorFst< fst::LogArc > *SampledFst,
+  std::vector< LatticeWordSegmentationTimer::SimpleTimer > *tInSample,
+  int beamWidth,
+  bool UseViterby,
+  SentenceCostProfile *Profile
+)
+{
+  // compose with language model
+  (*tInSample)[2].SetStart();
+  PM *PM12 = new PM(Input_Unk_Lex, fst::MATCH_NONE);
+  PM *PM22 = new PM(LanguageModelFST, fst::MATCH_INPUT, PHI_SYMBOLID, false);
+  fst::ComposeFstOptions<fst::LogArc, PM> copts2(fst::CacheOptions(), PM12, PM22);
+  fst::ComposeFst<fst::LogArc> Input_Unk_Lex_LM(
+      Input_Unk_Lex, LanguageModelFST, copts2);
+  (*tInSample)[2].AddTimeSinceStartToDuration();
 
   // use beamserach, if specified
   fst::VectorFst<fst::LogArc> *beamSearchFst = new fst::VectorFst<fst::LogArc>();
@@ -124,21 +176,24 @@ void SampleLib::ComposeAndSampleFromInputLexiconAndLM(
     fst::BeamTrim(Input_Unk_Lex_LM, beamSearchFst, beamWidth);
   }
 
-  // sample segmentation
+  // sample segmentation from the completely expanded composition or from
+  // its beam trimmed version
   (*tInSample)[3].SetStart();
-  if (!UseViterby) {
-    if (beamWidth > 0) {
-      SampGen(*beamSearchFst, SampledFst, 1);
-    } else {
-      SampGen(fst::VectorFst<fst::LogArc>(Input_Unk_Lex_LM), SampledFst, 1);
+  if (beamWidth <= 0) {
+    *beamSearchFst = fst::VectorFst<fst::LogArc>(Input_Unk_Lex_LM);
+  }
+  if (Profile != nullptr) {
+    Profile->NumComposedStates = beamSearchFst->NumStates();
+    Profile->NumComposedArcs = 0;
+    for (int s = 0; s < beamSearchFst->NumStates(); ++s) {
+      Profile->NumComposedArcs += beamSearchFst->NumArcs(s);
     }
+  }
+  if (!UseViterby) {
+    SampGen(*beamSearchFst, SampledFst, 1);
   } else {
     fst::VectorFst<fst::StdArc> iStdFst;
-    if (beamWidth > 0) {
-      fst::Cast(*beamSearchFst, &iStdFst);
-    } else {
-      fst::Cast(fst::VectorFst<fst::LogArc>(Input_Unk_Lex_LM), &iStdFst);
-    }
+    fst::Cast(*beamSearchFst, &iStdFst);
     fst::VectorFst<fst::StdArc> oStdFst;
     fst::ShortestPath(iStdFst, &oStdFst);
     fst::Cast(oStdFst, SampledFst);
@@ -179,22 +234,69 @@ void SampleLib::ComposeAndSampleFromInputAndAddCharLM(
 //   DebugLib::PrintFST("lattice_debug/Input.fst", CharacterLanguageModel->GetId2CharacterSequenceVector(), fst::VectorFst<fst::LogArc>(*InputFst), true, NAMESANDIDS);
 }
 
-vector< bool > SampleLib::GetActiveWordIdsInFst(
+SampleLib::ActiveWordsBuffer &SampleLib::GetClearedActiveWordsBuffer(int MaxNumWords)
+{
+  static thread_local ActiveWordsBuffer Buffer;
+
+  // only reset the words which were set for the last sentence
+  for (int WordId : Buffer.SetWordIds) {
+    Buffer.ActiveWords[WordId] = false;
+  }
+  Buffer.SetWordIds.clear();
+  if (Buffer.ActiveWords.size() < static_cast<std::size_t>(MaxNumWords)) {
+    Buffer.ActiveWords.resize(MaxNumWords, false);
+  }
+  return Buffer;
+}
+
+void SampleLib::SetActiveWord(int WordId, ActiveWordsBuffer *Buffer)
+{
+  if (!Buffer->ActiveWords[WordId]) {
+    Buffer->ActiveWords[WordId] = true;
+    Buffer->SetWordIds.push_back(WordId);
+  }
+}
+
+const SampleLib::ActiveWordsBuffer &SampleLib::GetActiveWordIdsInFst(
   const fst::Fst< fst::LogArc > &SegmentFST,
   int MaxNumWords
 )
 {
-//   int NumActiveWords = 0;
-//   int NumKnownWords = LanguageModel.GetId2Word().size();
-  std::vector<bool> ActiveWords(MaxNumWords, false);
+  ActiveWordsBuffer &Buffer = GetClearedActiveWordsBuffer(MaxNumWords);
+
+  // the traversal expands the cache of the lazy composition which is reused
+  // by the following composition with the language model
   for (fst::StateIterator<fst::Fst<fst::LogArc> > siter(SegmentFST); !siter.Done(); siter.Next()) {
     for (fst::ArcIterator<fst::Fst<fst::LogArc> > aiter(SegmentFST, siter.Value()); !aiter.Done(); aiter.Next()) {
-//       NumActiveWords += !ActiveWords[aiter.Value().olabel];
-      ActiveWords[aiter.Value().olabel] = true;
+      SetActiveWord(aiter.Value().olabel, &Buffer);
     }
   }
-//   std::cout << NumActiveWords << " of " << NumKnownWords << " words in fst!" << std::endl;
-  return ActiveWords;
+//   std::cout << Buffer.SetWordIds.size() << " of " << MaxNumWords << " words in fst!" << std::endl;
+  return Buffer;
+}
+
+const SampleLib::ActiveWordsBuffer &SampleLib::GetActiveWordIdsFromIndex(
+  const LatticeWordIndex &CandidateIndex,
+  std::size_t LatticeIdx,
+  int WordsBegin,
+  int SentEndWordId,
+  int MaxNumWords
+)
+{
+  ActiveWordsBuffer &Buffer = GetClearedActiveWordsBuffer(MaxNumWords);
+
+  // characters and special symbols are used by the character model
+  for (int WordId = 0; WordId < WordsBegin; ++WordId) {
+    SetActiveWord(WordId, &Buffer);
+  }
+  SetActiveWord(SentEndWordId, &Buffer);
+  for (int WordId : CandidateIndex.GetCandidateWordIds(LatticeIdx)) {
+    SetActiveWord(WordId, &Buffer);
+  }
+  for (int WordId : CandidateIndex.GetLongWordIds()) {
+    SetActiveWord(WordId, &Buffer);
+  }
+  return Buffer;
 }
 
 // Copyright 2010, Graham Neubig, modified by Jahn Heymann (2013) and Oliver Walter (2014) //
@@ -86,21 +86,55 @@
 #include "NHPYLMFst.hpp"
 #include "LexFst.hpp"
 #include "LatticeWordSegmentationTimer.hpp"
+#include "CostProfile.hpp"
 
 /* library for generating and parsing samples from input lattice */
 class SampleLib {
-  
+
+  // reusable storage for the active words of one thread
+  struct ActiveWordsBuffer {
+    std::vector<bool> ActiveWords; // bitset indicating active words
+    std::vector<int> SetWordIds;   // ids of words set in bitset, used for clearing
+  };
+
+  // return the cleared active words bitset of the calling thread (reused by
+  // the next call from the same thread)
+  inline static ActiveWordsBuffer &GetClearedActiveWordsBuffer(
+    int MaxNumWords
+  );
+
+  // mark word as active in the buffer
+  inline static void SetActiveWord(
+    int WordId,
+    ActiveWordsBuffer *Buffer
+  );
+
   // find all active words in the word fst
-  inline static std::vector< bool > GetActiveWordIdsInFst(
+  inline static const ActiveWordsBuffer &GetActiveWordIdsInFst(
     const fst::Fst< fst::LogArc > &SegmentFST,
     int MaxNumWords
   );
 
-  // generate sample from weighted input lattice
-  inline static void SampGen(
-    const fst::Fst< fst::LogArc > &ifst,
-    fst::MutableFst< fst::LogArc > *ofst,
-    unsigned int nbest
+  // get active words from the candidate words of the lattice index
+  inline static const ActiveWordsBuffer &GetActiveWordIdsFromIndex(
+    const LatticeWordIndex &CandidateIndex,
+    std::size_t LatticeIdx,
+    int WordsBegin,
+    int SentEndWordId,
+    int MaxNumWords
+  );
+
+  // compose input (already composed with lexicon) with language model fst
+  // and sample or find best segmentation, the size of the composition is
+  // stored in the profile (optional)
+  inline static void ComposeAndSampleFromInputAndLMFst(
+    const fst::Fst< fst::LogArc > &Input_Unk_Lex,
+    const fst::Fst< fst::LogArc > &LanguageModelFST,
+    fst::VectorFst< fst::LogArc > *SampledFst,
+    std::vector< LatticeWordSegmentationTimer::SimpleTimer > *tInSample,
+    int beamWidth,
+    bool UseViterby,
+    SentenceCostProfile *Profile = nullptr
   );
 
   // used to draw a discrete sample from log probability vector
@@ -109,7 +143,16 @@ class SampleLib {
   );
 
 public:
-  // compose with lexicon fst and language model fst and sample output fst
+  // generate sample from weighted (acyclic) input lattice
+  static void SampGen(
+    const fst::Fst< fst::LogArc > &ifst,
+    fst::MutableFst< fst::LogArc > *ofst,
+    unsigned int nbest
+  );
+
+  // compose with lexicon fst and language model fst and sample output fst,
+  // the active words, the expansion of the language model fst and the size
+  // of the composition are stored in the profile (optional)
   static void ComposeAndSampleFromInputLexiconAndLM(
     const fst::Fst< fst::LogArc > *InputFst,
     const fst::Fst< fst::LogArc > *LexiconTransducer,
@@ -118,6 +161,21 @@ public:
     fst::VectorFst< fst::LogArc > *SampledFst,
     std::vector< LatticeWordSegmentationTimer::SimpleTimer > *tInSample,
     int beamWidth,
+    bool UseViterby,
+    const LatticeWordIndex *CandidateIndex = nullptr,
+    std::size_t LatticeIdx = 0,
+    SentenceCostProfile *Profile = nullptr
+  );
+
+  // compose with lexicon fst and a language model fst shared by all threads
+  // (the language model has to be frozen) and sample output fst
+  static void ComposeAndSampleFromInputLexiconAndSharedLM(
+    const fst::Fst< fst::LogArc > *InputFst,
+    const fst::Fst< fst::LogArc > *LexiconTransducer,
+    const NHPYLMFst *LanguageModelFST,
+    fst::VectorFst< fst::LogArc > *SampledFst,
+    std::vector< LatticeWordSegmentationTimer::SimpleTimer > *tInSample,
+    int beamWidth,
     bool UseViterby
   );
 
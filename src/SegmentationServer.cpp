@@ -0,0 +1,397 @@
+// ----------------------------------------------------------------------------
+/**
+   File: SegmentationServer.cpp
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+*/
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "SegmentationServer.hpp"
+
+namespace {
+
+// maximum size of a lattice sent by a client
+const std::size_t kMaxLatticeSize = 1 << 30;
+
+// number of latest requests the latency percentiles are calculated from
+const std::size_t kLatencyWindow = 10000;
+
+/* buffered reading of lines and blocks from a socket */
+class SocketReader {
+  const int Fd;
+  std::string Buffer;
+  std::size_t Pos;
+
+  // read more data into the buffer, returns false on end of file or error
+  bool Fill() {
+    if (Pos > 0) {
+      Buffer.erase(0, Pos);
+      Pos = 0;
+    }
+    char Chunk[65536];
+    ssize_t NumRead;
+    do {
+      NumRead = recv(Fd, Chunk, sizeof(Chunk), 0);
+    } while ((NumRead < 0) && (errno == EINTR));
+    if (NumRead <= 0) {
+      return false;
+    }
+    Buffer.append(Chunk, NumRead);
+    return true;
+  }
+
+public:
+  SocketReader(int Fd_) : Fd(Fd_), Buffer(), Pos(0) {}
+
+  // read line without the trailing newline
+  bool ReadLine(std::string *Line) {
+    std::size_t End;
+    while ((End = Buffer.find('\n', Pos)) == std::string::npos) {
+      if (!Fill()) {
+        return false;
+      }
+    }
+    Line->assign(Buffer, Pos, End - Pos);
+    Pos = End + 1;
+    return true;
+  }
+
+  // read exactly NumBytes bytes
+  bool Read(std::size_t NumBytes, std::string *Data) {
+    while (Buffer.size() - Pos < NumBytes) {
+      if (!Fill()) {
+        return false;
+      }
+    }
+    Data->assign(Buffer, Pos, NumBytes);
+    Pos += NumBytes;
+    return true;
+  }
+};
+
+// nearest rank percentile of sorted values
+double Percentile(const std::vector<double> &SortedValues, double P)
+{
+  if (SortedValues.empty()) {
+    return 0;
+  }
+  std::size_t Rank = static_cast<std::size_t>(std::ceil(P * SortedValues.size()));
+  return SortedValues[std::max<std::size_t>(Rank, 1) - 1];
+}
+
+}
+
+SegmentationServer::Connection::Connection(int Fd_) :
+  Fd(Fd_),
+  WriteMutex()
+{
+}
+
+SegmentationServer::Connection::~Connection()
+{
+  close(Fd);
+}
+
+bool SegmentationServer::Connection::Write(const std::string &Data)
+{
+  std::lock_guard<std::mutex> Lock(WriteMutex);
+  std::size_t NumWritten = 0;
+  while (NumWritten < Data.size()) {
+    ssize_t Written = send(Fd, Data.data() + NumWritten,
+                           Data.size() - NumWritten, MSG_NOSIGNAL);
+    if (Written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    NumWritten += Written;
+  }
+  return true;
+}
+
+SegmentationServer::SegmentationServer(
+  const std::string &SocketPath_,
+  std::size_t MaxBatchSize_,
+  const BatchHandler &Handler_
+) :
+  SocketPath(SocketPath_),
+  MaxBatchSize(std::max<std::size_t>(MaxBatchSize_, 1)),
+  Handler(Handler_),
+  Stopping(false),
+  NumRequests(0),
+  NumBatches(0)
+{
+}
+
+void SegmentationServer::Run()
+{
+  // open the socket, a stale socket file of a previous run is replaced
+  sockaddr_un Address;
+  std::memset(&Address, 0, sizeof(Address));
+  Address.sun_family = AF_UNIX;
+  if (SocketPath.size() >= sizeof(Address.sun_path)) {
+    throw std::runtime_error("Socket path too long: " + SocketPath);
+  }
+  std::strcpy(Address.sun_path, SocketPath.c_str());
+  int ListenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (ListenFd < 0) {
+    throw std::runtime_error("Could not create socket: " +
+                             std::string(std::strerror(errno)));
+  }
+  unlink(SocketPath.c_str());
+  if ((bind(ListenFd, reinterpret_cast<sockaddr *>(&Address), sizeof(Address)) < 0) ||
+      (listen(ListenFd, SOMAXCONN) < 0)) {
+    std::string Error(std::strerror(errno));
+    close(ListenFd);
+    throw std::runtime_error("Could not listen on " + SocketPath + ": " + Error);
+  }
+  std::cout << " Listening on " << SocketPath << " (batches of up to "
+            << MaxBatchSize << " requests)" << std::endl;
+
+  // accept clients until a client requests the shutdown
+  std::thread BatchThread(&SegmentationServer::ProcessBatches, this);
+  while (!IsStopping()) {
+    pollfd Poll;
+    Poll.fd = ListenFd;
+    Poll.events = POLLIN;
+    if (poll(&Poll, 1, 100) <= 0) {
+      continue;
+    }
+    int ClientFd = accept(ListenFd, nullptr, nullptr);
+    if (ClientFd < 0) {
+      continue;
+    }
+    std::shared_ptr<Connection> Client(new Connection(ClientFd));
+    std::lock_guard<std::mutex> Lock(ConnectionsMutex);
+    JoinFinishedConnectionThreads();
+    Clients.push_back(Client);
+    ConnectionThreads.push_back(std::thread([this, Client]() {
+      HandleConnection(Client);
+      std::lock_guard<std::mutex> Lock(ConnectionsMutex);
+      FinishedThreads.push_back(std::this_thread::get_id());
+    }));
+  }
+  close(ListenFd);
+  unlink(SocketPath.c_str());
+
+  // answer the pending requests, then disconnect the remaining clients
+  BatchThread.join();
+  {
+    std::lock_guard<std::mutex> Lock(ConnectionsMutex);
+    for (auto &WeakClient : Clients) {
+      std::shared_ptr<Connection> Client = WeakClient.lock();
+      if (Client != nullptr) {
+        shutdown(Client->Fd, SHUT_RDWR);
+      }
+    }
+  }
+  for (auto &ConnectionThread : ConnectionThreads) {
+    ConnectionThread.join();
+  }
+
+  std::cout << " Server stopped, requests, batches, p50 and p99 latency (ms): "
+            << GetStatistics() << std::endl << std::endl;
+}
+
+void SegmentationServer::HandleConnection(std::shared_ptr<Connection> Client)
+{
+  SocketReader Reader(Client->Fd);
+  std::string Line;
+  while (Reader.ReadLine(&Line)) {
+    std::istringstream Header(Line);
+    std::string Command;
+    Header >> Command;
+    if (Command == "STATS") {
+      Client->Write("OK " + GetStatistics() + "\n");
+    } else if (Command == "SHUTDOWN") {
+      {
+        std::lock_guard<std::mutex> Lock(QueueMutex);
+        Stopping = true;
+      }
+      QueueChanged.notify_all();
+      Client->Write("OK\n");
+    } else if (Command == "SEGMENT") {
+      QueuedRequest Queued;
+      std::string Format;
+      std::size_t NumBytes = 0;
+      Header >> Format >> Queued.Request.Name >> NumBytes;
+      if (!Header || ((Format != "slf") && (Format != "fst")) ||
+          (NumBytes > kMaxLatticeSize)) {
+        // the stream can not be resynchronized
+        Client->Write("ERROR - Invalid request header\n");
+        return;
+      }
+      if (!Reader.Read(NumBytes, &Queued.Request.Lattice)) {
+        return;
+      }
+      Queued.Request.IsHTKLattice = (Format == "slf");
+      Queued.Client = Client;
+      Queued.ReceiveTime = std::chrono::steady_clock::now();
+
+      std::unique_lock<std::mutex> Lock(QueueMutex);
+      if (Stopping) {
+        Lock.unlock();
+        Client->Write("ERROR " + Queued.Request.Name + " Server is stopping\n");
+        continue;
+      }
+      Queue.push_back(std::move(Queued));
+      Lock.unlock();
+      QueueChanged.notify_one();
+    } else if (!Command.empty()) {
+      Client->Write("ERROR - Unknown command " + Command + "\n");
+    }
+  }
+}
+
+void SegmentationServer::JoinFinishedConnectionThreads()
+{
+  for (const auto &ThreadId : FinishedThreads) {
+    auto ConnectionThread = std::find_if(ConnectionThreads.begin(),
+                                         ConnectionThreads.end(),
+      [&ThreadId](const std::thread &Thread) {
+        return Thread.get_id() == ThreadId;
+      });
+    ConnectionThread->join();
+    ConnectionThreads.erase(ConnectionThread);
+  }
+  FinishedThreads.clear();
+
+  Clients.erase(std::remove_if(Clients.begin(), Clients.end(),
+    [](const std::weak_ptr<Connection> &Client) {
+      return Client.expired();
+    }), Clients.end());
+}
+
+void SegmentationServer::ProcessBatches()
+{
+  while (true) {
+    // take all waiting requests up to the batch size
+    std::vector<std::shared_ptr<Connection> > BatchClients;
+    std::vector<std::chrono::steady_clock::time_point> ReceiveTimes;
+    std::vector<SegmentationRequest> Requests;
+    {
+      std::unique_lock<std::mutex> Lock(QueueMutex);
+      QueueChanged.wait(Lock, [this]() { return Stopping || !Queue.empty(); });
+      if (Queue.empty()) {
+        return;
+      }
+      while (!Queue.empty() && (Requests.size() < MaxBatchSize)) {
+        BatchClients.push_back(std::move(Queue.front().Client));
+        ReceiveTimes.push_back(Queue.front().ReceiveTime);
+        Requests.push_back(std::move(Queue.front().Request));
+        Queue.pop_front();
+      }
+    }
+
+    try {
+      Handler(&Requests);
+    } catch (const std::exception &e) {
+      for (auto &Request : Requests) {
+        Request.Error = e.what();
+      }
+    }
+
+    // answer the requests
+    std::vector<double> BatchLatencies;
+    for (std::size_t IdxRequest = 0; IdxRequest < Requests.size(); ++IdxRequest) {
+      const SegmentationRequest &Request = Requests[IdxRequest];
+      std::ostringstream Response;
+      if (Request.Error.empty()) {
+        Response << "OK " << Request.Name << " " << Request.Words.size() << "\n";
+        for (const auto &Word : Request.Words) {
+          Response << Word.Word << " " << Word.Start << " " << Word.End << "\n";
+        }
+      } else {
+        std::string Error(Request.Error);
+        std::replace(Error.begin(), Error.end(), '\n', ' ');
+        Response << "ERROR " << Request.Name << " " << Error << "\n";
+      }
+      BatchClients[IdxRequest]->Write(Response.str());
+      BatchLatencies.push_back(std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - ReceiveTimes[IdxRequest]).count());
+    }
+
+    std::lock_guard<std::mutex> Lock(StatsMutex);
+    for (double Latency : BatchLatencies) {
+      if (Latencies.size() < kLatencyWindow) {
+        Latencies.push_back(Latency);
+      } else {
+        Latencies[NumRequests % kLatencyWindow] = Latency;
+      }
+      ++NumRequests;
+    }
+    ++NumBatches;
+  }
+}
+
+bool SegmentationServer::IsStopping()
+{
+  std::lock_guard<std::mutex> Lock(QueueMutex);
+  return Stopping;
+}
+
+std::string SegmentationServer::GetStatistics()
+{
+  std::vector<double> SortedLatencies;
+  std::size_t NumAnsweredRequests;
+  std::size_t NumProcessedBatches;
+  {
+    std::lock_guard<std::mutex> Lock(StatsMutex);
+    SortedLatencies = Latencies;
+    NumAnsweredRequests = NumRequests;
+    NumProcessedBatches = NumBatches;
+  }
+  std::sort(SortedLatencies.begin(), SortedLatencies.end());
+
+  std::ostringstream Statistics;
+  Statistics << NumAnsweredRequests << " " << NumProcessedBatches << " "
+             << Percentile(SortedLatencies, 0.5) << " "
+             << Percentile(SortedLatencies, 0.99);
+  return Statistics.str();
+}
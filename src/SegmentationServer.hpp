@@ -0,0 +1,181 @@
+// ----------------------------------------------------------------------------
+/**
+   File: SegmentationServer.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+
+   E-Mail: agent@local
+
+   Description: server segmenting lattices sent over a unix domain socket
+
+   Limitations: the clients are trusted (local socket only)
+
+   Change History:
+   Date         Author       Description
+   2026-10-19   agent        Initial
+*/
+// ----------------------------------------------------------------------------
+#ifndef _SEGMENTATIONSERVER_HPP_
+#define _SEGMENTATIONSERVER_HPP_
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* word of a segmentation */
+struct SegmentedWord {
+  std::string Word; // written form of the word
+  float Start;      // start time, -1 if the lattice has no node times
+  float End;        // end time, -1 if the lattice has no node times
+};
+
+/* lattice sent by a client */
+struct SegmentationRequest {
+  std::string Name;                 // name given by the client
+  bool IsHTKLattice;                // HTK SLF lattice, otherwise OpenFst binary
+  std::string Lattice;              // contents of the lattice file
+  std::vector<SegmentedWord> Words; // segmentation, set by the batch handler
+  std::string Error;                // error message, set by the batch handler
+};
+
+/* Server answering segmentation requests on a unix domain socket. Every
+   client connection is read by its own thread, the requests of all clients
+   are queued and handed to the batch handler in batches of up to
+   MaxBatchSize requests (all requests which arrived while the previous batch
+   was processed). The protocol is line based, a client can send any number
+   of requests over one connection:
+     SEGMENT <slf|fst> <name> <bytes>\n<lattice file contents>
+       -> OK <name> <number of words>\n followed by <word> <start> <end>\n
+          for every word, or ERROR <name> <message>\n
+     STATS\n    -> OK <number of requests> <batches> <p50 ms> <p99 ms>\n, the
+                   latency percentiles are over the last 10000 requests
+     SHUTDOWN\n -> OK\n, pending requests are answered before the server
+                   stops
+   Names must not contain white space. */
+class SegmentationServer {
+public:
+  // segment all requests of a batch, errors are reported per request
+  typedef std::function<void(std::vector<SegmentationRequest> *Requests)> BatchHandler;
+
+private:
+  /* connection to a client, closed when the last reference is gone */
+  struct Connection {
+    const int Fd;          // socket of the connection
+    std::mutex WriteMutex; // responses are written from different threads
+
+    Connection(int Fd_);
+    ~Connection();
+
+    // write complete string to the socket, returns false on error
+    bool Write(const std::string &Data);
+  };
+
+  /* request waiting for the next batch */
+  struct QueuedRequest {
+    std::shared_ptr<Connection> Client;                 // connection to answer on
+    SegmentationRequest Request;                        // the request
+    std::chrono::steady_clock::time_point ReceiveTime; // time the request was read completely
+  };
+
+  const std::string SocketPath;   // path of the unix domain socket
+  const std::size_t MaxBatchSize; // maximum number of requests per batch
+  const BatchHandler Handler;     // function segmenting the batches
+
+  std::deque<QueuedRequest> Queue;       // requests waiting for the next batch
+  std::mutex QueueMutex;                 // mutex for queue and stopping
+  std::condition_variable QueueChanged;  // signaled on new requests and shutdown
+  bool Stopping;                         // no new requests are accepted
+
+  std::mutex StatsMutex;        // mutex for the statistics
+  std::vector<double> Latencies; // latencies of the last answered requests in ms (ring buffer)
+  std::size_t NumRequests;       // number of answered requests
+  std::size_t NumBatches;        // number of processed batches
+
+  std::mutex ConnectionsMutex;                       // mutex for the connections
+  std::vector<std::weak_ptr<Connection> > Clients;   // open connections (shut down when stopping)
+  std::vector<std::thread> ConnectionThreads;        // threads reading the connections
+  std::vector<std::thread::id> FinishedThreads;      // connection threads which can be joined
+
+  /* internal functions */
+  // read and queue requests of a client until the connection is closed
+  void HandleConnection(
+    std::shared_ptr<Connection> Client
+  );
+
+  // join finished connection threads and forget closed connections
+  // (ConnectionsMutex has to be locked)
+  void JoinFinishedConnectionThreads();
+
+  // take batches from the queue, segment and answer them until stopped
+  void ProcessBatches();
+
+  // return true if the server is stopping
+  bool IsStopping();
+
+  // format number of requests, batches and latency percentiles
+  std::string GetStatistics();
+
+public:
+  /* constructor */
+  // setup server for given socket path, nothing is opened before Run
+  SegmentationServer(
+    const std::string &SocketPath_,
+    std::size_t MaxBatchSize_,
+    const BatchHandler &Handler_
+  );
+
+
+  /* interface */
+  // listen on the socket and answer requests until a client sends SHUTDOWN
+  void Run();
+};
+
+#endif
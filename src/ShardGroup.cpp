@@ -0,0 +1,249 @@
+// ----------------------------------------------------------------------------
+/**
+   File: ShardGroup.cpp
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+*/
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "ShardGroup.hpp"
+
+
+ShardGroup::ShardGroup(std::size_t NumShards_) :
+  NumShards(NumShards_),
+  ShardId(NumShards_),
+  Fd(-1)
+{
+  // buffered output would otherwise be written by every process
+  std::cout.flush();
+  std::cerr.flush();
+  std::fflush(nullptr);
+
+  for (std::size_t IdxShard = 0; IdxShard < NumShards; ++IdxShard) {
+    int Fds[2];
+    pid_t Pid = -1;
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, Fds) == 0) {
+      Pid = fork();
+      if (Pid < 0) {
+        close(Fds[0]);
+        close(Fds[1]);
+      }
+    }
+    if (Pid < 0) {
+      // the already forked workers see the closed sockets and terminate
+      std::string Error = std::strerror(errno);
+      WaitForWorkers();
+      std::ostringstream err;
+      err << "Could not start worker " << IdxShard << " of the sharded sampling: "
+          << Error;
+      throw std::runtime_error(err.str());
+    }
+
+    if (Pid == 0) {
+      // worker, only keep the own socket
+      close(Fds[0]);
+      for (int WorkerFd : WorkerFds) {
+        close(WorkerFd);
+      }
+      WorkerFds.clear();
+      Workers.clear();
+      Fd = Fds[1];
+      ShardId = IdxShard;
+      return;
+    }
+    close(Fds[1]);
+    WorkerFds.push_back(Fds[0]);
+    Workers.push_back(Pid);
+  }
+}
+
+ShardGroup::~ShardGroup()
+{
+  if (Fd >= 0) {
+    close(Fd);
+  }
+  WaitForWorkers();
+}
+
+bool ShardGroup::WriteAll(int Fd, const char *Data, std::size_t Size)
+{
+  std::size_t NumWritten = 0;
+  while (NumWritten < Size) {
+    ssize_t Written = send(Fd, Data + NumWritten, Size - NumWritten,
+                           MSG_NOSIGNAL);
+    if (Written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    NumWritten += Written;
+  }
+  return true;
+}
+
+bool ShardGroup::ReadAll(int Fd, char *Data, std::size_t Size)
+{
+  std::size_t NumRead = 0;
+  while (NumRead < Size) {
+    ssize_t Read = recv(Fd, Data + NumRead, Size - NumRead, 0);
+    if (Read < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    if (Read == 0) {
+      return false;
+    }
+    NumRead += Read;
+  }
+  return true;
+}
+
+bool ShardGroup::WriteMessage(int Fd, const std::string &Message)
+{
+  uint64_t Size = Message.size();
+  return WriteAll(Fd, reinterpret_cast<const char *>(&Size), sizeof(Size)) &&
+         WriteAll(Fd, Message.data(), Message.size());
+}
+
+bool ShardGroup::ReadMessage(int Fd, std::string *Message)
+{
+  uint64_t Size;
+  if (!ReadAll(Fd, reinterpret_cast<char *>(&Size), sizeof(Size))) {
+    return false;
+  }
+  Message->resize(Size);
+  return (Size == 0) || ReadAll(Fd, &(*Message)[0], Size);
+}
+
+bool ShardGroup::WaitForWorkers()
+{
+  for (int WorkerFd : WorkerFds) {
+    close(WorkerFd);
+  }
+  WorkerFds.clear();
+
+  bool Success = true;
+  for (pid_t Worker : Workers) {
+    int Status = 0;
+    pid_t Result;
+    do {
+      Result = waitpid(Worker, &Status, 0);
+    } while ((Result < 0) && (errno == EINTR));
+    if ((Result < 0) || !WIFEXITED(Status) || (WEXITSTATUS(Status) != 0)) {
+      Success = false;
+    }
+  }
+  Workers.clear();
+  return Success;
+}
+
+bool ShardGroup::IsCoordinator() const
+{
+  return ShardId == NumShards;
+}
+
+void ShardGroup::RelayMessages()
+{
+  std::vector<std::string> Messages(NumShards);
+  bool Running = true;
+  while (Running) {
+    // a round ends when every worker sent its message, the first closed
+    // socket (finished or failed worker) ends the relaying
+    for (std::size_t IdxShard = 0; Running && (IdxShard < NumShards); ++IdxShard) {
+      Running = ReadMessage(WorkerFds[IdxShard], &Messages[IdxShard]);
+    }
+    if (!Running) {
+      break;
+    }
+
+    std::string Gathered;
+    uint64_t NumMessages = NumShards;
+    Gathered.append(reinterpret_cast<const char *>(&NumMessages),
+                    sizeof(NumMessages));
+    for (const std::string &Message : Messages) {
+      uint64_t Size = Message.size();
+      Gathered.append(reinterpret_cast<const char *>(&Size), sizeof(Size));
+      Gathered.append(Message);
+    }
+    for (std::size_t IdxShard = 0; Running && (IdxShard < NumShards); ++IdxShard) {
+      Running = WriteAll(WorkerFds[IdxShard], Gathered.data(), Gathered.size());
+    }
+  }
+
+  if (!WaitForWorkers()) {
+    throw std::runtime_error("A worker of the sharded sampling failed");
+  }
+}
+
+std::vector<std::string> ShardGroup::AllGather(const std::string &Message)
+{
+  uint64_t NumMessages = 0;
+  if (!WriteMessage(Fd, Message) ||
+      !ReadAll(Fd, reinterpret_cast<char *>(&NumMessages), sizeof(NumMessages))) {
+    throw std::runtime_error("Lost connection to the coordinator of the sharded sampling");
+  }
+  std::vector<std::string> Messages(NumMessages);
+  for (std::string &ShardMessage : Messages) {
+    if (!ReadMessage(Fd, &ShardMessage)) {
+      throw std::runtime_error("Lost connection to the coordinator of the sharded sampling");
+    }
+  }
+  return Messages;
+}
+
+std::size_t ShardGroup::GetShardId() const
+{
+  return ShardId;
+}
+
+std::size_t ShardGroup::GetNumShards() const
+{
+  return NumShards;
+}
@@ -0,0 +1,145 @@
+// ----------------------------------------------------------------------------
+/**
+   File: ShardGroup.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+
+   E-Mail: agent@local
+
+
+   Description: worker processes of a sharded sampling run and the exchange
+                of messages between them over socket pairs
+
+   Limitations: all processes run on one machine
+
+   Change History:
+   Date         Author       Description
+   2026-10-19   agent        Initial
+*/
+// ----------------------------------------------------------------------------
+#ifndef _SHARDGROUP_HPP_
+#define _SHARDGROUP_HPP_
+
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+/* Group of worker processes sampling disjoint shards of the sentences. The
+   calling process forks the workers and then only relays their messages
+   (coordinator). Messages are exchanged in all-gather rounds: every worker
+   sends one message and receives the messages of all workers, ordered by
+   shard id. All workers have to take part in every round. Framing on the
+   socket pairs: <uint64 size><bytes> from the worker, <uint64 number of
+   messages> followed by the framed messages to the worker. */
+class ShardGroup {
+  std::size_t NumShards;      // number of worker processes
+  std::size_t ShardId;        // id of this worker, NumShards in the coordinator
+  int Fd;                     // worker: socket to the coordinator
+  std::vector<int> WorkerFds; // coordinator: sockets to the workers
+  std::vector<pid_t> Workers; // coordinator: process ids of the workers
+
+  /* internal functions */
+  // write size and data, returns false on error
+  static bool WriteMessage(
+    int Fd,
+    const std::string &Message
+  );
+
+  // read size and data, returns false on end of file or error
+  static bool ReadMessage(
+    int Fd,
+    std::string *Message
+  );
+
+  // write complete buffer, returns false on error
+  static bool WriteAll(
+    int Fd,
+    const char *Data,
+    std::size_t Size
+  );
+
+  // read complete buffer, returns false on end of file or error
+  static bool ReadAll(
+    int Fd,
+    char *Data,
+    std::size_t Size
+  );
+
+  // close the sockets to the workers and wait for them, returns false if
+  // one of them failed
+  bool WaitForWorkers();
+
+public:
+  /* constructor/destructor */
+  // fork NumShards workers connected to this process by socket pairs, the
+  // constructor returns in the workers and in the coordinator
+  explicit ShardGroup(
+    std::size_t NumShards_
+  );
+  ~ShardGroup();
+
+  ShardGroup(const ShardGroup &) = delete;
+  ShardGroup &operator=(const ShardGroup &) = delete;
+
+  /* interface */
+  // true in the process which forked the workers
+  bool IsCoordinator() const;
+
+  // relay the messages of the workers until all of them finished, throw if
+  // a worker failed (coordinator only)
+  void RelayMessages();
+
+  // send Message and return the messages of all workers ordered by shard
+  // id (worker only)
+  std::vector<std::string> AllGather(
+    const std::string &Message
+  );
+
+  std::size_t GetShardId() const;
+
+  std::size_t GetNumShards() const;
+};
+
+#endif
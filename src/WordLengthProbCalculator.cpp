@@ -150,9 +150,21 @@ void WordLengthProbCalculator::UpdateWHPYLMBaseProbabilitiesScale(
             << ", number of word: " << NumWords << std::endl << std::endl;
 
   if (WordLengthModulation > -1) {
-    std::vector<double> GeneratedWordLengthProbabilities;
-    LanguageModel->Generate("CHPYLM", 100000, -1,
-                            &GeneratedWordLengthProbabilities);
+    // length distribution of the words generated by the CHPYLM, words longer
+    // than MaxWordLength characters get a zero scale
+    const unsigned int MaxWordLength = 100;
+    const double MinStateProbability = 1e-10;
+    std::vector<double> GeneratedWordLengthProbabilities(
+      LanguageModel->GetCHPYLMWordLengthDistribution(MaxWordLength + 1,
+                                                     MinStateProbability));
+    double MeanGeneratedWordLength = 0;
+    for (unsigned int WordLength = 0;
+         WordLength < GeneratedWordLengthProbabilities.size(); ++WordLength) {
+      MeanGeneratedWordLength +=
+        WordLength * GeneratedWordLengthProbabilities[WordLength];
+    }
+    std::cout << " Mean length of generated words by CHPYLM: "
+              << MeanGeneratedWordLength << std::endl << std::endl;
 
     WordLengthProbCalculator WLPVectorCalculator;
     WLPVectorCalculator.SetGeneratedLengthDistribution(
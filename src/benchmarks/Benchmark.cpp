@@ -0,0 +1,243 @@
+// ----------------------------------------------------------------------------
+/**
+   File: Benchmark.cpp
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+*/
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include "Benchmark.hpp"
+#include "NHPYLM/HPYLM.hpp"
+
+BenchmarkState::BenchmarkState(
+  const std::vector<long> &Args_,
+  std::size_t NumIterations_
+) :
+  Args(Args_),
+  NumIterations(NumIterations_),
+  IdxIteration(0),
+  Elapsed(0),
+  Running(false),
+  ItemsProcessed(0)
+{
+}
+
+bool BenchmarkState::KeepRunning()
+{
+  if (IdxIteration == 0) {
+    ResumeTiming();
+  }
+  if (IdxIteration++ < NumIterations) {
+    return true;
+  }
+  PauseTiming();
+  return false;
+}
+
+void BenchmarkState::PauseTiming()
+{
+  if (Running) {
+    Elapsed += std::chrono::steady_clock::now() - Start;
+    Running = false;
+  }
+}
+
+void BenchmarkState::ResumeTiming()
+{
+  if (!Running) {
+    Running = true;
+    Start = std::chrono::steady_clock::now();
+  }
+}
+
+long BenchmarkState::Arg(std::size_t Idx) const
+{
+  return Args.at(Idx);
+}
+
+void BenchmarkState::SetItemsProcessed(std::size_t ItemsProcessed_)
+{
+  ItemsProcessed = ItemsProcessed_;
+}
+
+double BenchmarkState::GetElapsed() const
+{
+  return Elapsed.count();
+}
+
+std::size_t BenchmarkState::GetNumIterations() const
+{
+  return NumIterations;
+}
+
+std::size_t BenchmarkState::GetItemsProcessed() const
+{
+  return ItemsProcessed;
+}
+
+std::vector<BenchmarkEntry> &GetBenchmarks()
+{
+  static std::vector<BenchmarkEntry> Benchmarks;
+  return Benchmarks;
+}
+
+int RegisterBenchmark(
+  const std::string &Name,
+  BenchmarkFunction Function,
+  const std::vector<std::string> &ArgNames,
+  const std::vector<std::vector<long> > &ArgSets
+)
+{
+  GetBenchmarks().push_back({Name, Function, ArgNames, ArgSets});
+  return GetBenchmarks().size();
+}
+
+namespace {
+
+// name of a run: Name/ArgName:Value/...
+std::string BuildRunName(const BenchmarkEntry &Benchmark,
+                         const std::vector<long> &Args)
+{
+  std::ostringstream Name;
+  Name << Benchmark.Name;
+  for (std::size_t IdxArg = 0; IdxArg < Args.size(); ++IdxArg) {
+    Name << "/";
+    if (IdxArg < Benchmark.ArgNames.size()) {
+      Name << Benchmark.ArgNames[IdxArg] << ":";
+    }
+    Name << Args[IdxArg];
+  }
+  return Name.str();
+}
+
+void DieOnHelp(const std::string &err)
+{
+  std::cout << "---LatticeWordSegmentationBenchmarks---" << std::endl
+            << " Microbenchmarks of the language model and fst hot paths" << std::endl << std::endl
+            << " Options:" << std::endl
+            << "  -Filter:   Only run benchmarks whose name contains the string (-Filter String ())" << std::endl
+            << "  -MinTime:  Minimum time of the timed loop per run in seconds (-MinTime Seconds (0.5))" << std::endl
+            << "  -CSV:      Write comma separated values instead of a table (-CSV (false))" << std::endl
+            << "  -List:     Only list the benchmarks (-List (false))" << std::endl;
+  if (!err.empty()) {
+    std::cout << std::endl << " Error: " << err << std::endl;
+  }
+  std::exit(1);
+}
+
+}
+
+int main(int argc, const char **argv)
+{
+  std::string Filter;
+  double MinTime = 0.5;
+  bool CSV = false;
+  bool List = false;
+  for (int argPos = 1; argPos < argc; ++argPos) {
+    if (!strcmp(argv[argPos], "-Filter") && (argPos + 1 < argc)) {
+      Filter = argv[++argPos];
+    } else if (!strcmp(argv[argPos], "-MinTime") && (argPos + 1 < argc)) {
+      MinTime = atof(argv[++argPos]);
+    } else if (!strcmp(argv[argPos], "-CSV")) {
+      CSV = true;
+    } else if (!strcmp(argv[argPos], "-List")) {
+      List = true;
+    } else {
+      DieOnHelp(std::string("Illegal option: ") + argv[argPos]);
+    }
+  }
+
+  // fixed seeds, every run of the suite samples the same decisions
+  HPYLM::SeedRandomGenerators(42);
+  std::srand(42);
+
+  if (CSV) {
+    std::cout << "name,iterations,ns_per_iteration,items_per_second" << std::endl;
+  } else if (!List) {
+    std::cout << std::left << std::setw(64) << "Benchmark" << std::right
+              << std::setw(14) << "Iterations" << std::setw(16) << "ns/iter"
+              << std::setw(16) << "items/s" << std::endl;
+  }
+  for (const BenchmarkEntry &Benchmark : GetBenchmarks()) {
+    for (const std::vector<long> &Args : Benchmark.ArgSets) {
+      std::string RunName = BuildRunName(Benchmark, Args);
+      if (RunName.find(Filter) == std::string::npos) {
+        continue;
+      }
+      if (List) {
+        std::cout << RunName << std::endl;
+        continue;
+      }
+
+      // increase the number of iterations until the timed loop takes at
+      // least MinTime
+      std::size_t NumIterations = 1;
+      while (true) {
+        BenchmarkState State(Args, NumIterations);
+        Benchmark.Function(State);
+        double Elapsed = State.GetElapsed();
+        if ((Elapsed >= MinTime) || (NumIterations >= 1000000000)) {
+          double NsPerIteration = Elapsed * 1e9 / NumIterations;
+          double ItemsPerSecond =
+            Elapsed > 0 ? State.GetItemsProcessed() / Elapsed : 0;
+          if (CSV) {
+            std::cout << RunName << "," << NumIterations << ","
+                      << NsPerIteration << "," << ItemsPerSecond << std::endl;
+          } else {
+            std::cout << std::left << std::setw(64) << RunName << std::right
+                      << std::setw(14) << NumIterations << std::fixed
+                      << std::setprecision(1) << std::setw(16) << NsPerIteration
+                      << std::setprecision(0) << std::setw(16) << ItemsPerSecond
+                      << std::endl;
+          }
+          break;
+        }
+        double Scale = Elapsed > 0 ? 1.4 * MinTime / Elapsed : 10;
+        NumIterations = std::max<std::size_t>(
+          NumIterations + 1, NumIterations * std::min(Scale, 10.0));
+      }
+    }
+  }
+  return 0;
+}
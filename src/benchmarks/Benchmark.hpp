@@ -0,0 +1,145 @@
+// ----------------------------------------------------------------------------
+/**
+   File: Benchmark.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+
+   E-Mail: agent@local
+
+   Description: minimal harness for microbenchmarks in the style of Google
+                Benchmark (timed loop, registered functions, argument sets)
+
+   Limitations: single threaded, no statistics over repetitions
+
+   Change History:
+   Date         Author       Description
+   2026-10-19   agent        Initial
+*/
+// ----------------------------------------------------------------------------
+#ifndef _BENCHMARK_HPP_
+#define _BENCHMARK_HPP_
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+/* state of one benchmark run, the timed code is run in the loop
+     while (State.KeepRunning()) { ... }
+   code before the loop (setup) is not timed */
+class BenchmarkState {
+  const std::vector<long> Args;                        // arguments of this run
+  const std::size_t NumIterations;                     // number of iterations to run
+  std::size_t IdxIteration;                            // current iteration
+  std::chrono::steady_clock::time_point Start;         // start of the current timed section
+  std::chrono::duration<double> Elapsed;               // time of the finished timed sections
+  bool Running;                                        // the timer is running
+  std::size_t ItemsProcessed;                          // items processed by all iterations (optional)
+
+public:
+  /* constructor */
+  BenchmarkState(
+    const std::vector<long> &Args_,
+    std::size_t NumIterations_
+  );
+
+  /* interface */
+  // start the timer in the first call, returns false (and stops the timer)
+  // after the requested number of iterations
+  bool KeepRunning();
+
+  // exclude code inside the loop from the timing
+  void PauseTiming();
+  void ResumeTiming();
+
+  // return argument of the run
+  long Arg(
+    std::size_t Idx
+  ) const;
+
+  // set the number of processed items for the throughput
+  void SetItemsProcessed(
+    std::size_t ItemsProcessed_
+  );
+
+  double GetElapsed() const;
+
+  std::size_t GetNumIterations() const;
+
+  std::size_t GetItemsProcessed() const;
+};
+
+typedef void (*BenchmarkFunction)(BenchmarkState &State);
+
+/* registry of all benchmarks, the benchmark files register their functions
+   during static initialization:
+     static const int Registered = RegisterBenchmark(
+       "Name", Function, {"ArgName"}, {{Arg1}, {Arg2}});
+*/
+struct BenchmarkEntry {
+  std::string Name;                        // name of the benchmark
+  BenchmarkFunction Function;              // benchmark function
+  std::vector<std::string> ArgNames;       // names of the arguments
+  std::vector<std::vector<long> > ArgSets; // argument sets, one run per set
+};
+
+// register a benchmark, returns the number of registered benchmarks
+int RegisterBenchmark(
+  const std::string &Name,
+  BenchmarkFunction Function,
+  const std::vector<std::string> &ArgNames,
+  const std::vector<std::vector<long> > &ArgSets
+);
+
+// return all registered benchmarks
+std::vector<BenchmarkEntry> &GetBenchmarks();
+
+// prevent the compiler from optimizing away a result
+template<typename T>
+inline void DoNotOptimize(const T &Value)
+{
+  asm volatile("" : : "r,m"(Value) : "memory");
+}
+
+#endif
@@ -0,0 +1,206 @@
+// ----------------------------------------------------------------------------
+/**
+   File: FstBenchmarks.cpp
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+*/
+#include <algorithm>
+#include <deque>
+#include <random>
+#include "Benchmark.hpp"
+#include "SyntheticData.hpp"
+#include "LexFst.hpp"
+#include "NHPYLMFst.hpp"
+#include "SampleLib.hpp"
+
+namespace {
+
+// number of states of the language model fst expanded per iteration
+const std::size_t NumExpandedStates = 64;
+
+// build a fresh language model fst with all words active and expand the
+// arcs of the first NumExpandedStates states in breadth first order
+void BM_NHPYLMFstExpand(BenchmarkState &State)
+{
+  const int WHPYLMOrder = State.Arg(0);
+  const std::size_t NumWords = State.Arg(1);
+  const SyntheticLanguageModel &Model = SyntheticData::GetCachedLanguageModel(
+    6, WHPYLMOrder, NumWords, 30);
+  const std::vector<bool> ActiveWords(Model.LanguageModel->GetMaxNumWords(),
+                                      true);
+
+  std::size_t NumArcs = 0;
+  while (State.KeepRunning()) {
+    NHPYLMFst LanguageModelFST(*Model.LanguageModel, Model.SentEndWordId,
+                               ActiveWords);
+    std::vector<bool> Visited(Model.LanguageModel->GetFinalContextId() + 1,
+                              false);
+    std::deque<int> Queue(1, LanguageModelFST.Start());
+    Visited[LanguageModelFST.Start()] = true;
+    std::size_t NumStates = 0;
+    while (!Queue.empty() && (NumStates++ < NumExpandedStates)) {
+      int s = Queue.front();
+      Queue.pop_front();
+      for (fst::ArcIterator<fst::Fst<fst::LogArc> > Arc(LanguageModelFST, s);
+           !Arc.Done(); Arc.Next()) {
+        int NextState = Arc.Value().nextstate;
+        if (!Visited[NextState]) {
+          Visited[NextState] = true;
+          Queue.push_back(NextState);
+        }
+      }
+    }
+    NumArcs += LanguageModelFST.GetNumExpandedArcs();
+  }
+  State.SetItemsProcessed(NumArcs);
+}
+
+// remove a word from the lexicon fst and add it again, like the sampler
+// does for words which leave and reenter the dictionary
+void BM_LexFstAddRemoveWord(BenchmarkState &State)
+{
+  const std::size_t NumWords = State.Arg(0);
+  const SyntheticLanguageModel &Model = SyntheticData::GetCachedLanguageModel(
+    6, 2, NumWords, 30);
+  LexFst LexiconTransducer(false, Model.Symbols, CHARACTERSBEGIN,
+                           Model.LanguageModel->GetWHPYLMBaseProbabilitiesScale());
+  LexiconTransducer.BuildLexiconTansducer(Model.LanguageModel->GetWord2Id());
+
+  std::size_t IdxWord = 0;
+  while (State.KeepRunning()) {
+    const std::vector<int> &Word = Model.Lexicon[IdxWord];
+    LexiconTransducer.rmWord(Word.begin(), Word.size());
+    LexiconTransducer.addWord(Word.begin(), Word.size(), Model.WordIds[IdxWord]);
+    IdxWord = (IdxWord + 1) % Model.Lexicon.size();
+  }
+  State.SetItemsProcessed(State.GetNumIterations());
+}
+
+// draw a path from a character confusion network
+void BM_SampleLibSampGen(BenchmarkState &State)
+{
+  const std::size_t Length = State.Arg(0);
+  const std::size_t Branching = State.Arg(1);
+  const std::size_t NumCharacters = State.Arg(2);
+  std::default_random_engine RandomGenerator(42);
+  std::uniform_int_distribution<int> CharacterDistribution(
+    CHARACTERSBEGIN, CHARACTERSBEGIN + NumCharacters - 1);
+  std::vector<int> Characters(Length);
+  for (int &Character : Characters) {
+    Character = CharacterDistribution(RandomGenerator);
+  }
+  const LogVectorFst Lattice = SyntheticData::BuildLattice(
+    Characters, Branching, NumCharacters, &RandomGenerator);
+
+  LogVectorFst SampledFst;
+  while (State.KeepRunning()) {
+    SampledFst.DeleteStates();
+    SampleLib::SampGen(Lattice, &SampledFst, 1);
+    DoNotOptimize(SampledFst.NumStates());
+  }
+  State.SetItemsProcessed(State.GetNumIterations() * Length);
+}
+
+// full sampling step of one sentence: compose the lattice of a training
+// sentence with the lexicon and the language model fst and draw a
+// segmentation
+void BM_SampleLibComposeAndSample(BenchmarkState &State)
+{
+  const std::size_t NumWords = State.Arg(0);
+  const std::size_t Branching = State.Arg(1);
+  const int BeamWidth = State.Arg(2);
+  const SyntheticLanguageModel &Model = SyntheticData::GetCachedLanguageModel(
+    6, 2, NumWords, 30);
+  LexFst LexiconTransducer(false, Model.Symbols, CHARACTERSBEGIN,
+                           Model.LanguageModel->GetWHPYLMBaseProbabilitiesScale());
+  LexiconTransducer.BuildLexiconTansducer(Model.LanguageModel->GetWord2Id());
+
+  // lattices of the first sentences, the words are spelled out
+  std::vector<int> LexiconIndices(Model.LanguageModel->GetMaxNumWords(), -1);
+  for (std::size_t IdxWord = 0; IdxWord < Model.WordIds.size(); ++IdxWord) {
+    LexiconIndices[Model.WordIds[IdxWord]] = IdxWord;
+  }
+  std::default_random_engine RandomGenerator(42);
+  std::vector<LogVectorFst> Lattices;
+  for (std::size_t IdxSentence = 0;
+       IdxSentence < std::min<std::size_t>(64, Model.Sentences.size());
+       ++IdxSentence) {
+    std::vector<int> Characters;
+    const std::vector<int> &Sentence = Model.Sentences[IdxSentence];
+    for (std::size_t IdxWord = 1; IdxWord < Sentence.size(); ++IdxWord) {
+      const std::vector<int> &Word =
+        Model.Lexicon[LexiconIndices[Sentence[IdxWord]]];
+      Characters.insert(Characters.end(), Word.begin(), Word.end());
+    }
+    Lattices.push_back(SyntheticData::BuildLattice(
+      Characters, Branching, Model.Symbols.size() - CHARACTERSBEGIN,
+      &RandomGenerator));
+  }
+
+  std::vector<LatticeWordSegmentationTimer::SimpleTimer> tInSample(5);
+  LogVectorFst SampledFst;
+  std::size_t IdxLattice = 0;
+  std::size_t NumSampledCharacters = 0;
+  while (State.KeepRunning()) {
+    SampledFst.DeleteStates();
+    SampleLib::ComposeAndSampleFromInputLexiconAndLM(
+      &Lattices[IdxLattice], &LexiconTransducer, Model.LanguageModel.get(),
+      Model.SentEndWordId, &SampledFst, &tInSample, BeamWidth, false);
+    DoNotOptimize(SampledFst.NumStates());
+    NumSampledCharacters += Lattices[IdxLattice].NumStates() - 1;
+    IdxLattice = (IdxLattice + 1) % Lattices.size();
+  }
+  State.SetItemsProcessed(NumSampledCharacters);
+}
+
+static const int Registered =
+  RegisterBenchmark("NHPYLMFst/Expand", BM_NHPYLMFstExpand,
+                    {"WHPYLMOrder", "Vocabulary"},
+                    {{2, 1000}, {3, 1000}, {2, 10000}}) +
+  RegisterBenchmark("LexFst/AddRemoveWord", BM_LexFstAddRemoveWord,
+                    {"Vocabulary"}, {{1000}, {10000}}) +
+  RegisterBenchmark("SampleLib/SampGen", BM_SampleLibSampGen,
+                    {"Length", "Branching", "Alphabet"},
+                    {{100, 1, 30}, {100, 4, 30}, {1000, 4, 30}}) +
+  RegisterBenchmark("SampleLib/ComposeAndSample",
+                    BM_SampleLibComposeAndSample,
+                    {"Vocabulary", "Branching", "BeamWidth"},
+                    {{1000, 1, -1}, {1000, 3, -1}, {1000, 3, 100}});
+
+}
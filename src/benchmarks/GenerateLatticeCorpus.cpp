@@ -0,0 +1,264 @@
+// ----------------------------------------------------------------------------
+/**
+   File: GenerateLatticeCorpus.cpp
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+*/
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include "SyntheticData.hpp"
+#include "DebugLib.hpp"
+
+/* Generator of a synthetic corpus of phoneme lattices in HTK SLF format.
+   Utterances are drawn as zipf distributed word sequences from a hidden
+   lexicon, every phone of the spoken words becomes a position of a
+   confusion network. Written files (relative to the output directory):
+     lat/syn<N>.lat              the lattices
+     SyntheticLattice.txt        list of the lattice files (-InputFilesList)
+     SyntheticLattice.txt.ref    reference transcription (-ReferenceTranscription)
+     SyntheticLattice.lex        the hidden lexicon: word phone1 phone2 ...
+*/
+
+namespace {
+
+struct GeneratorParameters {
+  std::string OutputDirectory;              // directory for the corpus
+  std::size_t NumUtterances = 278;          // number of utterances
+  std::size_t NumWords = 1000;              // size of the hidden lexicon
+  std::size_t NumPhones = 40;               // size of the phone alphabet
+  std::size_t MaxWordLength = 10;           // maximum number of phones per word
+  std::size_t Branching = 3;                // alternatives per lattice position
+  double MinTrueProbability = 0.5;          // lower bound of the probability of the spoken phone
+  double MeanUtteranceLength = 10;          // mean number of words per utterance
+  std::size_t MaxUtteranceLength = 0;       // maximum number of words per utterance (0: unlimited)
+  SentenceLengthDistribution LengthDistribution = POISSON_LENGTH; // distribution of the utterance lengths
+  unsigned int Seed = 1;                    // seed of the random generator
+};
+
+void DieOnHelp(const std::string &err)
+{
+  std::cout << "---GenerateLatticeCorpus---" << std::endl
+            << " Synthetic phoneme lattices in HTK SLF format with a hidden ground truth lexicon" << std::endl << std::endl
+            << " Options:" << std::endl
+            << "  -OutputDirectory:     Directory for lattices, file list, reference and lexicon (-OutputDirectory Directory)" << std::endl
+            << "  -NumUtterances:       Number of utterances (-NumUtterances N (278))" << std::endl
+            << "  -Vocabulary:          Number of words in the hidden lexicon (-Vocabulary N (1000))" << std::endl
+            << "  -Alphabet:            Number of phones (-Alphabet N (40))" << std::endl
+            << "  -MaxWordLength:       Maximum number of phones per word (-MaxWordLength N (10))" << std::endl
+            << "  -Branching:           Alternative phones per lattice position (-Branching N (3))" << std::endl
+            << "  -MinTrueProbability:  The spoken phone gets a probability from [P, 0.9] (-MinTrueProbability P (0.5))" << std::endl
+            << "  -UtteranceLength:     Mean and maximum number of words per utterance, 0: unlimited (-UtteranceLength Mean Max (10 0))" << std::endl
+            << "  -LengthDistribution:  Distribution of the utterance lengths (-LengthDistribution [poisson|geometric|fixed] (poisson))" << std::endl
+            << "  -Seed:                Seed of the random generator (-Seed N (1))" << std::endl;
+  if (!err.empty()) {
+    std::cout << std::endl << " Error: " << err << std::endl;
+  }
+  std::exit(1);
+}
+
+GeneratorParameters ParseParameters(int argc, const char **argv)
+{
+  GeneratorParameters Params;
+  for (int argPos = 1; argPos < argc; ++argPos) {
+    if (!strcmp(argv[argPos], "-OutputDirectory") && (argPos + 1 < argc)) {
+      Params.OutputDirectory = argv[++argPos];
+    } else if (!strcmp(argv[argPos], "-NumUtterances") && (argPos + 1 < argc)) {
+      Params.NumUtterances = atoi(argv[++argPos]);
+    } else if (!strcmp(argv[argPos], "-Vocabulary") && (argPos + 1 < argc)) {
+      Params.NumWords = atoi(argv[++argPos]);
+    } else if (!strcmp(argv[argPos], "-Alphabet") && (argPos + 1 < argc)) {
+      Params.NumPhones = atoi(argv[++argPos]);
+    } else if (!strcmp(argv[argPos], "-MaxWordLength") && (argPos + 1 < argc)) {
+      Params.MaxWordLength = atoi(argv[++argPos]);
+    } else if (!strcmp(argv[argPos], "-Branching") && (argPos + 1 < argc)) {
+      Params.Branching = atoi(argv[++argPos]);
+    } else if (!strcmp(argv[argPos], "-MinTrueProbability") && (argPos + 1 < argc)) {
+      Params.MinTrueProbability = atof(argv[++argPos]);
+    } else if (!strcmp(argv[argPos], "-UtteranceLength") && (argPos + 2 < argc)) {
+      Params.MeanUtteranceLength = atof(argv[++argPos]);
+      Params.MaxUtteranceLength = atoi(argv[++argPos]);
+    } else if (!strcmp(argv[argPos], "-LengthDistribution") && (argPos + 1 < argc)) {
+      ++argPos;
+      if (!strcmp(argv[argPos], "poisson")) {
+        Params.LengthDistribution = POISSON_LENGTH;
+      } else if (!strcmp(argv[argPos], "geometric")) {
+        Params.LengthDistribution = GEOMETRIC_LENGTH;
+      } else if (!strcmp(argv[argPos], "fixed")) {
+        Params.LengthDistribution = FIXED_LENGTH;
+      } else {
+        DieOnHelp(std::string("Unknown length distribution: ") + argv[argPos]);
+      }
+    } else if (!strcmp(argv[argPos], "-Seed") && (argPos + 1 < argc)) {
+      Params.Seed = atoi(argv[++argPos]);
+    } else {
+      DieOnHelp(std::string("Illegal option: ") + argv[argPos]);
+    }
+  }
+
+  if (Params.OutputDirectory.empty()) {
+    DieOnHelp("No output directory given");
+  }
+  if ((Params.NumUtterances == 0) || (Params.NumWords == 0) ||
+      (Params.NumPhones == 0) || (Params.MaxWordLength == 0)) {
+    DieOnHelp("Number of utterances, vocabulary, alphabet and word length have to be positive");
+  }
+  // the lexicon has to fit into the distinct phone sequences
+  double NumSequences = 0;
+  for (std::size_t Length = 1; Length <= Params.MaxWordLength; ++Length) {
+    NumSequences += std::pow(Params.NumPhones, Length);
+  }
+  if (NumSequences < Params.NumWords) {
+    DieOnHelp("Vocabulary is larger than the number of distinct phone sequences");
+  }
+  if (Params.OutputDirectory.back() != '/') {
+    Params.OutputDirectory += '/';
+  }
+  return Params;
+}
+
+// write one confusion network as HTK SLF lattice, one node per position
+// with a 10 ms frame shift, the scores are natural log probabilities
+void WriteHTKLattice(
+  const std::string &FileName,
+  const std::string &Utterance,
+  const std::vector<ConfusionSet> &ConfusionNetwork,
+  const std::vector<std::string> &Symbols
+)
+{
+  std::size_t NumLinks = 0;
+  for (const ConfusionSet &Alternatives : ConfusionNetwork) {
+    NumLinks += Alternatives.size();
+  }
+
+  std::ofstream LatticeFile(FileName);
+  if (!LatticeFile) {
+    throw std::runtime_error("Cannot write lattice " + FileName);
+  }
+  LatticeFile << "VERSION=1.0\n"
+              << "UTTERANCE=" << Utterance << "\n"
+              << "lmscale=1.00 wdpenalty=0.00\n"
+              << "N=" << ConfusionNetwork.size() + 1 << " L=" << NumLinks << "\n"
+              << std::fixed << std::setprecision(2);
+  for (std::size_t NodeId = 0; NodeId <= ConfusionNetwork.size(); ++NodeId) {
+    LatticeFile << "I=" << NodeId << " t=" << NodeId * 0.01 << "\n";
+  }
+  LatticeFile << std::setprecision(6);
+  std::size_t LinkId = 0;
+  for (std::size_t NodeId = 0; NodeId < ConfusionNetwork.size(); ++NodeId) {
+    for (const std::pair<int, double> &Alternative : ConfusionNetwork[NodeId]) {
+      LatticeFile << "J=" << LinkId++ << " S=" << NodeId << " E=" << NodeId + 1
+                  << " W=" << Symbols[Alternative.first] << " v=1"
+                  << " a=" << std::log(Alternative.second) << " l=0.00\n";
+    }
+  }
+}
+
+}
+
+int main(int argc, const char **argv)
+{
+  GeneratorParameters Params = ParseParameters(argc, argv);
+  std::default_random_engine RandomGenerator(Params.Seed);
+
+  std::vector<std::string> Symbols = SyntheticData::BuildSymbols(Params.NumPhones);
+  std::vector<std::vector<int> > Lexicon = SyntheticData::BuildLexicon(
+    Params.NumWords, Params.NumPhones, Params.MaxWordLength, &RandomGenerator);
+  std::vector<std::vector<int> > Utterances = SyntheticData::BuildSentences(
+    Params.NumUtterances, Params.MeanUtteranceLength, Params.NumWords,
+    &RandomGenerator, Params.LengthDistribution, Params.MaxUtteranceLength);
+
+  DebugLib::CreateDirectoryRecursively(Params.OutputDirectory + "lat/");
+  std::ofstream LexiconFile(Params.OutputDirectory + "SyntheticLattice.lex");
+  for (std::size_t IdxWord = 0; IdxWord < Lexicon.size(); ++IdxWord) {
+    LexiconFile << "w" << IdxWord;
+    for (int Phone : Lexicon[IdxWord]) {
+      LexiconFile << " " << Symbols[Phone];
+    }
+    LexiconFile << "\n";
+  }
+
+  // the file list refers to the lattices by the output directory like the
+  // lists in test/
+  std::ofstream ListFile(Params.OutputDirectory + "SyntheticLattice.txt");
+  std::ofstream ReferenceFile(Params.OutputDirectory + "SyntheticLattice.txt.ref");
+  if (!LexiconFile || !ListFile || !ReferenceFile) {
+    throw std::runtime_error("Cannot write to " + Params.OutputDirectory);
+  }
+  std::size_t NumPositions = 0;
+  std::size_t NumLinks = 0;
+  for (std::size_t IdxUtterance = 0; IdxUtterance < Utterances.size();
+       ++IdxUtterance) {
+    std::ostringstream Utterance;
+    Utterance << "syn" << std::setw(7) << std::setfill('0') << IdxUtterance;
+    std::string FileName = Params.OutputDirectory + "lat/" + Utterance.str() + ".lat";
+
+    std::vector<int> Phones;
+    for (int Word : Utterances[IdxUtterance]) {
+      for (int Phone : Lexicon[Word]) {
+        Phones.push_back(Phone);
+        ReferenceFile << Symbols[Phone] << " ";
+      }
+      ReferenceFile << UNKEND_SYMBOL << " ";
+    }
+    ReferenceFile << SENTEND_SYMBOL << " " << UNKEND_SYMBOL << "\n";
+
+    std::vector<ConfusionSet> ConfusionNetwork =
+      SyntheticData::BuildConfusionNetwork(Phones, Params.Branching,
+                                           Params.NumPhones, &RandomGenerator,
+                                           Params.MinTrueProbability);
+    WriteHTKLattice(FileName, Utterance.str(), ConfusionNetwork, Symbols);
+    ListFile << FileName << "\n";
+
+    NumPositions += ConfusionNetwork.size();
+    for (const ConfusionSet &Alternatives : ConfusionNetwork) {
+      NumLinks += Alternatives.size();
+    }
+  }
+
+  std::cout << "Generated " << Utterances.size() << " utterances with "
+            << NumPositions << " phones and " << NumLinks << " links in "
+            << Params.OutputDirectory << std::endl;
+  return 0;
+}
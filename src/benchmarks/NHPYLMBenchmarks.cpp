@@ -0,0 +1,271 @@
+// ----------------------------------------------------------------------------
+/**
+   File: NHPYLMBenchmarks.cpp
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+*/
+#include <map>
+#include <memory>
+#include <random>
+#include "Benchmark.hpp"
+#include "SyntheticData.hpp"
+#include "NHPYLM/HPYLM.hpp"
+#include "NHPYLM/Restaurant.hpp"
+
+namespace {
+
+// number of precomputed operations per benchmark
+const std::size_t NumDraws = 4096;
+
+/* word hpylm trained on zipf distributed word sequences, the corpus is
+   padded with Order - 1 context words at the beginning */
+struct TrainedHPYLM {
+  std::unique_ptr<HPYLM> LanguageModel;
+  std::vector<int> Corpus;
+};
+
+const TrainedHPYLM &GetTrainedHPYLM(int Order, std::size_t NumWords)
+{
+  static std::map<std::pair<int, std::size_t>,
+                  std::unique_ptr<TrainedHPYLM> > Cache;
+  std::unique_ptr<TrainedHPYLM> &Model = Cache[{Order, NumWords}];
+  if (Model == nullptr) {
+    std::default_random_engine RandomGenerator(42);
+    Model = std::unique_ptr<TrainedHPYLM>(new TrainedHPYLM);
+    Model->LanguageModel = std::unique_ptr<HPYLM>(new HPYLM(Order));
+    Model->Corpus.assign(Order - 1, 0);
+    for (const std::vector<int> &Sentence :
+         SyntheticData::BuildSentences(NumWords / 10 + 1, 10, NumWords,
+                                       &RandomGenerator)) {
+      Model->Corpus.insert(Model->Corpus.end(), Sentence.begin(),
+                           Sentence.end());
+    }
+    for (const_witerator Word = Model->Corpus.begin() + Order - 1;
+         Word != Model->Corpus.end(); ++Word) {
+      Model->LanguageModel->AddWord(Word, 1.0 / NumWords);
+    }
+  }
+  return *Model;
+}
+
+// random positions in the corpus after the padding
+std::vector<std::size_t> DrawCorpusPositions(const TrainedHPYLM &Model,
+                                             int Order)
+{
+  std::default_random_engine RandomGenerator(42);
+  std::uniform_int_distribution<std::size_t> PositionDistribution(
+    Order - 1, Model.Corpus.size() - 1);
+  std::vector<std::size_t> Positions(NumDraws);
+  for (std::size_t &Position : Positions) {
+    Position = PositionDistribution(RandomGenerator);
+  }
+  return Positions;
+}
+
+// seat and unseat zipf distributed customers in a single restaurant
+void BM_RestaurantIncrementDecrement(BenchmarkState &State)
+{
+  const std::size_t NumWords = State.Arg(0);
+  const double Discount = 0.5;
+  const double Concentration = 1.0;
+  Restaurant ThisRestaurant(Discount, Concentration);
+
+  std::default_random_engine RandomGenerator(42);
+  std::vector<double> ZipfWeights(NumWords);
+  for (std::size_t Rank = 0; Rank < NumWords; ++Rank) {
+    ZipfWeights[Rank] = 1.0 / (Rank + 1);
+  }
+  std::discrete_distribution<int> WordDistribution(ZipfWeights.begin(),
+                                                   ZipfWeights.end());
+  std::vector<int> Words(NumDraws);
+  for (int &Word : Words) {
+    Word = WordDistribution(RandomGenerator);
+    ThisRestaurant.IncrementWordCount(Word, 1.0 / NumWords);
+  }
+
+  std::size_t IdxDraw = 0;
+  while (State.KeepRunning()) {
+    int Word = Words[IdxDraw];
+    DoNotOptimize(ThisRestaurant.DecrementWordCount(Word));
+    DoNotOptimize(ThisRestaurant.IncrementWordCount(Word, 1.0 / NumWords));
+    IdxDraw = (IdxDraw + 1) % NumDraws;
+  }
+  State.SetItemsProcessed(State.GetNumIterations());
+}
+
+// remove and re-add a word at random corpus positions, like the sampler
+// does for every word of a resampled sentence
+void BM_HPYLMAddRemoveWord(BenchmarkState &State)
+{
+  const int Order = State.Arg(0);
+  const std::size_t NumWords = State.Arg(1);
+  const TrainedHPYLM &Model = GetTrainedHPYLM(Order, NumWords);
+  const std::vector<std::size_t> Positions = DrawCorpusPositions(Model, Order);
+
+  std::size_t IdxDraw = 0;
+  while (State.KeepRunning()) {
+    const_witerator Word = Model.Corpus.begin() + Positions[IdxDraw];
+    DoNotOptimize(Model.LanguageModel->RemoveWord(Word));
+    DoNotOptimize(Model.LanguageModel->AddWord(Word, 1.0 / NumWords));
+    IdxDraw = (IdxDraw + 1) % NumDraws;
+  }
+  State.SetItemsProcessed(State.GetNumIterations());
+}
+
+// probability of the words at random corpus positions, this is the walk
+// through the restaurant tree done for every word the sampler adds or
+// scores
+void BM_HPYLMWordProbability(BenchmarkState &State)
+{
+  const int Order = State.Arg(0);
+  const std::size_t NumWords = State.Arg(1);
+  const TrainedHPYLM &Model = GetTrainedHPYLM(Order, NumWords);
+  const std::vector<std::size_t> Positions = DrawCorpusPositions(Model, Order);
+
+  std::size_t IdxDraw = 0;
+  while (State.KeepRunning()) {
+    const_witerator Word = Model.Corpus.begin() + Positions[IdxDraw];
+    DoNotOptimize(Model.LanguageModel->WordProbability(Word, 1.0 / NumWords));
+    IdxDraw = (IdxDraw + 1) % NumDraws;
+  }
+  State.SetItemsProcessed(State.GetNumIterations());
+}
+
+// probabilities of the whole vocabulary in the context of random corpus
+// positions
+void BM_HPYLMWordVectorProbability(BenchmarkState &State)
+{
+  const int Order = State.Arg(0);
+  const std::size_t NumWords = State.Arg(1);
+  const TrainedHPYLM &Model = GetTrainedHPYLM(Order, NumWords);
+  const std::vector<std::size_t> Positions = DrawCorpusPositions(Model, Order);
+
+  std::vector<int> Words(NumWords);
+  for (std::size_t IdxWord = 0; IdxWord < NumWords; ++IdxWord) {
+    Words[IdxWord] = IdxWord;
+  }
+  const std::vector<double> BaseProbabilities(NumWords, 1.0 / NumWords);
+  std::vector<double> Probabilities;
+
+  std::size_t IdxDraw = 0;
+  while (State.KeepRunning()) {
+    const_witerator Word = Model.Corpus.begin() + Positions[IdxDraw];
+    std::vector<int> ContextSequence(Word - Order + 1, Word);
+    Probabilities = BaseProbabilities;
+    Model.LanguageModel->WordVectorProbability(ContextSequence, Words,
+                                               &Probabilities);
+    DoNotOptimize(Probabilities.data());
+    IdxDraw = (IdxDraw + 1) % NumDraws;
+  }
+  State.SetItemsProcessed(State.GetNumIterations() * NumWords);
+}
+
+// transitions of the nested language model from the contexts of the
+// training sentences with all words active, this is the expansion done
+// for every state of the language model fst
+void BM_NHPYLMGetTransitions(BenchmarkState &State)
+{
+  const int WHPYLMOrder = State.Arg(0);
+  const std::size_t NumWords = State.Arg(1);
+  const std::size_t NumCharacters = State.Arg(2);
+  const SyntheticLanguageModel &Model = SyntheticData::GetCachedLanguageModel(
+    6, WHPYLMOrder, NumWords, NumCharacters);
+
+  std::vector<int> ContextIds;
+  for (const std::vector<int> &Sentence : Model.Sentences) {
+    for (std::size_t IdxWord = WHPYLMOrder - 1; IdxWord < Sentence.size();
+         ++IdxWord) {
+      ContextIds.push_back(Model.LanguageModel->GetContextId(std::vector<int>(
+        Sentence.begin() + IdxWord - WHPYLMOrder + 1,
+        Sentence.begin() + IdxWord)));
+    }
+  }
+  const std::vector<bool> ActiveWords(Model.LanguageModel->GetMaxNumWords(),
+                                      true);
+
+  std::size_t IdxContext = 0;
+  std::size_t NumTransitions = 0;
+  while (State.KeepRunning()) {
+    ContextToContextTransitions Transitions =
+      Model.LanguageModel->GetTransitions(ContextIds[IdxContext],
+                                          Model.SentEndWordId, ActiveWords);
+    NumTransitions += Transitions.Words.size();
+    DoNotOptimize(Transitions);
+    IdxContext = (IdxContext + 1) % ContextIds.size();
+  }
+  State.SetItemsProcessed(NumTransitions);
+}
+
+// length distribution of the words generated by the character model, this
+// is recalculated for the base probability scaling in every iteration
+void BM_NHPYLMWordLengthDistribution(BenchmarkState &State)
+{
+  const int CHPYLMOrder = State.Arg(0);
+  const std::size_t NumWords = State.Arg(1);
+  const SyntheticLanguageModel &Model = SyntheticData::GetCachedLanguageModel(
+    CHPYLMOrder, 2, NumWords, 30);
+
+  while (State.KeepRunning()) {
+    DoNotOptimize(
+      Model.LanguageModel->GetCHPYLMWordLengthDistribution(101, 1e-10));
+  }
+  State.SetItemsProcessed(State.GetNumIterations());
+}
+
+static const int Registered =
+  RegisterBenchmark("Restaurant/IncrementDecrement",
+                    BM_RestaurantIncrementDecrement, {"Vocabulary"},
+                    {{100}, {10000}}) +
+  RegisterBenchmark("HPYLM/AddRemoveWord", BM_HPYLMAddRemoveWord,
+                    {"Order", "Vocabulary"},
+                    {{2, 1000}, {3, 1000}, {3, 10000}, {6, 1000}}) +
+  RegisterBenchmark("HPYLM/WordProbability", BM_HPYLMWordProbability,
+                    {"Order", "Vocabulary"},
+                    {{2, 1000}, {3, 1000}, {6, 1000}}) +
+  RegisterBenchmark("HPYLM/WordVectorProbability",
+                    BM_HPYLMWordVectorProbability, {"Order", "Vocabulary"},
+                    {{2, 1000}, {3, 1000}, {3, 10000}}) +
+  RegisterBenchmark("NHPYLM/GetTransitions", BM_NHPYLMGetTransitions,
+                    {"WHPYLMOrder", "Vocabulary", "Alphabet"},
+                    {{2, 1000, 30}, {3, 1000, 30}, {2, 10000, 30}}) +
+  RegisterBenchmark("NHPYLM/WordLengthDistribution",
+                    BM_NHPYLMWordLengthDistribution,
+                    {"CHPYLMOrder", "Vocabulary"}, {{4, 1000}, {6, 1000}});
+
+}
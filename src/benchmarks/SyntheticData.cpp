@@ -0,0 +1,246 @@
+// ----------------------------------------------------------------------------
+/**
+   File: SyntheticData.cpp
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+*/
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
+#include "SyntheticData.hpp"
+
+std::vector<std::string> SyntheticData::BuildSymbols(std::size_t NumCharacters)
+{
+  std::vector<std::string> Symbols = {
+    EPS_SYMBOL, PHI_SYMBOL, UNKBEGIN_SYMBOL, UNKEND_SYMBOL, SENTSTART_SYMBOL,
+    SENTEND_SYMBOL
+  };
+  for (std::size_t IdxCharacter = 0; IdxCharacter < NumCharacters;
+       ++IdxCharacter) {
+    Symbols.push_back("c" + std::to_string(IdxCharacter));
+  }
+  return Symbols;
+}
+
+std::vector<std::vector<int> > SyntheticData::BuildLexicon(
+  std::size_t NumWords,
+  std::size_t NumCharacters,
+  std::size_t MaxWordLength,
+  std::default_random_engine *RandomGenerator
+)
+{
+  std::geometric_distribution<std::size_t> LengthDistribution(0.3);
+  std::uniform_int_distribution<int> CharacterDistribution(
+    CHARACTERSBEGIN, CHARACTERSBEGIN + NumCharacters - 1);
+
+  std::set<std::vector<int> > Words;
+  std::vector<std::vector<int> > Lexicon;
+  while (Lexicon.size() < NumWords) {
+    std::vector<int> Word(1 + std::min(LengthDistribution(*RandomGenerator),
+                                       MaxWordLength - 1));
+    for (int &Character : Word) {
+      Character = CharacterDistribution(*RandomGenerator);
+    }
+    if (Words.insert(Word).second) {
+      Lexicon.push_back(Word);
+    }
+  }
+  return Lexicon;
+}
+
+std::vector<std::vector<int> > SyntheticData::BuildSentences(
+  std::size_t NumSentences,
+  double MeanSentenceLength,
+  std::size_t NumWords,
+  std::default_random_engine *RandomGenerator,
+  SentenceLengthDistribution LengthDistribution,
+  std::size_t MaxSentenceLength
+)
+{
+  std::vector<double> ZipfWeights(NumWords);
+  for (std::size_t Rank = 0; Rank < NumWords; ++Rank) {
+    ZipfWeights[Rank] = 1.0 / (Rank + 1);
+  }
+  std::discrete_distribution<int> WordDistribution(ZipfWeights.begin(),
+                                                   ZipfWeights.end());
+  std::poisson_distribution<std::size_t> PoissonDistribution(
+    std::max(MeanSentenceLength - 1, 0.0));
+  std::geometric_distribution<std::size_t> GeometricDistribution(
+    1 / std::max(MeanSentenceLength, 1.0));
+
+  std::vector<std::vector<int> > Sentences(NumSentences);
+  for (std::vector<int> &Sentence : Sentences) {
+    std::size_t Length = 1;
+    switch (LengthDistribution) {
+    case POISSON_LENGTH:
+      Length += PoissonDistribution(*RandomGenerator);
+      break;
+    case GEOMETRIC_LENGTH:
+      Length += GeometricDistribution(*RandomGenerator);
+      break;
+    case FIXED_LENGTH:
+      Length = std::max<std::size_t>(1, std::lround(MeanSentenceLength));
+      break;
+    }
+    if (MaxSentenceLength > 0) {
+      Length = std::min(Length, MaxSentenceLength);
+    }
+    Sentence.resize(Length);
+    for (int &Word : Sentence) {
+      Word = WordDistribution(*RandomGenerator);
+    }
+  }
+  return Sentences;
+}
+
+std::vector<ConfusionSet> SyntheticData::BuildConfusionNetwork(
+  const std::vector<int> &Characters,
+  std::size_t Branching,
+  std::size_t NumCharacters,
+  std::default_random_engine *RandomGenerator,
+  double MinTrueProbability
+)
+{
+  std::uniform_real_distribution<double> TrueProbabilityDistribution(
+    std::min(MinTrueProbability, 0.9), 0.9);
+  std::uniform_int_distribution<int> CharacterDistribution(
+    CHARACTERSBEGIN, CHARACTERSBEGIN + NumCharacters - 1);
+  Branching = std::max<std::size_t>(1, std::min(Branching, NumCharacters));
+
+  std::vector<ConfusionSet> ConfusionNetwork;
+  for (int Character : Characters) {
+    // the true character and distinct alternatives sharing the rest
+    std::set<int> Alternatives = {Character};
+    while (Alternatives.size() < Branching) {
+      Alternatives.insert(CharacterDistribution(*RandomGenerator));
+    }
+    double TrueProbability = Branching > 1 ?
+      TrueProbabilityDistribution(*RandomGenerator) : 1.0;
+    double AlternativeProbability =
+      Branching > 1 ? (1 - TrueProbability) / (Branching - 1) : 0;
+    ConfusionNetwork.push_back(ConfusionSet());
+    for (int Alternative : Alternatives) {
+      ConfusionNetwork.back().push_back(std::make_pair(Alternative,
+        Alternative == Character ? TrueProbability : AlternativeProbability));
+    }
+  }
+  return ConfusionNetwork;
+}
+
+LogVectorFst SyntheticData::BuildLattice(
+  const std::vector<int> &Characters,
+  std::size_t Branching,
+  std::size_t NumCharacters,
+  std::default_random_engine *RandomGenerator
+)
+{
+  LogVectorFst Lattice;
+  Lattice.AddState();
+  Lattice.SetStart(0);
+  for (const ConfusionSet &Alternatives : BuildConfusionNetwork(
+         Characters, Branching, NumCharacters, RandomGenerator)) {
+    int State = Lattice.NumStates() - 1;
+    int NextState = Lattice.AddState();
+    for (const std::pair<int, double> &Alternative : Alternatives) {
+      Lattice.AddArc(State, fst::LogArc(Alternative.first, Alternative.first,
+                                        -std::log(Alternative.second),
+                                        NextState));
+    }
+  }
+  Lattice.SetFinal(Lattice.NumStates() - 1, fst::LogArc::Weight::One());
+  return Lattice;
+}
+
+std::unique_ptr<SyntheticLanguageModel> SyntheticData::BuildLanguageModel(
+  unsigned int CHPYLMOrder,
+  unsigned int WHPYLMOrder,
+  std::size_t NumWords,
+  std::size_t NumCharacters,
+  std::size_t NumSentences,
+  std::default_random_engine *RandomGenerator
+)
+{
+  std::unique_ptr<SyntheticLanguageModel> Model(new SyntheticLanguageModel);
+  Model->Symbols = BuildSymbols(NumCharacters);
+  Model->Lexicon = BuildLexicon(NumWords, NumCharacters, 8, RandomGenerator);
+  Model->LanguageModel = std::unique_ptr<NHPYLM>(new NHPYLM(
+    CHPYLMOrder, WHPYLMOrder, Model->Symbols, CHARACTERSBEGIN));
+
+  // sentence end word first like in the segmentation
+  std::vector<int> SentEnd(1, SENTEND_SYMBOLID);
+  Model->SentEndWordId = Model->LanguageModel->AddCharacterIdSequenceToDictionary(
+    SentEnd.begin(), 1).first;
+  for (const std::vector<int> &Word : Model->Lexicon) {
+    Model->WordIds.push_back(
+      Model->LanguageModel->AddCharacterIdSequenceToDictionary(
+        Word.begin(), Word.size()).first);
+  }
+
+  // add the sentences with their sentence start context
+  for (const std::vector<int> &Words :
+       BuildSentences(NumSentences, 10, NumWords, RandomGenerator)) {
+    std::vector<int> Sentence(WHPYLMOrder - 1, Model->SentEndWordId);
+    for (int Word : Words) {
+      Sentence.push_back(Model->WordIds[Word]);
+    }
+    Model->LanguageModel->AddWordSequenceToLm(Sentence);
+    Model->Sentences.push_back(Sentence);
+  }
+  return Model;
+}
+
+const SyntheticLanguageModel &SyntheticData::GetCachedLanguageModel(
+  unsigned int CHPYLMOrder,
+  unsigned int WHPYLMOrder,
+  std::size_t NumWords,
+  std::size_t NumCharacters
+)
+{
+  static std::map<std::vector<std::size_t>,
+                  std::unique_ptr<SyntheticLanguageModel> > Cache;
+  std::unique_ptr<SyntheticLanguageModel> &Model =
+    Cache[{CHPYLMOrder, WHPYLMOrder, NumWords, NumCharacters}];
+  if (Model == nullptr) {
+    std::default_random_engine RandomGenerator(42);
+    Model = BuildLanguageModel(CHPYLMOrder, WHPYLMOrder, NumWords,
+                               NumCharacters, NumWords, &RandomGenerator);
+  }
+  return *Model;
+}
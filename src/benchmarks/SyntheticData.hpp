@@ -0,0 +1,164 @@
+// ----------------------------------------------------------------------------
+/**
+   File: SyntheticData.hpp
+
+   Status:         Version 1.0
+   Language: C++
+
+   License: UPB licence
+
+   Copyright (c) <2026> <University of Paderborn>
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without restriction,
+   including without limitation the rights to use, copy, modify and
+   merge the Software, subject to the following conditions:
+
+   1.) The Software is used for non-commercial research and
+       education purposes.
+
+   2.) The above copyright notice and this permission notice shall be
+       included in all copies or substantial portions of the Software.
+
+   3.) Publication, Distribution, Sublicensing, and/or Selling of
+       copies or parts of the Software requires special agreements
+       with the University of Paderborn and is in general not permitted.
+
+   4.) Modifications or contributions to the software must be
+       published under this license. The University of Paderborn
+       is granted the non-exclusive right to publish modifications
+       or contributions in future versions of the Software free of charge.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+   OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+   WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+   FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+   OTHER DEALINGS IN THE SOFTWARE.
+
+   Persons using the Software are encouraged to notify the
+   Department of Communications Engineering at the University of Paderborn
+   about bugs. Please reference the Software in your publications
+   if it was used for them.
+
+
+   Author: agent
+
+   E-Mail: agent@local
+
+   Description: synthetic lexica, sentences, character lattices and trained
+                language models for the benchmarks
+
+   Limitations: the data only mimics the sizes of real data, not its
+                statistics beyond zipf distributed word frequencies
+
+   Change History:
+   Date         Author       Description
+   2026-10-19   agent        Initial
+*/
+// ----------------------------------------------------------------------------
+#ifndef _SYNTHETICDATA_HPP_
+#define _SYNTHETICDATA_HPP_
+
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "definitions.hpp"
+#include "NHPYLM/NHPYLM.hpp"
+
+/* language model trained on synthetic sentences */
+struct SyntheticLanguageModel {
+  std::vector<std::string> Symbols;         // special symbols and characters
+  std::vector<std::vector<int> > Lexicon;   // character sequences of the words
+  std::vector<int> WordIds;                 // word ids of the lexicon entries
+  std::vector<std::vector<int> > Sentences; // word ids with sentence start context
+  std::unique_ptr<NHPYLM> LanguageModel;    // the trained model
+  int SentEndWordId;                        // id of the sentence end word
+};
+
+/* distribution of the number of words per sentence */
+enum SentenceLengthDistribution {
+  POISSON_LENGTH,   // 1 + poisson(Mean - 1)
+  GEOMETRIC_LENGTH, // 1 + geometric(1 / Mean)
+  FIXED_LENGTH      // always Mean
+};
+
+/* one position of a confusion network: character ids with probabilities */
+typedef std::vector<std::pair<int, double> > ConfusionSet;
+
+/* generator of synthetic data, all functions are deterministic for a given
+   random generator state */
+class SyntheticData {
+public:
+  // special symbols followed by NumCharacters characters
+  static std::vector<std::string> BuildSymbols(
+    std::size_t NumCharacters
+  );
+
+  // NumWords distinct words with 1 to MaxWordLength characters (shorter
+  // words more likely), character ids start at CHARACTERSBEGIN
+  static std::vector<std::vector<int> > BuildLexicon(
+    std::size_t NumWords,
+    std::size_t NumCharacters,
+    std::size_t MaxWordLength,
+    std::default_random_engine *RandomGenerator
+  );
+
+  // sentences of word indices, the word frequencies are zipf distributed,
+  // the sentence lengths are drawn from the given distribution (at most
+  // MaxSentenceLength words, 0: unlimited)
+  static std::vector<std::vector<int> > BuildSentences(
+    std::size_t NumSentences,
+    double MeanSentenceLength,
+    std::size_t NumWords,
+    std::default_random_engine *RandomGenerator,
+    SentenceLengthDistribution LengthDistribution = POISSON_LENGTH,
+    std::size_t MaxSentenceLength = 0
+  );
+
+  // confusion network of the characters: every character becomes a
+  // position with Branching alternatives, the true character gets a
+  // probability drawn uniformly from [MinTrueProbability, 0.9], the
+  // alternatives share the rest
+  static std::vector<ConfusionSet> BuildConfusionNetwork(
+    const std::vector<int> &Characters,
+    std::size_t Branching,
+    std::size_t NumCharacters,
+    std::default_random_engine *RandomGenerator,
+    double MinTrueProbability = 0.5
+  );
+
+  // confusion network of BuildConfusionNetwork as fst, the weights are
+  // negative log probabilities
+  static LogVectorFst BuildLattice(
+    const std::vector<int> &Characters,
+    std::size_t Branching,
+    std::size_t NumCharacters,
+    std::default_random_engine *RandomGenerator
+  );
+
+  // train a language model with the given orders on synthetic sentences
+  static std::unique_ptr<SyntheticLanguageModel> BuildLanguageModel(
+    unsigned int CHPYLMOrder,
+    unsigned int WHPYLMOrder,
+    std::size_t NumWords,
+    std::size_t NumCharacters,
+    std::size_t NumSentences,
+    std::default_random_engine *RandomGenerator
+  );
+
+  // language model of BuildLanguageModel trained on NumWords sentences with
+  // a fixed seed, built once per parameter set and kept for later calls
+  static const SyntheticLanguageModel &GetCachedLanguageModel(
+    unsigned int CHPYLMOrder,
+    unsigned int WHPYLMOrder,
+    std::size_t NumWords,
+    std::size_t NumCharacters
+  );
+};
+
+#endif
@@ -45,6 +45,7 @@
 #include <ctime>
 #include "LatticeWordSegmentation.hpp"
 #include "FileReader/FileReader.hpp"
+#include "DebugLib.hpp"
 
 int main(int argc, const char **argv)
 {
@@ -60,13 +61,27 @@ int main(int argc, const char **argv)
   // Parse command line arguments
   ParameterParser Parser(argc, argv);
 
-  // Parse Input Files into FST data structures
+  // Parse Input Files into FST data structures, the reader is a temporary so
+  // its data is moved and only one copy of the corpus is kept in memory
+  DebugLib::PrintMemoryUsage("before reading input");
   FileData InputFileData = FileReader(Parser.GetParameters()).GetInputFileData();
+  DebugLib::PrintMemoryUsage("after reading input");
   // initialize the segmenter
   LatticeWordSegmentation Segmenter(Parser.GetParameters(), InputFileData);
 
-  // do the segmentation
-  Segmenter.DoWordSegmentation();
+  // do the segmentation or segment with a trained model, either the input
+  // files or the lattices sent to the server
+  if (!Parser.GetParameters().ServeSocket.empty()) {
+    Segmenter.Serve();
+  } else if (Parser.GetParameters().DecodeFile.empty()) {
+    if (!Segmenter.DoWordSegmentation()) {
+      // worker process of sharded sampling
+      return 0;
+    }
+  } else {
+    Segmenter.DoDecoding();
+  }
+  DebugLib::PrintMemoryUsage("after segmentation");
 
   // finished
   std::cout << "Hello world, I'm done!" << std::endl;
@@ -0,0 +1,88 @@
+#!/bin/bash
+##############################################################################################################################
+### Call: StartThroughputBenchmark.bash "CorpusSizes" "ThreadCounts" NumIter [Vocabulary Alphabet Branching MeanWords]     ##
+### e.g.: ./StartThroughputBenchmark.bash "2780 27800" "1 2 4 8" 3                                                          ##
+###                                                                                                                         ##
+### End-to-end throughput benchmark on synthetic phoneme lattices. For every corpus size a synthetic corpus of HTK slf      ##
+### lattices is generated with GenerateLatticeCorpus (build with -DBUILD_BENCHMARKS=ON) from a hidden lexicon of           ##
+### Vocabulary words over Alphabet phones, with Branching alternative phones per position and MeanWords words per          ##
+### utterance (defaults: 1000 40 3 10). The test corpus has 278 utterances, 2780 and 27800 give 10x and 100x its size.      ##
+### Then segmentation with word LM order 1 and character LM order 2 is run for NumIter iterations with every thread        ##
+### count.                                                                                                                  ##
+###                                                                                                                         ##
+### One csv line is written per run to stdout and Results/Throughput/throughput.csv:                                       ##
+###   utterances,threads,iterations,wall_seconds,sentences_per_second,max_rss_kb,<accumulated seconds per timer>           ##
+### the timers of the sampling threads are summed over the threads. The peak RSS is measured with GNU time (/usr/bin/time) ##
+### and NA without it.                                                                                                      ##
+### The synthetic corpora are kept in Results/Throughput/Corpus_${CorpusSize}.                                             ##
+##############################################################################################################################
+
+### parse some parameters ###
+CorpusSizes="${1}"
+ThreadCounts="${2}"
+NumIter="${3}"
+Vocabulary="${4:-1000}"
+Alphabet="${5:-40}"
+Branching="${6:-3}"
+MeanWords="${7:-10}"
+Generator="${Generator:-../build/benchmarks/GenerateLatticeCorpus}"
+ResultDirectory='Results/Throughput'
+ResultFile="${ResultDirectory}/throughput.csv"
+
+if [ -z "${CorpusSizes}" ] || [ -z "${ThreadCounts}" ] || [ -z "${NumIter}" ]; then
+  sed -n '3,4p' "${0}"
+  exit 1
+fi
+
+mkdir -p "${ResultDirectory}"
+Header=''
+for CorpusSize in ${CorpusSizes}; do
+  ### generate the corpus once per size ###
+  CorpusDirectory="${ResultDirectory}/Corpus_${CorpusSize}"
+  if [ ! -f "${CorpusDirectory}/SyntheticLattice.txt" ]; then
+    "${Generator}" -OutputDirectory "${CorpusDirectory}" \
+                   -NumUtterances "${CorpusSize}" \
+                   -Vocabulary "${Vocabulary}" \
+                   -Alphabet "${Alphabet}" \
+                   -Branching "${Branching}" \
+                   -UtteranceLength "${MeanWords}" 0 >&2 || exit 1
+  fi
+
+  for NumThreads in ${ThreadCounts}; do
+    RunDirectory="${ResultDirectory}/Run_${CorpusSize}_${NumThreads}"
+    mkdir -p "${RunDirectory}"
+    TimeCommand=''
+    if [ -x /usr/bin/time ]; then
+      TimeCommand="/usr/bin/time -f %M -o ${RunDirectory}/rss.txt"
+    fi
+    Start=$(date +%s.%N)
+    ${TimeCommand} ./LatticeWordSegmentation -KnownN 1 \
+                                             -UnkN 2 \
+                                             -NoThreads "${NumThreads}" \
+                                             -NumIter "${NumIter}" \
+                                             -InputFilesList "${CorpusDirectory}/SyntheticLattice.txt" \
+                                             -InputType fst \
+                                             -LatticeFileType htk \
+                                             -HTKLMScale 0 \
+                                             -OutputDirectoryBasename "${RunDirectory}/" \
+                                             -TimingStatistics "${RunDirectory}/timing.csv" \
+                                             > "${RunDirectory}/log.txt" 2>&1 || { echo "Run failed, see ${RunDirectory}/log.txt" >&2; exit 1; }
+
+    ### sum the timers over the threads, keep the order of the timing statistics ###
+    TimerNames=$(awk -F, 'NR > 1 && !($1 in Seen) { Seen[$1] = 1; printf "%s%s", Sep, $1; Sep = "," }' "${RunDirectory}/timing.csv")
+    TimerValues=$(awk -F, 'NR > 1 { if (!($1 in Sum)) Order[++n] = $1; Sum[$1] += $3 }
+                           END { for (i = 1; i <= n; i++) printf "%s%.6f", (i > 1 ? "," : ""), Sum[Order[i]] }' "${RunDirectory}/timing.csv")
+    WallSeconds=$(awk -v s="${Start}" -v e="$(date +%s.%N)" 'BEGIN { printf "%.3f", e - s }')
+    MaxRssKb='NA'
+    if [ -n "${TimeCommand}" ]; then
+      MaxRssKb=$(cat "${RunDirectory}/rss.txt")
+    fi
+    SentencesPerSecond=$(awk -v s="${CorpusSize}" -v i="${NumIter}" -v t="${WallSeconds}" 'BEGIN { printf "%.3f", (t > 0 ? s * i / t : 0) }')
+
+    if [ -z "${Header}" ]; then
+      Header="utterances,threads,iterations,wall_seconds,sentences_per_second,max_rss_kb,${TimerNames}"
+      echo "${Header}" | tee "${ResultFile}"
+    fi
+    echo "${CorpusSize},${NumThreads},${NumIter},${WallSeconds},${SentencesPerSecond},${MaxRssKb},${TimerValues}" | tee -a "${ResultFile}"
+  done
+done